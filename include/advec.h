@@ -32,6 +32,7 @@ class Input;
 template<typename> class Grid;
 template<typename> class Fields;
 template<typename> class Stats;
+struct Tile;
 
 /**
  * Base class for the advection scheme. This class is abstract and only
@@ -53,6 +54,10 @@ class Advec
 
         virtual void get_advec_flux(Field3d<TF>&, const Field3d<TF>&) = 0;
 
+        // Functions for the fused tendencies, only implemented by the schemes that support tiles.
+        virtual bool has_tile_exec() const { return false; } ///< Check whether the scheme can run per tile.
+        virtual void exec_tile(const Tile&) {} ///< Execute the advection scheme on one tile.
+
     protected:
         Master& master; ///< Pointer to master class.
         Grid<TF>& grid; ///< Pointer to grid class.
@@ -43,6 +43,8 @@ class Advec_2 : public Advec<TF>
 
         void create(Stats<TF>&);
         void exec(Stats<TF>&); ///< Execute the advection scheme.
+        bool has_tile_exec() const { return true; }
+        void exec_tile(const Tile&); ///< Execute the advection scheme on one tile.
         unsigned long get_time_limit(long unsigned int, double); ///< Get the limit on the time step imposed by the advection scheme.
         double get_cfl(double); ///< Get the CFL number.
 
@@ -57,6 +57,8 @@ class Advec_2i3 : public Advec<TF>
         using Advec<TF>::cflmax;
         using Advec<TF>::cflmin;
 
+        int nbatch; ///< Number of scalars that are advected per sweep over the velocity fields.
+
         const std::string tend_name = "advec";
         const std::string tend_longname = "Advection";
 };
@@ -39,6 +39,7 @@ class Advec_disabled : public Advec<TF>
 
         void create(Stats<TF>&);
         void exec(Stats<TF>&); ///< Execute the advection scheme.
+        bool has_tile_exec() const { return true; }
         unsigned long get_time_limit(unsigned long, double); ///< Get the maximum time step imposed by advection scheme
         double get_cfl(double); ///< Retrieve the CFL number.
 
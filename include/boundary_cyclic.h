@@ -23,6 +23,8 @@
 #ifndef BOUNDARY_CYCLIC
 #define BOUNDARY_CYCLIC
 
+#include <vector>
+
 #ifdef USEMPI
 #include <mpi.h>
 #endif
@@ -43,6 +45,11 @@ class Boundary_cyclic
         void exec(TF* const restrict, Edge=Edge::Both_edges); // Fills the ghost cells in the periodic directions.
         void exec_2d(TF* const restrict); // Fills the ghost cells of one slice in the periodic direction.
 
+        // Exchange of a set of 3D fields, aggregated into one message per neighbour and direction.
+        // Only one exchange can be in flight, exec_begin throws if the previous one is not finished.
+        void exec_begin(const std::vector<TF*>&); // Starts the east-west exchange.
+        void exec_finish();                       // Completes east-west and does north-south.
+
         void exec(unsigned int* const restrict, Edge=Edge::Both_edges); // Fills the ghost cells in the periodic directions.
         void exec_2d(unsigned int* const restrict); // Fills the ghost cells of one slice in the periodic direction.
 
@@ -57,6 +64,8 @@ class Boundary_cyclic
         void exit_mpi();
         bool mpi_types_allocated;
 
+        std::vector<TF*> pending_fields; ///< Fields of which the exchange is started in exec_begin.
+
         #ifdef USEMPI
         MPI_Datatype eastwestedge;     ///< MPI datatype containing the ghostcells at the east-west sides.
         MPI_Datatype northsouthedge;   ///< MPI datatype containing the ghostcells at the north-south sides.
@@ -66,6 +75,14 @@ class Boundary_cyclic
         MPI_Datatype northsouthedge_uint;   ///< MPI datatype containing the ghostcells at the north-south sides.
         MPI_Datatype eastwestedge2d_uint;   ///< MPI datatype containing the ghostcells for one slice at the east-west sides.
         MPI_Datatype northsouthedge2d_uint; ///< MPI datatype containing the ghostcells for one slice at the north-south sides.
+
+        std::vector<TF> send_buf_a; ///< Aggregated send buffer for the east or north neighbour.
+        std::vector<TF> send_buf_b; ///< Aggregated send buffer for the west or south neighbour.
+        std::vector<TF> recv_buf_a; ///< Aggregated receive buffer from the west or south neighbour.
+        std::vector<TF> recv_buf_b; ///< Aggregated receive buffer from the east or north neighbour.
+        MPI_Request batch_reqs[4];  ///< Requests of the aggregated exchange in flight.
+
+        void add_bytes(MPI_Datatype, const int); ///< Counts the bytes of the sent messages in the profiler.
         #endif
 };
 #endif
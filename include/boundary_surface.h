@@ -85,9 +85,10 @@ class Boundary_surface : public Boundary<TF>
         void update_bcs(Thermo<TF>&);
 
         TF ustarin;
+        int nsurfiter; // Number of Newton iterations after the lookup of z/L.
 
-        std::vector<float> zL_sl;
-        std::vector<float> f_sl;
+        std::vector<TF> zL_sl;
+        std::vector<TF> f_sl;
 
         #ifdef USECUDA
         float* zL_sl_g;
@@ -81,6 +81,7 @@ class Column
         Fields<TF>& fields;
 
         bool swcolumn;           ///< Statistics on/off switch
+        bool swbufferedoutput;   ///< Write the columns of a time step in one batch.
 
         int statistics_counter;
         double sampletime;
@@ -23,12 +23,32 @@
 #ifndef CROSS
 #define CROSS
 
+#include <map>
+#include <memory>
+
 class Master;
 class Input;
+class Netcdf_file;
 template<typename> class Grid;
 template<typename> class Fields;
+template<typename> class Netcdf_variable;
 
 enum class Cross_direction {Top_to_bottom, Bottom_to_top};
+enum class Cross_format {Binary, Netcdf};
+enum class Cross_plane {xz, yz, xy};
+
+// One NetCDF file per variable and plane, holding all slices and all output times.
+template<typename TF>
+struct Cross_file
+{
+    std::unique_ptr<Netcdf_file> data_file;
+    std::unique_ptr<Netcdf_variable<int>> iotime_var;
+    std::unique_ptr<Netcdf_variable<TF>> data_var;
+    std::string filename;
+    int nslices;
+    int record;
+    int last_iotime;
+};
 
 template<typename TF>
 class Cross
@@ -62,6 +82,7 @@ class Cross
         Field3d_io<TF> field3d_io;
 
         bool swcross;
+        Cross_format swformat;
         TF sampletime;
         unsigned long isampletime;
 
@@ -83,7 +104,16 @@ class Cross
         std::vector<std::string> lngrad;
         std::vector<std::string> path;
 
+        std::map<std::string, Cross_file<TF>> cross_files; ///< Open NetCDF files in case of NetCDF output.
+
         //int check_list(std::vector<std::string> *, FieldMap *, std::string crossname);
         int check_save(int, char *);
+
+        Cross_file<TF>& get_cross_file(
+                const std::string&, Cross_plane, const std::vector<int>&, const std::array<int,3>&, const int);
+        int save_slices_nc(
+                TF*, TF*, const std::string&, const int, Cross_plane,
+                const std::vector<int>&, const std::array<int,3>&);
+        void gather_slice(std::vector<TF>&, const TF*, Cross_plane, const int);
 };
 #endif
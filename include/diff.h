@@ -31,6 +31,7 @@ template<typename> class Fields;
 template<typename> class Boundary;
 template<typename> class Thermo;
 template<typename> class Stats;
+struct Tile;
 
 enum class Diffusion_type {Disabled, Diff_2, Diff_4, Diff_smag2};
 
@@ -53,6 +54,10 @@ class Diff
         virtual unsigned long get_time_limit(unsigned long, double) = 0;
         virtual double get_dn(double) = 0;
 
+        // Functions for the fused tendencies, only implemented by the schemes that support tiles.
+        virtual bool has_tile_exec() const { return false; } ///< Check whether the scheme can run per tile.
+        virtual void exec_tile(const Tile&) {} ///< Execute the diffusion scheme on one tile.
+
         static std::shared_ptr<Diff> factory(Master&, Grid<TF>&, Fields<TF>&, Boundary<TF>&, Input&);
 
         #ifdef USECUDA
@@ -41,6 +41,7 @@ class Diff_disabled : public Diff<TF>
         void exec_viscosity(Thermo<TF>&) {}
         void init() {}
         void exec(Stats<TF>&) {}
+        bool has_tile_exec() const { return true; }
         void diff_flux(Field3d<TF>&, const Field3d<TF>&);
         void exec_stats(Stats<TF>&) {};
 
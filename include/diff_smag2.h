@@ -44,6 +44,8 @@ class Diff_smag2 : public Diff<TF>
         void create(Stats<TF>&);
         void init();
         void exec(Stats<TF>&);
+        bool has_tile_exec() const { return true; }
+        void exec_tile(const Tile&);
         void exec_viscosity(Thermo<TF>&);
         void diff_flux(Field3d<TF>&, const Field3d<TF>&);
         void exec_stats(Stats<TF>&);
@@ -74,6 +76,8 @@ class Diff_smag2 : public Diff<TF>
 
         double cs;
 
+        int nbatch; ///< Number of scalars that are diffused per sweep over the eddy viscosity.
+
         const std::string tend_name = "diff";
         const std::string tend_longname = "Diffusion";
 };
@@ -44,6 +44,7 @@ class Dump
 
         bool do_dump(unsigned long);
         void save_dump(TF*, std::string, int);
+        void wait_save();
 
     private:
         Master& master;
@@ -53,6 +54,8 @@ class Dump
 
         std::vector<std::string> dumplist; ///< List with all dumps from the ini file.
         bool swdump;           ///< Statistics on/off switch
+        bool swasync;          ///< Switch for saving the dumps in the background
+        int staged_iotime;     ///< Time of the dumps that are being written in the background
         double sampletime;
         unsigned long isampletime;
 };
@@ -27,13 +27,14 @@
 #include "transpose.h"
 
 class Master;
+class Input;
 template<typename> class Grid;
 
 template<typename TF>
 class FFT
 {
     public:
-        FFT(Master&, Grid<TF>&);
+        FFT(Master&, Grid<TF>&, Input&);
         ~FFT();
 
         void exec_forward (TF* const restrict, TF* const restrict);
@@ -56,5 +57,8 @@ class FFT
         fftwf_plan jplanff, jplanbf; // FFTW3 plans for forward and backward transforms in y-direction.
 
         bool has_fftw_plan;
+
+        Transpose_mode transpose_mode; // Communication strategy of the transposes.
+        int nchunks; // Number of k-chunks in the pipelined transposes.
 };
 #endif
@@ -23,11 +23,29 @@
 #ifndef FIELD3D_IO
 #define FIELD3D_IO
 
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "transpose.h"
 
 class Master;
 template<typename> class Grid;
 
+// Storage of full 3d fields: raw binary, or zlib compressed per k-slab with an offset index.
+// The lossy mode stores the values as float after quantization to a given absolute tolerance.
+enum class Field3d_compression {None, Lossless, Lossy};
+
+// Time state that is stored in the header of a restart file.
+struct Restart_state
+{
+    unsigned long itime;
+    unsigned long idt;
+    int iteration;
+};
+
 template<typename TF>
 class Field3d_io
 {
@@ -37,6 +55,10 @@ class Field3d_io
 
         void init();
 
+        void set_compression(Field3d_compression, const TF tolerance=0); // Sets the format of saved 3d fields.
+        void set_io_hints(const std::vector<std::string>&); // Sets the MPI-IO hints as key=value pairs.
+        void set_restart_alignment(const long);             // Sets the alignment in bytes of the fields in a restart file.
+
         int save_field3d(TF*, TF*, TF*, const char*, const TF); // Saves a full 3d field.
         int load_field3d(TF*, TF*, TF*, const char*, const TF); // Loads a full 3d field.
 
@@ -45,6 +67,19 @@ class Field3d_io
         int save_xy_slice(TF*, TF*, const char*, int kslice=-1); // Saves a xy-slice from a 3d field.
         int load_xy_slice(TF*, TF*, const char*, int kslice=-1); // Loads a xy-slice.
 
+        // Asynchronous saving of 3d fields: the data is copied into a staging buffer on the calling thread,
+        // and written to disk by a background thread while the time integration continues.
+        int stage_field3d(TF*, TF*, TF*, const std::string&, const TF); // Stages a full 3d field for writing.
+        int wait_staged(); // Waits until all staged fields are written.
+
+        // Restart file: all prognostic fields, the time state and the vertical grid of a checkpoint in one file,
+        // with a header that contains an index of the fields. The file is opened once, and each field is
+        // written with one collective write.
+        int save_restart(const std::string&, const std::vector<std::pair<std::string, TF*>>&,
+                const Restart_state&, TF*, TF*);
+        int load_restart(const std::string&, const std::vector<std::pair<std::string, TF*>>&,
+                Restart_state&, TF*, TF*);
+
     private:
         Master& master;
         Grid<TF>& grid;
@@ -55,7 +90,48 @@ class Field3d_io
         void init_mpi();
         void exit_mpi();
 
+        Field3d_compression compression;
+        TF tolerance;
+
+        std::vector<std::pair<std::string, std::string>> io_hints;
+        long restart_alignment;
+
+        // A file write, consisting of segments of data that are stored at the given byte offsets in the file.
+        // With MPI, all processes write their segments in one collective MPI-IO write on the communicator.
+        struct Io_job
+        {
+            std::string filename;
+            std::vector<char> data;
+            std::vector<std::pair<long, long>> segments; // Pairs of file offset and size in bytes.
+            #ifdef USEMPI
+            MPI_Comm comm;
+            #endif
+        };
+
+        const TF* extract_field3d(TF*, TF*, TF*, const TF); // Extracts the contiguous slab that this process saves.
+        void insert_field3d(TF*, TF*, TF*, const TF);       // Inserts the slab that this process loaded in tmp1.
+        int create_file(const std::string&);                // Creates the (empty) file on the main process.
+        void build_raw_job(Io_job&, const TF*);
+        int build_compressed_job(Io_job&, const TF*);
+        int write_job(const Io_job&);
+
+        int save_field3d_compressed(TF*, TF*, TF*, const char*, const TF);
+        int load_field3d_compressed(TF*, TF*, TF*, const char*, const TF);
+        bool is_compressed(const char*);
+
+        void write_staged(); // Work loop of the background thread.
+
+        std::thread io_thread;
+        std::mutex io_mutex;
+        std::condition_variable io_cv;
+        std::deque<Io_job> io_jobs; // Staged fields that still have to be written.
+        bool io_busy;               // The background thread is writing a field.
+        bool io_stop;               // Signal to the background thread to exit.
+        int io_nerror;              // Number of failed writes of the background thread.
+
         #ifdef USEMPI
+        MPI_Info io_info;        // MPI-IO hints of the 3d field files.
+        MPI_Comm io_comm;        // Communicator of the background thread, which does its MPI-IO concurrently.
         MPI_Datatype subarray;   // MPI datatype containing the dimensions of the total array that is contained in one process.
         MPI_Datatype subxzslice; // MPI datatype containing only one xz-slice.
         MPI_Datatype subyzslice; // MPI datatype containing only one yz-slice.
@@ -29,6 +29,7 @@
 #include "field3d.h"
 #include "field3d_io.h"
 #include "field3d_operators.h"
+#include "scratch_pool.h"
 
 class Master;
 class Input;
@@ -42,6 +43,7 @@ template<typename> class Diff;
 template<typename> class Column;
 template<typename> class Dump;
 template<typename> class Cross;
+template<typename> class Timeloop;
 template<typename> class Field3d;
 template<typename> class Field3d_io;
 template<typename> class Field3Field3d_operators;
@@ -84,6 +86,12 @@ class Fields
 
         void save(int);
         void load(int);
+        void wait_save();
+
+        // Save or load all prognostic fields and the time state of a checkpoint in a single file.
+        void save_restart(Timeloop<TF>&);
+        void load_restart(Timeloop<TF>&);
+        bool get_switch_restart_file() const { return swrestartfile; }
 
         TF check_momentum();
         TF check_tke();
@@ -107,9 +115,19 @@ class Fields
         Field_map<TF> sp; ///< Map containing all prognostic scalar field3d instances.
         Field_map<TF> st; ///< Map containing all prognostic scalar tendency field3d instances.
 
+        // Version counter of the prognostic fields, which is increased whenever their values change,
+        // such that derived diagnostics can be cached within a (sub)step.
+        unsigned long get_prognostic_version() const { return prognostic_version; }
+        void update_prognostic_version() { ++prognostic_version; }
+
         std::shared_ptr<Field3d<TF>> get_tmp();
         void release_tmp(std::shared_ptr<Field3d<TF>>&);
 
+        // Scratch buffers of 2d and 1d size, which return to the pool when they go out of scope.
+        Scratch_buffer<TF> get_tmp_xy(); ///< Horizontal slice of ijcells.
+        Scratch_buffer<TF> get_tmp_xz(); ///< Vertical slice of icells*kcells.
+        Scratch_buffer<TF> get_tmp_z();  ///< Column of kcells.
+
         #ifdef USECUDA
         std::shared_ptr<Field3d<TF>> get_tmp_g();
         void release_tmp_g(std::shared_ptr<Field3d<TF>>&);
@@ -149,14 +167,22 @@ class Fields
         Field3d_operators<TF> field3d_operators;
 
         bool calc_mean_profs;
+        bool swasync; ///< Switch for saving the restart files in the background.
+        bool swrestartfile; ///< Switch for saving all fields of a checkpoint in a single restart file.
+
+        unsigned long prognostic_version; ///< Counter that is increased when the prognostic fields change.
 
         int n_tmp_fields;   ///< Number of temporary fields.
+        int n_tmp_in_use;   ///< Number of temporary fields that are currently in use.
+        int n_tmp_peak;     ///< Maximum number of temporary fields that were in use at once.
 
         std::vector<std::shared_ptr<Field3d<TF>>> atmp;
         std::vector<std::shared_ptr<Field3d<TF>>> atmp_g;
 
         std::mutex tmp_fld_mutex;
 
+        Scratch_pool<TF> scratch_pool;
+
         // cross sections
         std::vector<std::string> crosslist; ///< List with all crosses from the ini file.
         std::vector<std::string> dumplist;  ///< List with all 3d dumps from the ini file.
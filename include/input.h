@@ -10,6 +10,11 @@ class Input
 {
     public:
         Input(Master&, const std::string&);
+
+        // Reads a switch from the file without MPI, for settings that are needed before MPI starts.
+        // Returns false if the file, block or item does not exist.
+        static bool peek_switch(const std::string&, const std::string&, const std::string&);
+
         template<typename T> T get_item(const std::string&, const std::string&, const std::string&);
         template<typename T> T get_item(const std::string&, const std::string&, const std::string&, const T);
         template<typename T> std::vector<T> get_list(const std::string&, const std::string&, const std::string&);
@@ -0,0 +1,71 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2018 Chiel van Heerwaarden
+ * Copyright (c) 2011-2018 Thijs Heus
+ * Copyright (c) 2014-2018 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOOKUP_TABLE_H
+#define LOOKUP_TABLE_H
+
+#include <algorithm>
+#include <vector>
+
+// Table of ncols functions of one variable x on an equidistant grid, which are interpolated linearly.
+// The values of all functions at a node are stored next to each other, such that one lookup
+// reads at most two contiguous blocks of ncols values.
+template<typename TF, int ncols>
+class Lookup_table
+{
+    public:
+        Lookup_table() : nx(0), x0(0), dxi(0) {}
+
+        // Fill the table on nx nodes from x_min to x_max, func(values, x) sets the ncols values at x.
+        template<typename Func>
+        void init(const TF x_min, const TF x_max, const int nx_in, Func&& func)
+        {
+            nx  = nx_in;
+            x0  = x_min;
+            dxi = TF(nx-1) / (x_max - x_min);
+
+            data.resize(nx*ncols);
+            for (int n=0; n<nx; ++n)
+                func(&data[n*ncols], x_min + n*(x_max - x_min)/(nx-1));
+        }
+
+        // Interpolate all functions at x, values outside the table are clamped to its edges.
+        inline void get(TF* const values, const TF x) const
+        {
+            const TF f = std::min(std::max((x - x0)*dxi, TF(0.)), TF(nx-1));
+            const int n = std::min(static_cast<int>(f), nx-2);
+            const TF w = f - n;
+
+            const TF* const d0 = &data[n*ncols];
+            const TF* const d1 = d0 + ncols;
+
+            for (int c=0; c<ncols; ++c)
+                values[c] = d0[c] + w*(d1[c] - d0[c]);
+        }
+
+    private:
+        int nx;
+        TF x0;
+        TF dxi;
+        std::vector<TF> data;
+};
+#endif
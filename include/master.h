@@ -27,7 +27,9 @@
 #include <mpi.h>
 #endif
 #include <string>
+#include <vector>
 #include "input.h"
+#include "profiler.h"
 
 class Input;
 
@@ -49,7 +51,12 @@ struct MPI_data
     MPI_Comm commxy;
     MPI_Comm commx;
     MPI_Comm commy;
+    MPI_Comm commnode; // Processes that share the memory of a node.
+
+    int thread_level; // Thread support level provided by the MPI library.
     #endif
+
+    int nodeid; // Rank within the node.
 };
 
 class Master
@@ -58,7 +65,7 @@ class Master
         Master();
         ~Master();
 
-        void start();
+        void start(const bool thread_multiple=false);
         void init(Input&);
 
         double get_wall_clock_time();
@@ -85,6 +92,13 @@ class Master
         void min(double*, int);
         void min(float*, int);
 
+        // Allocate memory that is shared by all processes on a node and that remains valid until
+        // the end of the run. Only the process with is_node_leader() writes to it, after which
+        // all processes of the node call node_barrier() before reading.
+        void* allocate_node_shared(const size_t);
+        bool is_node_leader() const { return md.nodeid == 0; }
+        void node_barrier();
+
         void print_message(const char *format, ...);
         void print_message(const std::ostringstream&);
         void print_message(const std::string&);
@@ -94,7 +108,9 @@ class Master
         void print_warning(const std::string&);
 
         int get_mpiid() const { return md.mpiid; }
+        int get_nthreads() const { return nthreads; }
         const MPI_data& get_MPI_data() const { return md; }
+        Profiler& get_profiler() { return profiler; }
 
         #ifdef USEMPI
         MPI_Request* get_request_ptr();
@@ -110,10 +126,21 @@ class Master
 
         MPI_data md;
 
+        int nthreads; // Number of OpenMP threads per process.
+
+        Profiler profiler;
+
         #ifdef USEMPI
         MPI_Request* reqs;
         int reqsn;
 
+        std::vector<MPI_Win> node_windows;
+        #else
+        std::vector<std::vector<char>> node_buffers;
+        #endif
+
+        #ifdef USEMPI
+
         int check_error(int);
         #endif
 };
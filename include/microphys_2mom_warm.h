@@ -182,6 +182,8 @@ class Microphys_2mom_warm : public Microphys<TF>
         using Microphys<TF>::field3d_operators;
 
         bool swmicrobudget;     // Output full microphysics budget terms
+        bool swactivecolumns;   // Only process the columns that contain rain or cloud water
+        bool swsedsubstep;      // Sub-step the sedimentation per column instead of limiting the time step
         TF cflmax;              // Max CFL number in microphysics sedimentation
 
         std::vector<std::string> crosslist;                  // Cross-sections handled by this class
@@ -190,6 +192,10 @@ class Microphys_2mom_warm : public Microphys<TF>
         // Surface precipitation statistics
         std::vector<TF> rr_bot;   // 2D surface sedimentation flux (kg m-2 s-1 == mm s-1)
 
+        #ifndef USECUDA
+        void exec_active_columns(const TF* const, const std::vector<TF>&, const std::vector<TF>&, const double);
+        #endif
+
         const std::string tend_name = "micro";
         const std::string tend_longname = "Microphysics";
 };
@@ -34,11 +34,30 @@
 
 #include "microphys.h"
 #include "field3d_operators.h"
+#include "lookup_table.h"
 
 class Master;
 class Input;
 class Netcdf_handle;
 
+// Columns of the lookup tables of the microphysics.
+namespace Nsw6_lookup
+{
+    // Powers of the slope parameter lambda (Tomita Eq. 27) in the process rates and sedimentation.
+    enum Slope_power
+    {
+        lambda_1, lambda_md, lambda_3d, lambda_6d, lambda_b1, lambda_b2, lambda_b3, lambda_vent,
+        n_slope_powers
+    };
+
+    // Temperature dependent factors of the process rates.
+    enum Temperature_factor
+    {
+        exp_sacr, exp_gacs, exp_saut, exp_gaut, esat_l, esat_i, g_liq, g_ice,
+        n_temperature_factors
+    };
+}
+
 template<typename> class Grid;
 template<typename> class Stats;
 template<typename> class Dump;
@@ -86,6 +105,15 @@ class Microphys_nsw6 : public Microphys<TF>
         // Variables for microphysics.
         TF N_d; // Number concentration of cloud water (cm-3)
         double cfl_max; // CFL due to precipitation.
+        bool swsedsubstep; // Sub-step the sedimentation per column instead of limiting the time step.
+        bool swlookup; // Take the slope parameter powers and temperature factors from lookup tables.
+
+        // Lookup tables of the slope parameter powers as function of ln(rho*q) per species,
+        // and of the temperature factors as function of the absolute temperature.
+        Lookup_table<TF, Nsw6_lookup::n_slope_powers> lut_rain;
+        Lookup_table<TF, Nsw6_lookup::n_slope_powers> lut_snow;
+        Lookup_table<TF, Nsw6_lookup::n_slope_powers> lut_graupel;
+        Lookup_table<TF, Nsw6_lookup::n_temperature_factors> lut_temperature;
 
         std::vector<TF> rr_bot; // Rain rate at the bottom.
         std::vector<TF> rs_bot; // Snow rate at the bottom.
@@ -25,6 +25,8 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include "tile.h"
 
 class Master;
 class Input;
@@ -103,6 +105,11 @@ class Model
         std::string sim_name;
         bool cpu_up_to_date = false;
 
+        bool swfusedtend; ///< Switch to compute the advection, diffusion and buoyancy tendencies per tile.
+        int tile_jblock; ///< Number of rows per tile.
+        int tile_kblock; ///< Number of levels per tile.
+        std::vector<Tile> tiles;
+
         void load();
         void save();
 
@@ -112,6 +119,7 @@ class Model
         void setup_stats();
         void calc_masks();
         void set_time_step();
+        void exec_fused_tendencies();
 
         void prepare_gpu();
         void clear_gpu();
@@ -2,6 +2,7 @@
 #define NETCDF_INTERFACE_H
 
 #include <map>
+#include <memory>
 #include <vector>
 #include <netcdf.h>
 
@@ -10,6 +11,7 @@ enum class Netcdf_mode { Create, Read, Write };
 class Master;
 class Netcdf_handle;
 class Netcdf_group;
+struct Netcdf_write_buffer;
 
 template<typename T>
 class Netcdf_variable
@@ -63,10 +65,12 @@ class Netcdf_handle
         bool variable_exists(const std::string&);
         bool group_exists(const std::string&);
 
+        // The optional chunk sizes (one per dimension) set an explicit chunking of the variable.
         template<typename T>
         Netcdf_variable<T> add_variable(
                 const std::string&,
-                const std::vector<std::string>&);
+                const std::vector<std::string>&,
+                const std::vector<int>& chunk_sizes = {});
 
         template<typename T>
         T get_variable(
@@ -124,6 +128,7 @@ class Netcdf_handle
         std::map<std::string, int> dims;
         std::map<std::string, Netcdf_group> groups;
         int record_counter;
+        std::shared_ptr<Netcdf_write_buffer> write_buffer; // Shared by the file and its groups.
 };
 
 class Netcdf_file : public Netcdf_handle
@@ -138,6 +143,10 @@ class Netcdf_file : public Netcdf_handle
 
         int get_dim_id(const std::string&);
 
+        // Keep the inserted data on the writing process until sync(), which writes it in one batch and
+        // checks the errors once, and chunk the variables with a time dimension by ntime_chunk records.
+        void set_buffered(const int ntime_chunk=64);
+
         void sync();
 };
 
@@ -146,7 +155,8 @@ class Netcdf_group : public Netcdf_handle
     public:
         Netcdf_group(
                 Master&, Netcdf_handle*,
-                const int, const int, const int);
+                const int, const int, const int,
+                std::shared_ptr<Netcdf_write_buffer>);
 
         // Do not allow copying or moving of groups.
         Netcdf_group(const Netcdf_group&) = delete;
@@ -62,7 +62,8 @@ class Pres_2 : public Pres<TF>
         std::vector<TF> bmatj;
         std::vector<TF> a;
         std::vector<TF> c;
-        std::vector<TF> work2d;
+        std::vector<TF> tdma_invb; // Inverse pivots of the LU factorized tridiagonal matrices.
+        std::vector<TF> tdma_gam;  // Upper factors of the LU factorized tridiagonal matrices.
 
         #ifdef USECUDA
         using Pres<TF>::make_cufft_plan;
@@ -74,6 +75,8 @@ class Pres_2 : public Pres<TF>
         TF* a_g;
         TF* c_g;
         TF* work2d_g;
+
+        std::vector<TF> work2d; // Only used to size and initialize work2d_g.
         #endif
 
         void input(TF* const restrict,
@@ -82,8 +85,7 @@ class Pres_2 : public Pres<TF>
                    const TF* const restrict, const TF* const restrict, const TF* const restrict,
                    const TF);
 
-        void solve(TF* const restrict, TF* const restrict, TF*,
-                   const TF* const restrict, const TF* const restrict);
+        void solve(TF* const restrict, TF* const restrict, const TF* const restrict);
 
         void output(TF* const restrict, TF* const restrict, TF* const restrict,
                     const TF* const restrict, const TF* const restrict);
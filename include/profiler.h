@@ -0,0 +1,90 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2018 Chiel van Heerwaarden
+ * Copyright (c) 2011-2018 Thijs Heus
+ * Copyright (c) 2014-2018 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PROFILER
+#define PROFILER
+
+#include <map>
+#include <string>
+
+class Master;
+class Input;
+
+// Accumulates the wall clock time and the communicated bytes per stage of the time loop. Nested stages
+// are named with their parent as prefix (e.g. "pres/fft"). The profile is aggregated over all processes
+// and written as JSON at the end of the run, to find the stages that regress or are imbalanced.
+class Profiler
+{
+    public:
+        Profiler(Master&);
+        ~Profiler();
+
+        void init(Input&);
+        void write(const std::string&); // Writes the profile to <simname>.profile.json.
+
+        bool get_switch() const { return swprofile; }
+        double get_time();
+
+        void add_time(const std::string&, const double);
+        void add_bytes(const std::string&, const unsigned long);
+
+    private:
+        struct Counter
+        {
+            unsigned long ncalls = 0;
+            double time = 0.;
+            unsigned long nbytes = 0;
+        };
+
+        Master& master;
+        bool swprofile;
+
+        std::map<std::string, Counter> counters;
+};
+
+// Adds the wall clock time between its construction and destruction to a stage of the profiler.
+class Scoped_timer
+{
+    public:
+        Scoped_timer(Profiler& profilerin, const char* namein) :
+            profiler(profilerin), name(namein)
+        {
+            if (profiler.get_switch())
+                start = profiler.get_time();
+        }
+
+        ~Scoped_timer()
+        {
+            if (profiler.get_switch())
+                profiler.add_time(name, profiler.get_time() - start);
+        }
+
+        Scoped_timer(const Scoped_timer&) = delete;
+        Scoped_timer& operator=(const Scoped_timer&) = delete;
+
+    private:
+        Profiler& profiler;
+        const char* name;
+        double start = 0.;
+};
+#endif
@@ -21,6 +21,8 @@
 #ifndef RADIATION_RRTMGP_H
 #define RADIATION_RRTMGP_H
 
+#include <map>
+
 #include "radiation.h"
 #include "field3d_operators.h"
 
@@ -28,6 +30,8 @@
 #include "Gas_optics.h"
 #include "Source_functions.h"
 #include "Cloud_optics.h"
+#include "Optical_props.h"
+#include "Fluxes.h"
 
 class Master;
 class Input;
@@ -106,6 +110,9 @@ class Radiation_rrtmgp : public Radiation<TF>
                 const Array<double,2>&, const Array<double,2>&, const Array<double,2>&,
                 const bool);
 
+        void exec_subset(
+                Thermo<TF>&, Timeloop<TF>&, Stats<TF>&, const std::vector<int>&);
+
         // void exec_stats(Stats<TF>&, Thermo<TF>&, Timeloop<TF>&);
         // void exec_cross(Cross<TF>&, const int, Thermo<TF>&, Timeloop<TF>&);
         // void exec_dump(Dump<TF>&, const int, Thermo<TF>&, Timeloop<TF>&) {};
@@ -116,9 +123,18 @@ class Radiation_rrtmgp : public Radiation<TF>
         bool sw_longwave;
         bool sw_shortwave;
         bool sw_clear_sky_stats;
+        bool sw_shared_tables; // Share the gas optics tables between the processes on a node.
         double dt_rad;
         unsigned long idt_rad;
 
+        // Subsampling and coarsening of the radiation columns.
+        int n_subsample; // Number of interleaved subsets of the columns, of which one is solved per call.
+        int n_coarse_x;  // Number of grid columns in x averaged into one radiation column.
+        int n_coarse_y;  // Number of grid columns in y averaged into one radiation column.
+        unsigned long idt_rad_subset;
+        std::vector<std::vector<int>> rad_col_subsets;
+        bool rad_subsets_initialized;
+
         std::vector<std::string> crosslist;
 
         // RRTMGP related variables.
@@ -135,6 +151,39 @@ class Radiation_rrtmgp : public Radiation<TF>
         Array<double,2> sw_flux_dn_dir_inc;
         Array<double,2> sw_flux_dn_dif_inc;
 
+        // Number of columns that are solved simultaneously by one thread.
+        int n_col_block;
+
+        // Work arrays of a single column block. They are allocated once per thread in
+        // create_solver. The remainder blocks have their own sets, one per block size.
+        struct Longwave_workspace
+        {
+            std::unique_ptr<Optical_props_arry<double>> optical_props;
+            std::unique_ptr<Optical_props_1scl<double>> cloud_optical_props;
+            std::unique_ptr<Source_func_lw<double>> sources;
+            std::unique_ptr<Fluxes_broadband<double>> fluxes;
+            Array<double,3> gpt_flux_up;
+            Array<double,3> gpt_flux_dn;
+        };
+
+        struct Shortwave_workspace
+        {
+            std::unique_ptr<Optical_props_arry<double>> optical_props;
+            std::unique_ptr<Optical_props_2str<double>> cloud_optical_props;
+            std::unique_ptr<Fluxes_broadband<double>> fluxes;
+            Array<double,3> gpt_flux_up;
+            Array<double,3> gpt_flux_dn;
+            Array<double,3> gpt_flux_dn_dir;
+        };
+
+        std::vector<Longwave_workspace> lw_workspace;
+        std::vector<Shortwave_workspace> sw_workspace;
+        std::map<int, Longwave_workspace> lw_workspace_left;
+        std::map<int, Shortwave_workspace> sw_workspace_left;
+
+        void init_longwave_workspace(Longwave_workspace&, const int);
+        void init_shortwave_workspace(Shortwave_workspace&, const int);
+
         // The full solver.
         Gas_concs<double> gas_concs;
         std::unique_ptr<Gas_optics<double>> kdist_lw;
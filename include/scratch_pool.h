@@ -0,0 +1,93 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2018 Chiel van Heerwaarden
+ * Copyright (c) 2011-2018 Thijs Heus
+ * Copyright (c) 2014-2018 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCRATCH_POOL
+#define SCRATCH_POOL
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Master;
+
+template<typename> class Scratch_pool;
+
+// Scratch buffer of the pool, which is returned to the pool when the handle goes out of scope.
+template<typename TF>
+class Scratch_buffer
+{
+    public:
+        Scratch_buffer(Scratch_pool<TF>&, std::vector<TF>&&);
+        ~Scratch_buffer();
+
+        Scratch_buffer(Scratch_buffer&&) noexcept;
+        Scratch_buffer(const Scratch_buffer&) = delete;
+        Scratch_buffer& operator=(const Scratch_buffer&) = delete;
+        Scratch_buffer& operator=(Scratch_buffer&&) = delete;
+
+        TF* data() { return buffer.data(); }
+        const TF* data() const { return buffer.data(); }
+        int size() const { return buffer.size(); }
+
+        TF& operator[](const int n) { return buffer[n]; }
+        const TF& operator[](const int n) const { return buffer[n]; }
+
+    private:
+        Scratch_pool<TF>* pool;
+        std::vector<TF> buffer;
+};
+
+// Pool of scratch buffers, with one free list per registered size class (e.g. 3d, xy, xz and column).
+// The size classes are registered in the init phase, after which the lookup of a class is read-only
+// and threads only contend when they get or return a buffer of the same size class.
+template<typename TF>
+class Scratch_pool
+{
+    public:
+        Scratch_pool(Master&);
+        ~Scratch_pool();
+
+        void add_size_class(const std::string&, const int);
+
+        Scratch_buffer<TF> get(const int);
+        void release(std::vector<TF>&&);
+
+        void print_usage(); // Prints the high-water mark of each size class.
+
+    private:
+        struct Size_class
+        {
+            std::string name;
+            std::mutex mutex;
+            std::vector<std::vector<TF>> free; // Buffers that are available.
+            int in_use;
+            int peak;
+        };
+
+        Size_class& get_size_class(const int);
+
+        Master& master;
+        std::map<int, std::unique_ptr<Size_class>> size_classes;
+};
+#endif
@@ -100,6 +100,7 @@ class Stats
         bool get_switch() { return swstats; }
         bool do_statistics(unsigned long);
         bool do_tendency() {return swtendency; }
+        bool is_doing_tendency() {return doing_tendency; }
         void set_tendency(bool);
 
         void initialize_masks();
@@ -154,6 +155,7 @@ class Stats
 
         bool swstats;           ///< Statistics on/off switch
         bool swtendency;
+        bool swbufferedoutput;  ///< Write the statistics of a time step in one batch.
         bool doing_tendency;
         std::vector<std::regex> whitelist;
         std::vector<std::regex> blacklist;
@@ -175,6 +177,30 @@ class Stats
         //Tendency calculations
         std::map<std::string, std::vector<std::string>> tendency_order;
 
+        // Reductions that are postponed to a single MPI call at the end of the statistics step.
+        struct Sum_request
+        {
+            TF* data;         // Local contribution, replaced by the global sum.
+            int n;            // Number of values.
+            const int* nmask; // Number of points in the mask per level, to set the fill values (optional).
+            TF offset;        // Offset that is added after the reduction.
+        };
+
+        struct Ratio_request
+        {
+            TF* data;           // Time series that receives the ratio of the global sums.
+            double num;         // Local contribution to the numerator.
+            double den;         // Local contribution to the denominator.
+            bool zero_if_empty; // Set the time series to zero if the denominator is zero.
+        };
+
+        std::vector<Sum_request> sum_requests;
+        std::vector<Ratio_request> ratio_requests;
+
+        void add_sum(TF* const, const int, const int* const=nullptr, const TF=TF(0.));
+        void add_ratio(TF* const, const double, const double, const bool);
+        void exec_sums();
+
         void calc_flux_2nd(TF*, const TF* const, const TF* const, const TF, TF* const, const TF* const, TF*, const int*, const unsigned int* const, const unsigned int, const int* const,
                           const int, const int, const int, const int, const int, const int, const int, const int);
         void calc_flux_4th(TF*, const TF* const, const TF* const, TF* const, const TF* const, TF*, const int*, const unsigned int* const, const unsigned int, const int* const,
@@ -35,6 +35,7 @@ template<typename> class Dump;
 template<typename> class Cross;
 template<typename> class Field3d;
 template<typename> class Timeloop;
+struct Tile;
 
 /**
  * Base class for the thermo scheme. This class is abstract and only
@@ -57,6 +58,13 @@ class Thermo
         virtual unsigned long get_time_limit(unsigned long, double) = 0;
 
         virtual void exec(const double, Stats<TF>&) = 0;
+
+        // Functions for the fused tendencies, only implemented by the schemes that support tiles.
+        // The work that exec does on the full domain, such as updating the base state, goes into
+        // prepare_tile_exec, which is called once before the tiles are processed.
+        virtual bool has_tile_exec() const { return false; } ///< Check whether the scheme can run per tile.
+        virtual void prepare_tile_exec(const double) {} ///< Prepare the tendencies of exec_tile.
+        virtual void exec_tile(const Tile&) {} ///< Add the buoyancy tendency of one tile.
         virtual void exec_stats(Stats<TF>&) = 0; ///< Calculate the statistics
         virtual void exec_column(Column<TF>&) = 0; ///< Output the column
         virtual void exec_dump(Dump<TF>&, unsigned long) = 0;
@@ -54,6 +54,7 @@ class Thermo_disabled : public Thermo<TF>
         void init() {};
         void create(Input&, Netcdf_handle&, Stats<TF>&, Column<TF>&, Cross<TF>&, Dump<TF>&) {};
         void exec(const double, Stats<TF>&) {};
+        bool has_tile_exec() const { return true; }
         void exec_stats(Stats<TF>&) {};
         void exec_column(Column<TF>&) {};
         void exec_dump(Dump<TF>&, unsigned long) {};
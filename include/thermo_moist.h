@@ -23,6 +23,7 @@
 #ifndef THERMO_MOIST_H
 #define THERMO_MOIST_H
 
+#include <map>
 #include "boundary_cyclic.h"
 #include "timedep.h"
 #include "thermo.h"
@@ -60,6 +61,9 @@ class Thermo_moist : public Thermo<TF>
         void init();
         void create(Input&, Netcdf_handle&, Stats<TF>&, Column<TF>&, Cross<TF>&, Dump<TF>&);
         void exec(const double, Stats<TF>&); ///< Add the tendencies belonging to the buoyancy.
+        bool has_tile_exec() const { return true; }
+        void prepare_tile_exec(const double); ///< Update the base state before the tiles are processed.
+        void exec_tile(const Tile&); ///< Add the buoyancy tendency of one tile.
         unsigned long get_time_limit(unsigned long, double); ///< Compute the time limit (n/a for thermo_dry)
 
         void exec_stats(Stats<TF>&);
@@ -158,6 +162,23 @@ class Thermo_moist : public Thermo<TF>
         Background_state bs;
         Background_state bs_stats;
 
+        // Cache of the diagnostic fields that need the saturation adjustment, such that they are
+        // computed once per substep. An entry is valid as long as the versions of the prognostic
+        // fields and the base state are unchanged. Each cached field takes the memory of one 3d
+        // field, and both storing an entry and a cache hit copy the full 3d field.
+        struct Diagnostic_cache_entry
+        {
+            std::vector<TF> fld;
+            unsigned long prognostic_version;
+            unsigned long basestate_version;
+            bool cyclic;
+        };
+
+        bool swdiagcache; ///< Switch for the caching of the diagnostic fields.
+        unsigned long basestate_version;       ///< Counter that is increased when the base state changes.
+        unsigned long basestate_stats_version; ///< Version of the base state that the statistics use.
+        std::map<std::string, Diagnostic_cache_entry> diag_cache;
+
         std::unique_ptr<Timedep<TF>> tdep_pbot;
         const std::string tend_name = "buoy";
         const std::string tend_longname = "Buoyancy";
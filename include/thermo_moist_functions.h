@@ -261,6 +261,198 @@ namespace Thermo_moist_functions
         return ans;
     }
 
+    // Block length of the batched saturation adjustment. The work arrays live on the stack.
+    constexpr int sat_adjust_block_size = 64;
+
+    // Newton solver of the batched saturation adjustment over one block of points. All points are
+    // iterated with the mixed-phase formulation of sat_adjust, which reduces to the warm adjustment
+    // for T >= T0. A point keeps iterating until it has converged with the criterion of sat_adjust,
+    // the converged points are masked out and the loop ends when the whole block has converged.
+    // The ice terms are skipped if no point in the block starts below T0, because the iterates of
+    // the Newton solver never drop below the start value tl.
+    template<typename TF, bool with_ice>
+    inline void sat_adjust_block(
+            TF* const restrict tnr, TF* const restrict active,
+            const TF* const restrict tl, const TF* const restrict qt,
+            const TF p, const int n)
+    {
+        constexpr int nitermax = 10;
+
+        for (int iter=0; iter<nitermax; ++iter)
+        {
+            int n_active = 0;
+
+            #pragma ivdep
+            for (int i=0; i<n; ++i)
+            {
+                const TF tnr_old = tnr[i];
+
+                // The vapor pressures are shared between qsat and its derivative.
+                const TF es_l = esat_liq(tnr_old);
+                const TF den_l = p - (TF(1.) - ep<TF>)*es_l;
+                const TF qs_l = ep<TF>*es_l/den_l;
+                const TF dqsatdT_l = (ep<TF>/den_l - (TF(1.) + ep<TF>)*ep<TF>*es_l/pow2(den_l))
+                                   * Lv<TF>*es_l / (Rv<TF>*pow2(tnr_old));
+
+                TF f;
+                TF f_prime;
+
+                if (with_ice)
+                {
+                    const TF es_i = esat_ice(tnr_old);
+                    const TF den_i = p - (TF(1.) - ep<TF>)*es_i;
+                    const TF qs_i = ep<TF>*es_i/den_i;
+                    const TF dqsatdT_i = (ep<TF>/den_i + (TF(1.) - ep<TF>)*ep<TF>*es_i/pow2(den_i))
+                                       * Ls<TF>*es_i / (Rv<TF>*pow2(tnr_old));
+
+                    const TF alpha_w = water_fraction(tnr_old);
+                    const TF alpha_i = TF(1.) - alpha_w;
+                    const TF dalphadT = (alpha_w > TF(0.) && alpha_w < TF(1.)) ? TF(0.025) : TF(0.);
+                    const TF qs = alpha_w*qs_l + alpha_i*qs_i;
+
+                    f = tnr_old - tl[i] - alpha_w*Lv<TF>/cp<TF>*qt[i] - alpha_i*Ls<TF>/cp<TF>*qt[i]
+                                        + alpha_w*Lv<TF>/cp<TF>*qs + alpha_i*Ls<TF>/cp<TF>*qs;
+
+                    f_prime = TF(1.)
+                        - dalphadT*Lv<TF>/cp<TF>*qt[i] + dalphadT*Ls<TF>/cp<TF>*qt[i]
+                        + dalphadT*Lv<TF>/cp<TF>*qs - dalphadT*Ls<TF>/cp<TF>*qs
+                        + alpha_w*Lv<TF>/cp<TF>*dqsatdT_l
+                        + alpha_i*Ls<TF>/cp<TF>*dqsatdT_i;
+                }
+                else
+                {
+                    f = tnr_old - tl[i] - Lv<TF>/cp<TF>*(qt[i] - qs_l);
+                    f_prime = TF(1.) + Lv<TF>/cp<TF>*dqsatdT_l;
+                }
+
+                const TF tnr_new = tnr_old - f/f_prime;
+                const bool is_active = active[i] > TF(0.);
+
+                tnr[i] = is_active ? tnr_new : tnr_old;
+                active[i] = (is_active && std::fabs(tnr_new - tnr_old)/tnr_old > TF(1.e-5)) ? TF(1.) : TF(0.);
+                n_active += is_active;
+            }
+
+            if (n_active == 0)
+                return;
+        }
+
+        for (int i=0; i<n; ++i)
+            if (active[i] > TF(0.))
+                throw std::runtime_error("Non-converging saturation adjustment: tl, qt, p = "
+                    + std::to_string(tl[i]) + ", " + std::to_string(qt[i]) + ", " + std::to_string(p));
+    }
+
+    // Batched version of sat_adjust over n consecutive points at pressure p. The results are written
+    // to the output arrays that are not a nullptr, they may alias thl and qt. The supersaturated points
+    // are packed before the Newton solver, such that the unsaturated points cost a single qsat_liq.
+    // The results equal those of sat_adjust up to round-off, except that non-convergence is only
+    // reported if a point has not converged after the maximum number of iterations.
+    template<typename TF>
+    inline void sat_adjust_row(
+            TF* const ql, TF* const qi, TF* const t, TF* const qs,
+            const TF* const thl, const TF* const qt,
+            const TF p, const TF exn, const int n)
+    {
+        constexpr int nb = sat_adjust_block_size;
+
+        // Work arrays of the whole block.
+        TF tl_blk[nb];
+        TF qs_blk[nb];
+        TF ql_blk[nb];
+        TF qi_blk[nb];
+
+        // Work arrays of the packed supersaturated points.
+        int index[nb];
+        TF tl    [nb];
+        TF qt_sat[nb];
+        TF tnr   [nb];
+        TF active[nb];
+
+        for (int i0=0; i0<n; i0+=nb)
+        {
+            const int m = std::min(nb, n-i0);
+
+            // Unsaturated points keep tl and qsat_liq(tl) as in sat_adjust.
+            #pragma ivdep
+            for (int i=0; i<m; ++i)
+            {
+                tl_blk[i] = thl[i0+i]*exn;
+                qs_blk[i] = qsat_liq(p, tl_blk[i]);
+                ql_blk[i] = TF(0.);
+                qi_blk[i] = TF(0.);
+            }
+
+            int n_sat = 0;
+            int n_cold = 0;
+            for (int i=0; i<m; ++i)
+                if (qt[i0+i] - qs_blk[i] > TF(0.))
+                {
+                    index[n_sat] = i;
+                    tl[n_sat] = tl_blk[i];
+                    qt_sat[n_sat] = qt[i0+i];
+                    tnr[n_sat] = tl_blk[i];
+                    active[n_sat] = TF(1.);
+                    n_cold += (tl_blk[i] < T0<TF>);
+                    ++n_sat;
+                }
+
+            if (n_sat > 0)
+            {
+                if (n_cold > 0)
+                    sat_adjust_block<TF, true>(tnr, active, tl, qt_sat, p, n_sat);
+                else
+                    sat_adjust_block<TF, false>(tnr, active, tl, qt_sat, p, n_sat);
+
+                // Compute the condensate at the converged temperature. The work arrays tl and
+                // active are reused for the liquid and ice water.
+                #pragma ivdep
+                for (int i=0; i<n_sat; ++i)
+                {
+                    const TF es_l = esat_liq(tnr[i]);
+                    const TF qs_l = ep<TF>*es_l/(p - (TF(1.) - ep<TF>)*es_l);
+
+                    TF qs_i = qs_l;
+                    if (n_cold > 0)
+                    {
+                        const TF es_i = esat_ice(tnr[i]);
+                        qs_i = ep<TF>*es_i/(p - (TF(1.) - ep<TF>)*es_i);
+                    }
+
+                    const TF alpha_w = water_fraction(tnr[i]);
+                    const TF qs_tnr = alpha_w*qs_l + (TF(1.) - alpha_w)*qs_i;
+                    const TF ql_qi = std::max(TF(0.), qt_sat[i] - qs_tnr);
+
+                    tl[i] = alpha_w*ql_qi;
+                    active[i] = (TF(1.) - alpha_w)*ql_qi;
+                    qt_sat[i] = qs_tnr;
+                }
+
+                for (int i=0; i<n_sat; ++i)
+                {
+                    const int ii = index[i];
+                    ql_blk[ii] = tl[i];
+                    qi_blk[ii] = active[i];
+                    qs_blk[ii] = qt_sat[i];
+                    tl_blk[ii] = tnr[i];
+                }
+            }
+
+            if (ql != nullptr)
+                for (int i=0; i<m; ++i)
+                    ql[i0+i] = ql_blk[i];
+            if (qi != nullptr)
+                for (int i=0; i<m; ++i)
+                    qi[i0+i] = qi_blk[i];
+            if (t != nullptr)
+                for (int i=0; i<m; ++i)
+                    t[i0+i] = tl_blk[i];
+            if (qs != nullptr)
+                for (int i=0; i<m; ++i)
+                    qs[i0+i] = qs_blk[i];
+        }
+    }
+
     template<typename TF>
     void calc_base_state(TF* restrict pref,    TF* restrict prefh,
                          TF* restrict rho,     TF* restrict rhoh,
@@ -0,0 +1,52 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2019 Chiel van Heerwaarden
+ * Copyright (c) 2011-2019 Thijs Heus
+ * Copyright (c) 2014-2019 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILE_H
+#define TILE_H
+
+#include <vector>
+#include <algorithm>
+
+/**
+ * Block of full levels [kstart, kend) and rows [jstart, jend) over the full x-extent
+ * of the domain, on which the fused tendencies are computed in one go.
+ */
+struct Tile
+{
+    int jstart;
+    int jend;
+    int kstart;
+    int kend;
+};
+
+// Cut the interior of the domain in tiles of at most jblock rows and kblock levels.
+inline std::vector<Tile> make_tiles(
+        const int jstart, const int jend, const int kstart, const int kend,
+        const int jblock, const int kblock)
+{
+    std::vector<Tile> tiles;
+    for (int k=kstart; k<kend; k+=kblock)
+        for (int j=jstart; j<jend; j+=jblock)
+            tiles.push_back({j, std::min(j+jblock, jend), k, std::min(k+kblock, kend)});
+    return tiles;
+}
+#endif
@@ -67,6 +67,7 @@ class Timeloop
 
         void save(int);
         void load(int);
+        void set_restart_state(unsigned long, unsigned long, int); // Sets the time state read from a restart file.
 
         // Query functions for main loop
         bool in_substep();
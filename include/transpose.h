@@ -27,11 +27,15 @@
 #include <mpi.h>
 #endif
 
+#include <vector>
 #include "defines.h"
 
 class Master;
 template<typename> class Grid;
 
+enum class Transpose_mode {Blocking, Pipelined, Alltoall};
+enum class Transpose_type {zx, xz, xy, yx, yz, zy};
+
 template<typename TF>
 class Transpose
 {
@@ -48,6 +52,13 @@ class Transpose
         void exec_yz(TF* const restrict, TF* const restrict); ///< Changes the transpose orientation from y to z.
         void exec_zy(TF* const restrict, TF* const restrict); ///< Changes the transpose orientation from z to y.
 
+        void set_mode(const Transpose_mode modein) { mode = modein; }
+        Transpose_mode get_mode() const { return mode; }
+
+        // Chunked, non-blocking transposes of the local levels k0 to k0+nk through packed buffers.
+        void exec_begin(TF* const restrict, TF* const restrict, const Transpose_type, const int, const int, const int);
+        void exec_finish(const int);
+
     private:
         Master& master;
         Grid<TF>& grid;
@@ -56,6 +67,8 @@ class Transpose
         void exit_mpi();
         bool mpi_types_allocated;
 
+        Transpose_mode mode;
+
         #ifdef USEMPI
         MPI_Datatype transposez;  ///< MPI datatype containing base blocks for z-orientation in zx-transpose.
         MPI_Datatype transposez2; ///< MPI datatype containing base blocks for z-orientation in zy-transpose.
@@ -63,6 +76,33 @@ class Transpose
         MPI_Datatype transposex2; ///< MPI datatype containing base blocks for x-orientation in xy-transpose.
         MPI_Datatype transposey;  ///< MPI datatype containing base blocks for y-orientation in xy-transpose.
         MPI_Datatype transposey2; ///< MPI datatype containing base blocks for y-orientation in zy-transpose.
+
+        enum class Layout {z, z2, x, x2, y, y2};
+
+        struct Box
+        {
+            int offset; // Offset of the block of a peer in the field.
+            int ni, nj; // Size of the block in i and j.
+            int jj, kk; // Strides of the field.
+        };
+
+        struct Chunk
+        {
+            TF* ar;
+            Transpose_type type;
+            int k0, nk;
+            std::vector<MPI_Request> reqs;
+        };
+
+        Box get_box(const Layout, const int, const int);
+        void get_setup(const Transpose_type, Layout&, Layout&, MPI_Comm&, int&, bool&);
+        void init_buffers();
+        void exec_alltoall(TF* const restrict, TF* const restrict, const Transpose_type);
+        void add_bytes(MPI_Datatype, const int); ///< Counts the sent bytes in the profiler.
+
+        std::vector<TF> send_buf_a, recv_buf_a; ///< Packed buffers for the zx, xz, yz and zy transposes.
+        std::vector<TF> send_buf_b, recv_buf_b; ///< Packed buffers for the xy and yx transposes.
+        std::vector<Chunk> chunks;
         #endif
 };
 #endif
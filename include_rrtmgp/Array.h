@@ -145,11 +145,25 @@ class Array
             offsets = {};
         }
 
+        // Move the data to memory that is owned by the caller, for instance memory that is shared
+        // between processes, and release the own storage. The data is copied if copy_data is true.
+        // External arrays are accessed via ptr() and operator() only, v() is empty.
+        inline void set_external(T* external_data, const bool copy_data)
+        {
+            if (copy_data)
+                std::copy(ptr(), ptr() + ncells, external_data);
+
+            std::vector<T>().swap(data);
+            this->external_data = external_data;
+        }
+
+        inline bool is_external() const { return external_data != nullptr; }
+
         inline std::vector<T>& v() { return data; }
         inline const std::vector<T>& v() const { return data; }
 
-        inline T* ptr() { return data.data(); }
-        inline const T* ptr() const { return data.data(); }
+        inline T* ptr() { return external_data ? external_data : data.data(); }
+        inline const T* ptr() const { return external_data ? external_data : data.data(); }
 
         inline int size() const { return ncells; }
 
@@ -161,12 +175,12 @@ class Array
 
         inline T max() const
         {
-            return *std::max_element(data.begin(), data.end());
+            return *std::max_element(ptr(), ptr() + ncells);
         }
 
         inline T min() const
         {
-            return *std::min_element(data.begin(), data.end());
+            return *std::min_element(ptr(), ptr() + ncells);
         }
 
         inline void operator=(std::vector<T>&& data)
@@ -178,13 +192,13 @@ class Array
         inline T& operator()(const std::array<int, N>& indices)
         {
             const int index = calc_index<N>(indices, strides, offsets);
-            return data[index];
+            return ptr()[index];
         }
 
         inline T operator()(const std::array<int, N>& indices) const
         {
             const int index = calc_index<N>(indices, strides, offsets);
-            return data[index];
+            return ptr()[index];
         }
 
         inline int dim(const int i) const { return dims[i-1]; }
@@ -228,5 +242,6 @@ class Array
         std::vector<T> data;
         std::array<int, N> strides;
         std::array<int, N> offsets;
+        T* external_data = nullptr;
 };
 #endif
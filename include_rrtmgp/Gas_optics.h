@@ -26,6 +26,7 @@
 #define GAS_OPTICS_H
 
 #include <string>
+#include <functional>
 
 #include "Array.h"
 
@@ -113,6 +114,10 @@ class Gas_optics : public Optical_props<TF>
                 const Array<TF,2>& vmr_h2o,
                 const Array<TF,2>& plev);
 
+        // Move the largest coefficient tables to memory that is provided by allocate, which takes
+        // the number of elements. The tables are copied into that memory if copy_data is true.
+        void move_tables(const std::function<TF*(const int)>& allocate, const bool copy_data);
+
         bool source_is_internal() const { return (totplnk.size() > 0) && (planck_frac.size() > 0); }
         TF get_press_ref_min() const { return press_ref_min; }
 
@@ -23,6 +23,7 @@
 #include <iostream>
 #include "master.h"
 #include "model.h"
+#include "input.h"
 
 int main(int argc, char *argv[])
 {
@@ -30,8 +31,13 @@ int main(int argc, char *argv[])
     Master master;
     try
     {
-        // Start up the master class and the Message Passing Interface.
-        master.start();
+        // Start up the master class and the Message Passing Interface. The asynchronous writes of
+        // the 3d fields need a higher MPI thread level, so the switches are read before MPI starts.
+        const std::string sim_name = (argc > 2) ? argv[2] : "microhh";
+        const std::string input_name = sim_name + ".ini";
+        const bool swasync = Input::peek_switch(input_name, "fields", "swasync")
+                          || Input::peek_switch(input_name, "dump", "swasync");
+        master.start(swasync);
 
         // Print the current version of the model.
         master.print_message("Microhh git-hash: " GITHASH "\n");
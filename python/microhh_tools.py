@@ -1,6 +1,7 @@
 import netCDF4 as nc
 import numpy   as np
 import struct  as st
+import zlib
 import glob
 import re
 import subprocess
@@ -191,10 +192,41 @@ class Read_binary:
         except:
             raise Exception('Cannot find file {}'.format(filename))
 
+        # Compressed 3D fields start with a header, and are decompressed as a whole.
+        self.data = None
+        if self.file.read(8) == b'MHHZ3D01':
+            self.data = self._read_compressed()
+            self.pos  = 0
+        else:
+            self.file.seek(0)
+
+     def _read_compressed(self):
+        itot, jtot, ktot, nrows, nchunks, stored_size, mode, pad = st.unpack('{}8i'.format(self.en), self.file.read(32))
+        tolerance = st.unpack('{}d'.format(self.en), self.file.read(8))
+        index = np.frombuffer(self.file.read(16*nchunks), dtype='{}i8'.format(self.en))
+        offsets, sizes = index[:nchunks], index[nchunks:]
+
+        dtype = np.dtype('{}f{}'.format(self.en, stored_size))
+        data = np.empty((ktot, jtot, itot))
+        nblocks = jtot // nrows
+
+        for c in range(nchunks):
+            self.file.seek(offsets[c])
+            shuffled = np.frombuffer(zlib.decompress(self.file.read(sizes[c])), dtype=np.uint8)
+            values = shuffled.reshape(stored_size, -1).T.copy().view(dtype).ravel()
+            k, jb = divmod(c, nblocks)
+            data[k, jb*nrows:(jb+1)*nrows, :] = values.reshape(nrows, itot)
+
+        return data.ravel()
+
      def close(self):
         self.file.close()
 
      def read(self, n):
+        if self.data is not None:
+            values = self.data[self.pos:self.pos+n]
+            self.pos += n
+            return values
         return np.array(st.unpack('{0}{1}{2}'.format(self.en, n, self.prec), self.file.read(n*self.TF)))
 
 class Create_ncfile():
@@ -27,6 +27,7 @@
 #include "fields.h"
 #include "stats.h"
 #include "advec_2.h"
+#include "tile.h"
 #include "defines.h"
 #include "constants.h"
 #include "finite_difference.h"
@@ -61,6 +62,7 @@ namespace
 
         TF cfl = 0;
 
+        #pragma omp parallel for reduction(max:cfl)
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -90,6 +92,7 @@ namespace
         const TF dxi = TF(1.)/dx;
         const TF dyi = TF(1.)/dy;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -121,6 +124,7 @@ namespace
         const TF dxi = TF(1.)/dx;
         const TF dyi = TF(1.)/dy;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -152,6 +156,7 @@ namespace
         const TF dxi = TF(1.)/dx;
         const TF dyi = TF(1.)/dy;
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -183,6 +188,7 @@ namespace
         const TF dxi = TF(1.)/dx;
         const TF dyi = TF(1.)/dy;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -209,6 +215,7 @@ namespace
     {
         const int ii = 1;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend+1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -225,6 +232,7 @@ namespace
             const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
             const int jj, const int kk)
     {
+        #pragma omp parallel for
         for (int k=kstart; k<kend+1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -241,6 +249,7 @@ namespace
             const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
             const int jj, const int kk)
     {
+        #pragma omp parallel for
         for (int k=kstart; k<kend+1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -335,6 +344,42 @@ void Advec_2<TF>::exec(Stats<TF>& stats)
 }
 #endif
 
+template<typename TF>
+void Advec_2<TF>::exec_tile(const Tile& tile)
+{
+    auto& gd = grid.get_grid_data();
+    advec_u(fields.mt.at("u")->fld.data(),
+            fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
+            gd.dzi.data(), gd.dx, gd.dy,
+            fields.rhoref.data(), fields.rhorefh.data(),
+            gd.istart, gd.iend, tile.jstart, tile.jend, tile.kstart, tile.kend,
+            gd.icells, gd.ijcells);
+
+    advec_v(fields.mt.at("v")->fld.data(),
+            fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
+            gd.dzi.data(), gd.dx, gd.dy,
+            fields.rhoref.data(), fields.rhorefh.data(),
+            gd.istart, gd.iend, tile.jstart, tile.jend, tile.kstart, tile.kend,
+            gd.icells, gd.ijcells);
+
+    // The tile contains the half levels [kstart, kend) of w, advec_w starts one level above the
+    // bottom index that it gets and skips the surface.
+    advec_w(fields.mt.at("w")->fld.data(),
+            fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
+            gd.dzhi.data(), gd.dx, gd.dy,
+            fields.rhoref.data(), fields.rhorefh.data(),
+            gd.istart, gd.iend, tile.jstart, tile.jend, std::max(tile.kstart, gd.kstart+1)-1, tile.kend,
+            gd.icells, gd.ijcells);
+
+    for (auto& it : fields.st)
+        advec_s(it.second->fld.data(), fields.sp.at(it.first)->fld.data(),
+                fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
+                gd.dzi.data(), gd.dx, gd.dy,
+                fields.rhoref.data(), fields.rhorefh.data(),
+                gd.istart, gd.iend, tile.jstart, tile.jend, tile.kstart, tile.kend,
+                gd.icells, gd.ijcells);
+}
+
 template<typename TF>
 void Advec_2<TF>::get_advec_flux(Field3d<TF>& advec_flux, const Field3d<TF>& fld)
 {
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <vector>
 #include "master.h"
 #include "grid.h"
 #include "fields.h"
@@ -39,6 +40,9 @@ Advec_2i3<TF>::Advec_2i3(Master& masterin, Grid<TF>& gridin, Fields<TF>& fieldsi
     const int jgc = 2;
     const int kgc = 2;
     grid.set_minimum_ghost_cells(igc, jgc, kgc);
+
+    // Number of scalars that are advected in one sweep over the velocity fields.
+    nbatch = inputin.get_item<int>("advec", "nbatch", "", 8);
 }
 
 template<typename TF>
@@ -77,6 +81,7 @@ namespace
                                   + std::abs(interp2(w[ijk    ], w[ijk+kk1]))*dzi[k]);
             }
 
+        #pragma omp parallel for reduction(max:cfl)
         for (k=kstart+1; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -176,6 +181,7 @@ namespace
                          + ( rhorefh[k+1] * std::abs(interp2(w[ijk-ii1+kk1], w[ijk+kk1])) * interp3_ws(u[ijk-kk1], u[ijk    ], u[ijk+kk1], u[ijk+kk2]) ) / rhoref[k] * dzi[k];
             }
 
+        #pragma omp parallel for
         for (k=kstart+2; k<kend-2; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -328,6 +334,7 @@ namespace
                          + ( rhorefh[k+1] * std::abs(interp2(w[ijk-jj1+kk1], w[ijk+kk1])) * interp3_ws(v[ijk-kk1], v[ijk    ], v[ijk+kk1], v[ijk+kk2]) ) / rhoref[k] * dzi[k];
             }
 
+        #pragma omp parallel for
         for (k=kstart+2; k<kend-2; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -455,6 +462,7 @@ namespace
                          + ( rhoref[k  ] * std::abs(interp2(w[ijk        ], w[ijk+kk1])) * interp3_ws(w[ijk-kk1], w[ijk    ], w[ijk+kk1], w[ijk+kk2]) ) / rhorefh[k] * dzhi[k];
             }
 
+        #pragma omp parallel for
         for (k=kstart+2; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -577,6 +585,7 @@ namespace
                          + ( rhorefh[k+1] * std::abs(w[ijk+kk1]) * interp3_ws(s[ijk-kk1], s[ijk    ], s[ijk+kk1], s[ijk+kk2]) ) / rhoref[k] * dzi[k];
             }
 
+        #pragma omp parallel for
         for (k=kstart+2; k<kend-2; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -652,6 +661,103 @@ namespace
             }
         }
 
+    // Vertical stencil of the scalar flux through a cell face in the batched kernel.
+    enum class Face_stencil {Zero, Second, Third};
+
+    template<typename TF, Face_stencil stencil>
+    inline TF flux_w_s(const TF rhorefh, const TF w, const TF sm2, const TF sm1, const TF s0, const TF sp1)
+    {
+        if (stencil == Face_stencil::Zero)
+            return TF(0.);
+        else if (stencil == Face_stencil::Second)
+            return rhorefh * w * interp2(sm1, s0);
+        else
+            return rhorefh * ( w * interp4_ws(sm2, sm1, s0, sp1) - std::abs(w) * interp3_ws(sm2, sm1, s0, sp1) );
+    }
+
+    // Advection of ns scalars at one vertical level. The scalars are processed per row, such
+    // that the rows of the velocity fields stay in cache while the scalars are swept over.
+    template<typename TF, Face_stencil stencil_bot, Face_stencil stencil_top>
+    void advec_s_batch_level(
+            TF* const* const st, const TF* const* const s, const int ns,
+            const TF* const restrict u, const TF* const restrict v, const TF* const restrict w,
+            const TF* const restrict dzi, const TF dxi, const TF dyi,
+            const TF* const restrict rhoref, const TF* const restrict rhorefh,
+            const int istart, const int iend, const int jstart, const int jend, const int k,
+            const int jj, const int kk)
+    {
+        const int ii1 = 1;
+        const int ii2 = 2;
+        const int jj1 = 1*jj;
+        const int jj2 = 2*jj;
+        const int kk1 = 1*kk;
+        const int kk2 = 2*kk;
+
+        for (int j=jstart; j<jend; ++j)
+            for (int n=0; n<ns; ++n)
+            {
+                TF* const restrict stn = st[n];
+                const TF* const restrict sn = s[n];
+
+                #pragma ivdep
+                for (int i=istart; i<iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    stn[ijk] +=
+                             - ( u[ijk+ii1] * interp4_ws(sn[ijk-ii1], sn[ijk    ], sn[ijk+ii1], sn[ijk+ii2])
+                               - u[ijk    ] * interp4_ws(sn[ijk-ii2], sn[ijk-ii1], sn[ijk    ], sn[ijk+ii1]) ) * dxi
+
+                             + ( std::abs(u[ijk+ii1]) * interp3_ws(sn[ijk-ii1], sn[ijk    ], sn[ijk+ii1], sn[ijk+ii2])
+                               - std::abs(u[ijk    ]) * interp3_ws(sn[ijk-ii2], sn[ijk-ii1], sn[ijk    ], sn[ijk+ii1]) ) * dxi
+
+                             - ( v[ijk+jj1] * interp4_ws(sn[ijk-jj1], sn[ijk    ], sn[ijk+jj1], sn[ijk+jj2])
+                               - v[ijk    ] * interp4_ws(sn[ijk-jj2], sn[ijk-jj1], sn[ijk    ], sn[ijk+jj1]) ) * dyi
+
+                             + ( std::abs(v[ijk+jj1]) * interp3_ws(sn[ijk-jj1], sn[ijk    ], sn[ijk+jj1], sn[ijk+jj2])
+                               - std::abs(v[ijk    ]) * interp3_ws(sn[ijk-jj2], sn[ijk-jj1], sn[ijk    ], sn[ijk+jj1]) ) * dyi
+
+                             - ( flux_w_s<TF, stencil_top>(rhorefh[k+1], w[ijk+kk1], sn[ijk-kk1], sn[ijk    ], sn[ijk+kk1], sn[ijk+kk2])
+                               - flux_w_s<TF, stencil_bot>(rhorefh[k  ], w[ijk    ], sn[ijk-kk2], sn[ijk-kk1], sn[ijk    ], sn[ijk+kk1]) ) / rhoref[k] * dzi[k];
+                }
+            }
+    }
+
+    // Batched version of advec_s that has the same stencils near the walls.
+    template<typename TF>
+    void advec_s_batch(
+            TF* const* const st, const TF* const* const s, const int ns,
+            const TF* const restrict u, const TF* const restrict v, const TF* const restrict w,
+            const TF* const restrict dzi, const TF dxi, const TF dyi,
+            const TF* const restrict rhoref, const TF* const restrict rhorefh,
+            const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
+            const int jj, const int kk)
+    {
+        using FS = Face_stencil;
+
+        // assume that w at the boundary equals zero...
+        advec_s_batch_level<TF, FS::Zero, FS::Second>(
+                st, s, ns, u, v, w, dzi, dxi, dyi, rhoref, rhorefh,
+                istart, iend, jstart, jend, kstart, jj, kk);
+
+        advec_s_batch_level<TF, FS::Second, FS::Third>(
+                st, s, ns, u, v, w, dzi, dxi, dyi, rhoref, rhorefh,
+                istart, iend, jstart, jend, kstart+1, jj, kk);
+
+        #pragma omp parallel for
+        for (int k=kstart+2; k<kend-2; ++k)
+            advec_s_batch_level<TF, FS::Third, FS::Third>(
+                    st, s, ns, u, v, w, dzi, dxi, dyi, rhoref, rhorefh,
+                    istart, iend, jstart, jend, k, jj, kk);
+
+        advec_s_batch_level<TF, FS::Third, FS::Second>(
+                st, s, ns, u, v, w, dzi, dxi, dyi, rhoref, rhorefh,
+                istart, iend, jstart, jend, kend-2, jj, kk);
+
+        advec_s_batch_level<TF, FS::Second, FS::Zero>(
+                st, s, ns, u, v, w, dzi, dxi, dyi, rhoref, rhorefh,
+                istart, iend, jstart, jend, kend-1, jj, kk);
+    }
+
     template<typename TF>
     void advec_flux_u(
             TF* const restrict st, const TF* const restrict s, const TF* const restrict w,
@@ -672,6 +778,7 @@ namespace
                 st[ijk] = interp2(w[ijk-ii1], w[ijk]) * interp2(s[ijk-kk1], s[ijk]);
             }
 
+        #pragma omp parallel for
         for (int k=kstart+2; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -713,6 +820,7 @@ namespace
                 st[ijk] = interp2(w[ijk-jj1], w[ijk]) * interp2(s[ijk-kk1], s[ijk]);
             }
 
+        #pragma omp parallel for
         for (int k=kstart+2; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -753,6 +861,7 @@ namespace
                 st[ijk] = w[ijk] * interp2(s[ijk-kk1], s[ijk]);
             }
 
+        #pragma omp parallel for
         for (int k=kstart+2; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -843,13 +952,35 @@ void Advec_2i3<TF>::exec(Stats<TF>& stats)
             gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
             gd.icells, gd.ijcells);
 
-    for (auto& it : fields.st)
-        advec_s(it.second->fld.data(), fields.sp.at(it.first)->fld.data(),
-                fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
-                gd.dzi.data(), gd.dxi, gd.dyi,
-                fields.rhoref.data(), fields.rhorefh.data(),
-                gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
-                gd.icells, gd.ijcells);
+    if (nbatch > 1 && fields.st.size() > 1)
+    {
+        // Advect the scalars in batches of nbatch, to share the loads of the velocity fields.
+        std::vector<TF*> st;
+        std::vector<const TF*> s;
+        for (auto& it : fields.st)
+        {
+            st.push_back(it.second->fld.data());
+            s.push_back(fields.sp.at(it.first)->fld.data());
+        }
+
+        for (int n=0; n<static_cast<int>(st.size()); n+=nbatch)
+            advec_s_batch(&st[n], &s[n], std::min(nbatch, static_cast<int>(st.size())-n),
+                    fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
+                    gd.dzi.data(), gd.dxi, gd.dyi,
+                    fields.rhoref.data(), fields.rhorefh.data(),
+                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                    gd.icells, gd.ijcells);
+    }
+    else
+    {
+        for (auto& it : fields.st)
+            advec_s(it.second->fld.data(), fields.sp.at(it.first)->fld.data(),
+                    fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
+                    gd.dzi.data(), gd.dxi, gd.dyi,
+                    fields.rhoref.data(), fields.rhorefh.data(),
+                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                    gd.icells, gd.ijcells);
+    }
 
     stats.calc_tend(*fields.mt.at("u"), tend_name);
     stats.calc_tend(*fields.mt.at("v"), tend_name);
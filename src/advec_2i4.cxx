@@ -77,6 +77,7 @@ namespace
                                   + std::abs(interp2(w[ijk    ], w[ijk+kk1]))*dzi[k]);
             }
 
+        #pragma omp parallel for reduction(max:cfl)
         for (k=kstart+1; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -162,6 +163,7 @@ namespace
                            - rhorefh[k  ] * interp2(w[ijk-ii1    ], w[ijk    ]) * interp2(u[ijk-kk1], u[ijk    ]) ) / rhoref[k] * dzi[k];
             }
 
+        #pragma omp parallel for
         for (k=kstart+2; k<kend-2; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -277,6 +279,7 @@ namespace
                            - rhorefh[k  ] * interp2(w[ijk-jj1    ], w[ijk    ]) * interp2(v[ijk-kk1], v[ijk    ]) ) / rhoref[k] * dzi[k];
             }
 
+        #pragma omp parallel for
         for (k=kstart+2; k<kend-2; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -373,6 +376,7 @@ namespace
                            - rhoref[k-1] * interp2(w[ijk-kk1    ], w[ijk    ]) * interp2(w[ijk-kk1], w[ijk    ]) ) / rhorefh[k] * dzhi[k];
             }
 
+        #pragma omp parallel for
         for (k=kstart+2; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -464,6 +468,7 @@ namespace
                            - rhorefh[k  ] * w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]) ) / rhoref[k] * dzi[k];
             }
 
+        #pragma omp parallel for
         for (k=kstart+2; k<kend-2; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -536,6 +541,7 @@ namespace
                 st[ijk] = interp2(w[ijk-ii1], w[ijk]) * interp2(s[ijk-kk1], s[ijk]);
             }
 
+        #pragma omp parallel for
         for (int k=kstart+2; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -576,6 +582,7 @@ namespace
                 st[ijk] = interp2(w[ijk-jj1], w[ijk]) * interp2(s[ijk-kk1], s[ijk]);
             }
 
+        #pragma omp parallel for
         for (int k=kstart+2; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -615,6 +622,7 @@ namespace
                 st[ijk] = w[ijk] * interp2(s[ijk-kk1], s[ijk]);
             }
 
+        #pragma omp parallel for
         for (int k=kstart+2; k<kend-1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -67,6 +67,7 @@ namespace
 
         TF cfl = 0;
 
+        #pragma omp parallel for reduction(max:cfl)
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -132,6 +133,7 @@ namespace
                          * dzi4[kstart];
             }
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend-1; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -232,6 +234,7 @@ namespace
                          * dzi4[kstart];
             }
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend-1; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -332,6 +335,7 @@ namespace
                          * dzhi4[kstart+1];
             }
 
+        #pragma omp parallel for
         for (int k=kstart+2; k<kend-1; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -432,6 +436,7 @@ namespace
                          * dzi4[kstart];
             }
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend-1; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -496,6 +501,7 @@ namespace
         const int kk1 = 1*kk;
         const int kk2 = 2*kk;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend+1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -517,6 +523,7 @@ namespace
         const int kk1 = 1*kk;
         const int kk2 = 2*kk;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend+1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -536,6 +543,7 @@ namespace
         const int kk1 = 1*kk;
         const int kk2 = 2*kk;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend+1; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
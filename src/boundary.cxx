@@ -552,12 +552,22 @@ namespace
 template<typename TF>
 void Boundary<TF>::exec(Thermo<TF>& thermo)
 {
-    boundary_cyclic.exec(fields.mp.at("u")->fld.data());
-    boundary_cyclic.exec(fields.mp.at("v")->fld.data());
-    boundary_cyclic.exec(fields.mp.at("w")->fld.data());
+    // The ghost cells and boundary values of the prognostic fields change.
+    fields.update_prognostic_version();
+
+    // Exchange the ghost cells of all prognostic fields in one aggregated message per neighbour.
+    // No work is overlapped with the exchange: update_bcs and the vertical ghost cells below
+    // read the horizontal ghost cells, so the exchange is finished directly.
+    std::vector<TF*> cyclic_fields;
+    cyclic_fields.push_back(fields.mp.at("u")->fld.data());
+    cyclic_fields.push_back(fields.mp.at("v")->fld.data());
+    cyclic_fields.push_back(fields.mp.at("w")->fld.data());
 
     for (auto& it : fields.sp)
-        boundary_cyclic.exec(it.second->fld.data());
+        cyclic_fields.push_back(it.second->fld.data());
+
+    boundary_cyclic.exec_begin(cyclic_fields);
+    boundary_cyclic.exec_finish();
 
     // Update the boundary values.
     update_bcs(thermo);
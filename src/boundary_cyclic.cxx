@@ -20,6 +20,7 @@
  * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdexcept>
 #include "master.h"
 #include "grid.h"
 #include "boundary_cyclic.h"
@@ -50,6 +51,39 @@ namespace
     template<typename TF> MPI_Datatype mpi_fp_type();
     template<> MPI_Datatype mpi_fp_type<double>() { return MPI_DOUBLE; }
     template<> MPI_Datatype mpi_fp_type<float>() { return MPI_FLOAT; }
+
+    // Copy a block of ni*nj*nk points of a 3D field, starting at index start, into a contiguous buffer.
+    template<typename TF>
+    void pack_block(
+            TF* const restrict buf, const TF* const restrict data, const int start,
+            const int ni, const int nj, const int nk, const int jj, const int kk)
+    {
+        for (int k=0; k<nk; ++k)
+            for (int j=0; j<nj; ++j)
+                #pragma ivdep
+                for (int i=0; i<ni; ++i)
+                    buf[i + j*ni + k*ni*nj] = data[start + i + j*jj + k*kk];
+    }
+
+    // Copy a contiguous buffer back into a block of ni*nj*nk points of a 3D field.
+    template<typename TF>
+    void unpack_block(
+            TF* const restrict data, const TF* const restrict buf, const int start,
+            const int ni, const int nj, const int nk, const int jj, const int kk)
+    {
+        for (int k=0; k<nk; ++k)
+            for (int j=0; j<nj; ++j)
+                #pragma ivdep
+                for (int i=0; i<ni; ++i)
+                    data[start + i + j*jj + k*kk] = buf[i + j*ni + k*ni*nj];
+    }
+
+    template<typename TF>
+    void resize_if_smaller(std::vector<TF>& buf, const int size)
+    {
+        if (buf.size() < static_cast<size_t>(size))
+            buf.resize(size);
+    }
 }
 
 template<typename TF>
@@ -115,6 +149,8 @@ void Boundary_cyclic<TF>::exit_mpi()
 template<typename TF>
 void Boundary_cyclic<TF>::exec(TF* const restrict data, Edge edge)
 {
+    Scoped_timer timer(master.get_profiler(), "boundary_cyclic");
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -134,6 +170,7 @@ void Boundary_cyclic<TF>::exec(TF* const restrict data, Edge edge)
         MPI_Isend(&data[westout], ncount, eastwestedge, md.nwest, 2, md.commxy, master.get_request_ptr());
         MPI_Irecv(&data[ eastin], ncount, eastwestedge, md.neast, 2, md.commxy, master.get_request_ptr());
         master.wait_all();
+        add_bytes(eastwestedge, 2);
     }
 
     if (edge == Edge::North_south_edge || edge == Edge::Both_edges)
@@ -153,6 +190,7 @@ void Boundary_cyclic<TF>::exec(TF* const restrict data, Edge edge)
             MPI_Isend(&data[southout], ncount, northsouthedge, md.nsouth, 2, md.commxy, master.get_request_ptr());
             MPI_Irecv(&data[ northin], ncount, northsouthedge, md.nnorth, 2, md.commxy, master.get_request_ptr());
             master.wait_all();
+            add_bytes(northsouthedge, 2);
         }
         // In case of 2D, fill all the ghost cells in the y-direction with the same value.
         else
@@ -175,9 +213,131 @@ void Boundary_cyclic<TF>::exec(TF* const restrict data, Edge edge)
     }
 }
 
+template<typename TF>
+void Boundary_cyclic<TF>::exec_begin(const std::vector<TF*>& fields)
+{
+    Scoped_timer timer(master.get_profiler(), "boundary_cyclic");
+
+    auto& gd = grid.get_grid_data();
+    auto& md = master.get_MPI_data();
+
+    if (!pending_fields.empty())
+        throw std::runtime_error("Boundary_cyclic::exec_begin called while an exchange is in flight");
+
+    // Do not post messages without fields, because exec_finish does not wait for them.
+    if (fields.empty())
+        return;
+
+    pending_fields = fields;
+
+    const int nfields = pending_fields.size();
+    const int nblock  = gd.igc*gd.jcells*gd.kcells;
+    const int ncount  = nfields*nblock;
+
+    resize_if_smaller(send_buf_a, ncount);
+    resize_if_smaller(send_buf_b, ncount);
+    resize_if_smaller(recv_buf_a, ncount);
+    resize_if_smaller(recv_buf_b, ncount);
+
+    const int eastout = gd.iend-gd.igc;
+    const int westout = gd.istart;
+
+    // Pack the east and west edges of all fields into one buffer per neighbour.
+    for (int n=0; n<nfields; ++n)
+    {
+        pack_block(&send_buf_a[n*nblock], pending_fields[n], eastout, gd.igc, gd.jcells, gd.kcells, gd.icells, gd.ijcells);
+        pack_block(&send_buf_b[n*nblock], pending_fields[n], westout, gd.igc, gd.jcells, gd.kcells, gd.icells, gd.ijcells);
+    }
+
+    // Use tags that differ from the ones in exec, such that single field exchanges can be done in between.
+    MPI_Irecv(recv_buf_a.data(), ncount, mpi_fp_type<TF>(), md.nwest, 3, md.commxy, &batch_reqs[0]);
+    MPI_Irecv(recv_buf_b.data(), ncount, mpi_fp_type<TF>(), md.neast, 4, md.commxy, &batch_reqs[1]);
+    MPI_Isend(send_buf_a.data(), ncount, mpi_fp_type<TF>(), md.neast, 3, md.commxy, &batch_reqs[2]);
+    MPI_Isend(send_buf_b.data(), ncount, mpi_fp_type<TF>(), md.nwest, 4, md.commxy, &batch_reqs[3]);
+
+    master.get_profiler().add_bytes("boundary_cyclic", 2*sizeof(TF)*ncount);
+}
+
+template<typename TF>
+void Boundary_cyclic<TF>::exec_finish()
+{
+    auto& gd = grid.get_grid_data();
+    auto& md = master.get_MPI_data();
+
+    if (pending_fields.empty())
+        return;
+
+    const int nfields = pending_fields.size();
+
+    // Complete the east-west exchange and unpack the ghost cells.
+    {
+        Scoped_timer timer(master.get_profiler(), "boundary_cyclic");
+
+        MPI_Waitall(4, batch_reqs, MPI_STATUSES_IGNORE);
+
+        const int nblock_ew = gd.igc*gd.jcells*gd.kcells;
+        const int westin = 0;
+        const int eastin = gd.iend;
+
+        for (int n=0; n<nfields; ++n)
+        {
+            unpack_block(pending_fields[n], &recv_buf_a[n*nblock_ew], westin, gd.igc, gd.jcells, gd.kcells, gd.icells, gd.ijcells);
+            unpack_block(pending_fields[n], &recv_buf_b[n*nblock_ew], eastin, gd.igc, gd.jcells, gd.kcells, gd.icells, gd.ijcells);
+        }
+    }
+
+    if (gd.jtot > 1)
+    {
+        Scoped_timer timer(master.get_profiler(), "boundary_cyclic");
+
+        // The north-south edges include the east-west ghost cells, so they can only be sent now.
+        const int nblock_ns = gd.icells*gd.jgc*gd.kcells;
+        const int ncount = nfields*nblock_ns;
+
+        resize_if_smaller(send_buf_a, ncount);
+        resize_if_smaller(send_buf_b, ncount);
+        resize_if_smaller(recv_buf_a, ncount);
+        resize_if_smaller(recv_buf_b, ncount);
+
+        const int northout = (gd.jend-gd.jgc)*gd.icells;
+        const int southin  = 0;
+        const int southout = gd.jstart*gd.icells;
+        const int northin  = gd.jend  *gd.icells;
+
+        for (int n=0; n<nfields; ++n)
+        {
+            pack_block(&send_buf_a[n*nblock_ns], pending_fields[n], northout, gd.icells, gd.jgc, gd.kcells, gd.icells, gd.ijcells);
+            pack_block(&send_buf_b[n*nblock_ns], pending_fields[n], southout, gd.icells, gd.jgc, gd.kcells, gd.icells, gd.ijcells);
+        }
+
+        MPI_Irecv(recv_buf_a.data(), ncount, mpi_fp_type<TF>(), md.nsouth, 5, md.commxy, &batch_reqs[0]);
+        MPI_Irecv(recv_buf_b.data(), ncount, mpi_fp_type<TF>(), md.nnorth, 6, md.commxy, &batch_reqs[1]);
+        MPI_Isend(send_buf_a.data(), ncount, mpi_fp_type<TF>(), md.nnorth, 5, md.commxy, &batch_reqs[2]);
+        MPI_Isend(send_buf_b.data(), ncount, mpi_fp_type<TF>(), md.nsouth, 6, md.commxy, &batch_reqs[3]);
+        MPI_Waitall(4, batch_reqs, MPI_STATUSES_IGNORE);
+        master.get_profiler().add_bytes("boundary_cyclic", 2*sizeof(TF)*ncount);
+
+        for (int n=0; n<nfields; ++n)
+        {
+            unpack_block(pending_fields[n], &recv_buf_a[n*nblock_ns], southin, gd.icells, gd.jgc, gd.kcells, gd.icells, gd.ijcells);
+            unpack_block(pending_fields[n], &recv_buf_b[n*nblock_ns], northin, gd.icells, gd.jgc, gd.kcells, gd.icells, gd.ijcells);
+        }
+    }
+    else
+    {
+        // In case of 2D, the north-south ghost cells are filled locally.
+        for (auto& fld : pending_fields)
+            exec(fld, Edge::North_south_edge);
+    }
+
+    pending_fields.clear();
+}
+
 template<typename TF>
 void Boundary_cyclic<TF>::exec_2d(TF* const restrict data)
 {
+    Scoped_timer timer(master.get_profiler(), "boundary_cyclic");
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -201,6 +361,7 @@ void Boundary_cyclic<TF>::exec_2d(TF* const restrict data)
     MPI_Isend(&data[westout], ncount, eastwestedge2d, md.nwest, 2, md.commxy, master.get_request_ptr());
     MPI_Irecv(&data[ eastin], ncount, eastwestedge2d, md.neast, 2, md.commxy, master.get_request_ptr());
     master.wait_all();
+    add_bytes(eastwestedge2d, 2);
 
     // If the run is 3D, apply the BCs.
     if (gd.jtot > 1)
@@ -211,6 +372,7 @@ void Boundary_cyclic<TF>::exec_2d(TF* const restrict data)
         MPI_Isend(&data[southout], ncount, northsouthedge2d, md.nsouth, 2, md.commxy, master.get_request_ptr());
         MPI_Irecv(&data[ northin], ncount, northsouthedge2d, md.nnorth, 2, md.commxy, master.get_request_ptr());
         master.wait_all();
+        add_bytes(northsouthedge2d, 2);
     }
     // In case of 2D, fill all the ghost cells with the current value.
     else
@@ -236,6 +398,8 @@ void Boundary_cyclic<TF>::exec_2d(TF* const restrict data)
 template<typename TF>
 void Boundary_cyclic<TF>::exec(unsigned int* const restrict data, Edge edge)
 {
+    Scoped_timer timer(master.get_profiler(), "boundary_cyclic");
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -255,6 +419,7 @@ void Boundary_cyclic<TF>::exec(unsigned int* const restrict data, Edge edge)
         MPI_Isend(&data[westout], ncount, eastwestedge_uint, md.nwest, 2, md.commxy, master.get_request_ptr());
         MPI_Irecv(&data[ eastin], ncount, eastwestedge_uint, md.neast, 2, md.commxy, master.get_request_ptr());
         master.wait_all();
+        add_bytes(eastwestedge_uint, 2);
     }
 
     if (edge == Edge::North_south_edge || edge == Edge::Both_edges)
@@ -274,6 +439,7 @@ void Boundary_cyclic<TF>::exec(unsigned int* const restrict data, Edge edge)
             MPI_Isend(&data[southout], ncount, northsouthedge_uint, md.nsouth, 2, md.commxy, master.get_request_ptr());
             MPI_Irecv(&data[ northin], ncount, northsouthedge_uint, md.nnorth, 2, md.commxy, master.get_request_ptr());
             master.wait_all();
+            add_bytes(northsouthedge_uint, 2);
         }
         // In case of 2D, fill all the ghost cells in the y-direction with the same value.
         else
@@ -299,6 +465,8 @@ void Boundary_cyclic<TF>::exec(unsigned int* const restrict data, Edge edge)
 template<typename TF>
 void Boundary_cyclic<TF>::exec_2d(unsigned int* const restrict data)
 {
+    Scoped_timer timer(master.get_profiler(), "boundary_cyclic");
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -322,6 +490,7 @@ void Boundary_cyclic<TF>::exec_2d(unsigned int* const restrict data)
     MPI_Isend(&data[westout], ncount, eastwestedge2d_uint, md.nwest, 2, md.commxy, master.get_request_ptr());
     MPI_Irecv(&data[ eastin], ncount, eastwestedge2d_uint, md.neast, 2, md.commxy, master.get_request_ptr());
     master.wait_all();
+    add_bytes(eastwestedge2d_uint, 2);
 
     // If the run is 3D, apply the BCs.
     if (gd.jtot > 1)
@@ -332,6 +501,7 @@ void Boundary_cyclic<TF>::exec_2d(unsigned int* const restrict data)
         MPI_Isend(&data[southout], ncount, northsouthedge2d_uint, md.nsouth, 2, md.commxy, master.get_request_ptr());
         MPI_Irecv(&data[ northin], ncount, northsouthedge2d_uint, md.nnorth, 2, md.commxy, master.get_request_ptr());
         master.wait_all();
+        add_bytes(northsouthedge2d_uint, 2);
     }
     // In case of 2D, fill all the ghost cells with the current value.
     else
@@ -354,6 +524,18 @@ void Boundary_cyclic<TF>::exec_2d(unsigned int* const restrict data)
     }
 }
 
+
+template<typename TF>
+void Boundary_cyclic<TF>::add_bytes(MPI_Datatype type, const int nmessages)
+{
+    Profiler& profiler = master.get_profiler();
+    if (!profiler.get_switch())
+        return;
+
+    int nbytes;
+    MPI_Type_size(type, &nbytes);
+    profiler.add_bytes("boundary_cyclic", static_cast<unsigned long>(nbytes)*nmessages);
+}
 #else
 
 template<typename TF>
@@ -442,6 +624,25 @@ void Boundary_cyclic<TF>::exec(TF* restrict data, Edge edge)
     }
 }
 
+template<typename TF>
+void Boundary_cyclic<TF>::exec_begin(const std::vector<TF*>& fields)
+{
+    if (!pending_fields.empty())
+        throw std::runtime_error("Boundary_cyclic::exec_begin called while an exchange is in flight");
+
+    // Without MPI there is nothing in flight, all ghost cells are filled in exec_finish.
+    pending_fields = fields;
+}
+
+template<typename TF>
+void Boundary_cyclic<TF>::exec_finish()
+{
+    for (auto& fld : pending_fields)
+        exec(fld);
+
+    pending_fields.clear();
+}
+
 template<typename TF>
 void Boundary_cyclic<TF>::exec_2d(TF* restrict data)
 {
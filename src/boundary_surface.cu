@@ -283,8 +283,12 @@ void Boundary_surface<TF>::prepare_device()
     cuda_safe_call(cudaMemcpy2D(ustar_g, dimemsize, ustar.data(), dimemsize, dimemsize, gd.jcells, cudaMemcpyHostToDevice));
     cuda_safe_call(cudaMemcpy2D(nobuk_g, iimemsize, nobuk.data(), iimemsize, iimemsize, gd.jcells, cudaMemcpyHostToDevice));
 
-    cuda_safe_call(cudaMemcpy(zL_sl_g, zL_sl.data(), nzL*sizeof(float), cudaMemcpyHostToDevice));
-    cuda_safe_call(cudaMemcpy(f_sl_g,  f_sl.data(),  nzL*sizeof(float), cudaMemcpyHostToDevice));
+    // The device keeps the lookup table in single precision.
+    const std::vector<float> zL_sl_f(zL_sl.begin(), zL_sl.end());
+    const std::vector<float> f_sl_f (f_sl.begin(),  f_sl.end());
+
+    cuda_safe_call(cudaMemcpy(zL_sl_g, zL_sl_f.data(), nzL*sizeof(float), cudaMemcpyHostToDevice));
+    cuda_safe_call(cudaMemcpy(f_sl_g,  f_sl_f.data(),  nzL*sizeof(float), cudaMemcpyHostToDevice));
 }
 
 // TMP BVS
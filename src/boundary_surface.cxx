@@ -45,15 +45,59 @@ namespace
     // Size of the lookup table.
     const int nzL = 10000; // Size of the lookup table for MO iterations.
 
+    // Find the first entry of the monotonically increasing f that is not smaller than Ri. The
+    // search gallops from the index n of the previous time step towards Ri and finishes with a
+    // bisection, such that it takes at most O(log(nzL)) steps for any change in the forcings
+    // and only a few steps if Ri hardly changes.
     template<typename TF>
-    TF find_zL(const float* const restrict zL, const float* const restrict f,
-               int& n, const float Ri)
+    int find_zL_index(const TF* const restrict f, const int n, const TF Ri)
     {
-        // Determine search direction. All checks are at float accuracy.
-        if ( (f[n]-Ri) > 0.f )
-            while ( (f[n-1]-Ri) > 0.f && n > 0.f) { --n; }
+        // The bisection maintains f[lo] < Ri <= f[hi], where lo = -1 and hi = nzL act as sentinels.
+        int lo, hi;
+        int step = 1;
+
+        if (f[n] >= Ri)
+        {
+            hi = n;
+            lo = n-step;
+            while (lo >= 0 && f[lo] >= Ri)
+            {
+                hi = lo;
+                step *= 2;
+                lo -= step;
+            }
+            lo = std::max(lo, -1);
+        }
         else
-            while ( (f[n]-Ri) < 0.f && n < (nzL-1) ) { ++n; }
+        {
+            lo = n;
+            hi = n+step;
+            while (hi < nzL && f[hi] < Ri)
+            {
+                lo = hi;
+                step *= 2;
+                hi += step;
+            }
+            hi = std::min(hi, nzL);
+        }
+
+        while (hi-lo > 1)
+        {
+            const int mid = (lo+hi)/2;
+            if (f[mid] < Ri)
+                lo = mid;
+            else
+                hi = mid;
+        }
+
+        return std::min(hi, nzL-1);
+    }
+
+    template<typename TF>
+    TF find_zL(const TF* const restrict zL, const TF* const restrict f,
+               int& n, const TF Ri)
+    {
+        n = find_zL_index(f, n, Ri);
 
         const TF zL0 = (n == 0 || n == nzL-1) ? zL[n] : zL[n-1] + (Ri-f[n-1]) / (f[n]-f[n-1]) * (zL[n]-zL[n-1]);
 
@@ -61,23 +105,57 @@ namespace
     }
 
     template<typename TF>
-    TF calc_obuk_noslip_flux(const float* restrict zL, const float* restrict f,
-                             int& n,
-                             const TF du, const TF bfluxbot, const TF zsl)
+    TF calc_ri_noslip_flux(const TF du, const TF bfluxbot, const TF zsl)
+    {
+        return -Constants::kappa<TF> * bfluxbot * zsl / std::pow(du, 3);
+    }
+
+    template<typename TF>
+    TF calc_ri_noslip_dirichlet(const TF du, const TF db, const TF zsl)
     {
-        // Calculate the appropriate Richardson number and reduce precision.
-        const float Ri = -Constants::kappa<TF> * bfluxbot * zsl / std::pow(du, 3);
-        return zsl/find_zL<TF>(zL, f, n, Ri);
+        return Constants::kappa<TF> * db * zsl / std::pow(du, 2);
     }
 
+    // Evaluation functions of the lookup table, which map z/L onto the Richardson number.
     template<typename TF>
-    TF calc_obuk_noslip_dirichlet(const float* restrict zL, const float* restrict f,
-                                  int& n,
-                                  const TF du, const TF db, const TF zsl)
+    TF calc_f_noslip_flux(const TF zL, const TF zsl, const TF z0m, const TF z0h)
     {
-        // Calculate the appropriate Richardson number and reduce precision.
-        const float Ri = Constants::kappa<TF> * db * zsl / std::pow(du, 2);
-        return zsl/find_zL<TF>(zL, f, n, Ri);
+        return zL * std::pow(most::fm(zsl, z0m, zsl/zL), 3);
+    }
+
+    template<typename TF>
+    TF calc_f_noslip_dirichlet(const TF zL, const TF zsl, const TF z0m, const TF z0h)
+    {
+        return zL * std::pow(most::fm(zsl, z0m, zsl/zL), 2) / most::fh(zsl, z0h, zsl/zL);
+    }
+
+    // Refine the interpolated z/L of a row with Newton iterations on the exact MOST functions. The
+    // derivative is taken from the table interval the solution is in, and the iterates are kept
+    // within that interval. Points at the end of the table are left untouched.
+    template<typename TF, TF (*calc_f)(const TF, const TF, const TF, const TF)>
+    void refine_zL(TF* const restrict zL0, const TF* const restrict Ri, const int* const restrict nobuk,
+                   const TF* const restrict zL, const TF* const restrict f,
+                   const TF zsl, const TF z0m, const TF z0h, const int niter,
+                   const int istart, const int iend)
+    {
+        #pragma ivdep
+        for (int i=istart; i<iend; ++i)
+        {
+            const int n = nobuk[i];
+            if (n == 0 || n == nzL-1)
+                continue;
+
+            const TF dfdzL = (f[n]-f[n-1]) / (zL[n]-zL[n-1]);
+
+            TF zLi = zL0[i];
+            for (int iter=0; iter<niter; ++iter)
+            {
+                zLi -= (calc_f(zLi, zsl, z0m, z0h) - Ri[i]) / dfdzL;
+                zLi = std::min(std::max(zLi, zL[n-1]), zL[n]);
+            }
+
+            zL0[i] = zLi;
+        }
     }
 
     template<typename TF>
@@ -126,8 +204,8 @@ namespace
                    TF* restrict u, TF* restrict v, TF* restrict b,
                    TF* restrict ubot , TF* restrict vbot, TF* restrict bbot,
                    TF* restrict dutot, const TF* restrict z,
-                   const float* zL_sl, const float* f_sl, int* nobuk,
-                   const TF z0m, const TF z0h,
+                   const TF* zL_sl, const TF* f_sl, int* nobuk,
+                   const TF z0m, const TF z0h, const int nsurfiter,
                    const int istart, const int iend, const int jstart, const int jend, const int kstart,
                    const int icells, const int jcells, const int kk,
                    Boundary_type mbcbot, Boundary_type thermobc,
@@ -171,27 +249,67 @@ namespace
         // case 2: fixed buoyancy surface value and free ustar
         else if (mbcbot == Boundary_type::Dirichlet_type && thermobc == Boundary_type::Flux_type)
         {
+            const TF zsl = z[kstart];
+            std::vector<TF> Ri(icells);
+            std::vector<TF> zL(icells);
+
             for (int j=0; j<jcells; ++j)
+            {
+                const int ij0 = j*jj;
+
+                for (int i=0; i<icells; ++i)
+                {
+                    const int ij = i + j*jj;
+                    Ri[i] = calc_ri_noslip_flux(dutot[ij], bfluxbot[ij], zsl);
+                    zL[i] = find_zL(zL_sl, f_sl, nobuk[ij], Ri[i]);
+                }
+
+                if (nsurfiter > 0)
+                    refine_zL<TF, calc_f_noslip_flux<TF>>(
+                            zL.data(), Ri.data(), &nobuk[ij0], zL_sl, f_sl,
+                            zsl, z0m, z0h, nsurfiter, 0, icells);
+
                 #pragma ivdep
                 for (int i=0; i<icells; ++i)
                 {
                     const int ij = i + j*jj;
-                    obuk [ij] = calc_obuk_noslip_flux(zL_sl, f_sl, nobuk[ij], dutot[ij], bfluxbot[ij], z[kstart]);
-                    ustar[ij] = dutot[ij] * most::fm(z[kstart], z0m, obuk[ij]);
+                    obuk [ij] = zsl/zL[i];
+                    ustar[ij] = dutot[ij] * most::fm(zsl, z0m, obuk[ij]);
                 }
+            }
         }
         else if (mbcbot == Boundary_type::Dirichlet_type && thermobc == Boundary_type::Dirichlet_type)
         {
+            const TF zsl = z[kstart];
+            std::vector<TF> Ri(icells);
+            std::vector<TF> zL(icells);
+
             for (int j=0; j<jcells; ++j)
-                #pragma ivdep
+            {
+                const int ij0 = j*jj;
+
                 for (int i=0; i<icells; ++i)
                 {
                     const int ij  = i + j*jj;
                     const int ijk = i + j*jj + kstart*kk;
                     const TF db = b[ijk] - bbot[ij];
-                    obuk [ij] = calc_obuk_noslip_dirichlet(zL_sl, f_sl, nobuk[ij], dutot[ij], db, z[kstart]);
-                    ustar[ij] = dutot[ij] * most::fm(z[kstart], z0m, obuk[ij]);
+                    Ri[i] = calc_ri_noslip_dirichlet(dutot[ij], db, zsl);
+                    zL[i] = find_zL(zL_sl, f_sl, nobuk[ij], Ri[i]);
                 }
+
+                if (nsurfiter > 0)
+                    refine_zL<TF, calc_f_noslip_dirichlet<TF>>(
+                            zL.data(), Ri.data(), &nobuk[ij0], zL_sl, f_sl,
+                            zsl, z0m, z0h, nsurfiter, 0, icells);
+
+                #pragma ivdep
+                for (int i=0; i<icells; ++i)
+                {
+                    const int ij = i + j*jj;
+                    obuk [ij] = zsl/zL[i];
+                    ustar[ij] = dutot[ij] * most::fm(zsl, z0m, obuk[ij]);
+                }
+            }
         }
     }
 
@@ -460,6 +578,11 @@ void Boundary_surface<TF>::process_input(Input& inputin, Thermo<TF>& thermo)
     z0m = inputin.get_item<TF>("boundary", "z0m", "");
     z0h = inputin.get_item<TF>("boundary", "z0h", "");
 
+    // Number of Newton iterations on the MOST functions after the table lookup of z/L.
+    nsurfiter = inputin.get_item<int>("boundary", "nsurfiter", "", 0);
+    if (nsurfiter < 0)
+        throw std::runtime_error("nsurfiter cannot be negative");
+
     // crash in case fixed gradient is prescribed
     if (mbcbot == Boundary_type::Neumann_type)
     {
@@ -686,13 +809,13 @@ void Boundary_surface<TF>::init_solver()
     {
         const TF zsl = gd.z[gd.kstart];
         for (int n=0; n<nzL; ++n)
-            f_sl[n] = zL_sl[n] * std::pow(most::fm(zsl, z0m, zsl/zL_sl[n]), 3);
+            f_sl[n] = calc_f_noslip_flux(zL_sl[n], zsl, z0m, z0h);
     }
     else if (mbcbot == Boundary_type::Dirichlet_type && thermobc == Boundary_type::Dirichlet_type)
     {
         const TF zsl = gd.z[gd.kstart];
         for (int n=0; n<nzL; ++n)
-            f_sl[n] = zL_sl[n] * std::pow(most::fm(zsl, z0m, zsl/zL_sl[n]), 2) / most::fh(zsl, z0h, zsl/zL_sl[n]);
+            f_sl[n] = calc_f_noslip_dirichlet(zL_sl[n], zsl, z0m, z0h);
     }
 }
 
@@ -727,7 +850,7 @@ void Boundary_surface<TF>::update_bcs(Thermo<TF>& thermo)
                   fields.mp.at("u")->fld_bot.data(), fields.mp.at("v")->fld_bot.data(), buoy->fld_bot.data(),
                   tmp->fld.data(), gd.z.data(),
                   zL_sl.data(), f_sl.data(), nobuk.data(),
-                  z0m, z0h,
+                  z0m, z0h, nsurfiter,
                   gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart,
                   gd.icells, gd.jcells, gd.ijcells,
                   mbcbot, thermobc, boundary_cyclic);
@@ -44,7 +44,10 @@ Column<TF>::Column(Master& masterin, Grid<TF>& gridin, Fields<TF>& fieldsin, Inp
     swcolumn = inputin.get_item<bool>("column", "swcolumn", "", false);
 
     if (swcolumn)
+    {
         sampletime = inputin.get_item<double>("column", "sampletime", "");
+        swbufferedoutput = inputin.get_item<bool>("column", "swbufferedoutput", "", false);
+    }
 }
 
 template<typename TF>
@@ -109,6 +112,8 @@ void Column<TF>::create(Input& inputin, Timeloop<TF>& timeloop, std::string sim_
         // 2. Make the NetCDF file.
         col.data_file = std::make_unique<Netcdf_file>(
                 master, filename.str(), Netcdf_mode::Create, mpiid_column);
+        if (swbufferedoutput)
+            col.data_file->set_buffered();
     }
 
     // Create dimensions.
@@ -32,9 +32,49 @@
 #include "constants.h"
 #include "finite_difference.h"
 #include "timeloop.h"
+#include "netcdf_interface.h"
 
 namespace
 {
+    #ifdef USEMPI
+    template<typename TF> MPI_Datatype mpi_fp_type();
+    template<> MPI_Datatype mpi_fp_type<double>() { return MPI_DOUBLE; }
+    template<> MPI_Datatype mpi_fp_type<float>() { return MPI_FLOAT; }
+    #endif
+
+    // Copy the local part of an xz slice without ghost cells into a contiguous block.
+    template<typename TF>
+    void extract_xz(TF* const restrict block, const TF* const restrict data, const int jloc,
+            const int imax, const int kmax, const int igc, const int kgc, const int icells, const int ijcells)
+    {
+        for (int k=0; k<kmax; ++k)
+            #pragma ivdep
+            for (int i=0; i<imax; ++i)
+                block[i + k*imax] = data[i+igc + jloc*icells + (k+kgc)*ijcells];
+    }
+
+    // Copy the local part of a yz slice without ghost cells into a contiguous block.
+    template<typename TF>
+    void extract_yz(TF* const restrict block, const TF* const restrict data, const int iloc,
+            const int jmax, const int kmax, const int jgc, const int kgc, const int icells, const int ijcells)
+    {
+        for (int k=0; k<kmax; ++k)
+            #pragma ivdep
+            for (int j=0; j<jmax; ++j)
+                block[j + k*jmax] = data[iloc + (j+jgc)*icells + (k+kgc)*ijcells];
+    }
+
+    // Copy the local part of an xy slice without ghost cells into a contiguous block.
+    template<typename TF>
+    void extract_xy(TF* const restrict block, const TF* const restrict data,
+            const int imax, const int jmax, const int igc, const int jgc, const int icells)
+    {
+        for (int j=0; j<jmax; ++j)
+            #pragma ivdep
+            for (int i=0; i<imax; ++i)
+                block[i + j*imax] = data[i+igc + (j+jgc)*icells];
+    }
+
     template<typename TF>
     void calc_lngrad_4th(const TF* const restrict a, TF* const restrict lngrad, TF dxi, TF dyi, const TF* const restrict dzi4,
             int icells, int ijcells, int istart, int iend, int jstart, int jend, int kstart, int kend)
@@ -234,9 +274,21 @@ Cross<TF>::Cross(Master& masterin, Grid<TF>& gridin, Fields<TF>& fieldsin, Input
     field3d_io(master, grid)
 {
     swcross = inputin.get_item<bool>("cross", "swcross", "", false);
+    swformat = Cross_format::Binary;
 
     if (swcross)
     {
+        std::string swformat_in = inputin.get_item<std::string>("cross", "swformat", "", "binary");
+        if (swformat_in == "binary")
+            swformat = Cross_format::Binary;
+        else if (swformat_in == "netcdf")
+            swformat = Cross_format::Netcdf;
+        else
+        {
+            std::string msg = swformat_in + " is an illegal value for swformat";
+            throw std::runtime_error(msg);
+        }
+
        // Get the time at which the cross sections are triggered.
         sampletime = inputin.get_item<double>("cross", "sampletime", "");
 
@@ -511,6 +563,258 @@ std::vector<std::string> Cross<TF>::get_enabled_variables(const std::vector<std:
 }
 
 
+template<typename TF>
+void Cross<TF>::gather_slice(std::vector<TF>& slice, const TF* const restrict block, Cross_plane plane, const int idx)
+{
+    auto& gd = grid.get_grid_data();
+
+    // Size of the global slice (na is the contiguous direction).
+    const int natot = (plane == Cross_plane::yz) ? gd.jtot : gd.itot;
+    const int nbtot = (plane == Cross_plane::xy) ? gd.jtot : gd.kmax;
+
+    #ifdef USEMPI
+    auto& md = master.get_MPI_data();
+
+    // Size of the local block.
+    const int na = (plane == Cross_plane::yz) ? gd.jmax : gd.imax;
+    const int nb = (plane == Cross_plane::xy) ? gd.jmax : gd.kmax;
+
+    // Only the processes that own part of the slice contribute to the gather.
+    auto contributes = [&](const int r)
+    {
+        if (plane == Cross_plane::xz)
+            return r / md.npx == idx / gd.jmax;
+        else if (plane == Cross_plane::yz)
+            return r % md.npx == idx / gd.imax;
+        else
+            return true;
+    };
+
+    const int nblock = na*nb;
+    const bool is_root = (md.mpiid == 0);
+
+    std::vector<int> counts;
+    std::vector<int> displs;
+    std::vector<TF> recv;
+
+    if (is_root)
+    {
+        counts.resize(md.nprocs);
+        displs.resize(md.nprocs);
+
+        int ntot = 0;
+        for (int r=0; r<md.nprocs; ++r)
+        {
+            counts[r] = contributes(r) ? nblock : 0;
+            displs[r] = ntot;
+            ntot += counts[r];
+        }
+        recv.resize(ntot);
+    }
+
+    const int sendcount = contributes(md.mpiid) ? nblock : 0;
+    MPI_Gatherv(block, sendcount, mpi_fp_type<TF>(),
+            recv.data(), counts.data(), displs.data(), mpi_fp_type<TF>(), 0, md.commxy);
+
+    if (is_root)
+    {
+        slice.resize(natot*nbtot);
+
+        for (int r=0; r<md.nprocs; ++r)
+        {
+            if (counts[r] == 0)
+                continue;
+
+            const int a0 = (plane == Cross_plane::yz) ? (r / md.npx)*gd.jmax : (r % md.npx)*gd.imax;
+            const int b0 = (plane == Cross_plane::xy) ? (r / md.npx)*gd.jmax : 0;
+            const TF* const restrict rbuf = &recv[displs[r]];
+
+            for (int b=0; b<nb; ++b)
+                #pragma ivdep
+                for (int a=0; a<na; ++a)
+                    slice[a0+a + (b0+b)*natot] = rbuf[a + b*na];
+        }
+    }
+    #else
+    slice.assign(block, block + natot*nbtot);
+    #endif
+}
+
+template<typename TF>
+Cross_file<TF>& Cross<TF>::get_cross_file(
+        const std::string& name, Cross_plane plane, const std::vector<int>& indices,
+        const std::array<int,3>& loc, const int iotime)
+{
+    const std::string plane_name =
+        (plane == Cross_plane::xz) ? "xz" : (plane == Cross_plane::yz) ? "yz" : "xy";
+    const std::string key = name + "." + plane_name;
+
+    auto it = cross_files.find(key);
+    if (it != cross_files.end())
+        return it->second;
+
+    auto& gd = grid.get_grid_data();
+
+    const std::string xdim = loc[0] ? "xh" : "x";
+    const std::string ydim = loc[1] ? "yh" : "y";
+    const std::string zdim = loc[2] ? "zh" : "z";
+
+    auto xcoord = [&](const int i) { return loc[0] ? i*gd.dx : (i+TF(0.5))*gd.dx; };
+    auto ycoord = [&](const int j) { return loc[1] ? j*gd.dy : (j+TF(0.5))*gd.dy; };
+    auto zcoord = [&](const int k) { return loc[2] ? gd.zh[k+gd.kgc] : gd.z[k+gd.kgc]; };
+
+    // The file is named after the first output time, such that restarts start a new file.
+    char filename[256];
+    std::sprintf(filename, "%s.%s.%07d.nc", name.c_str(), plane_name.c_str(), iotime);
+
+    Cross_file<TF> cf;
+    cf.data_file = std::make_unique<Netcdf_file>(master, filename, Netcdf_mode::Create);
+    cf.filename = filename;
+    cf.nslices = indices.size();
+    cf.record = -1;
+    cf.last_iotime = -1;
+
+    // The slice index is the slowest varying spatial dimension, the plane itself follows.
+    std::vector<std::string> dims = {"time"};
+    std::vector<std::pair<std::string, std::vector<TF>>> coords;
+
+    auto add_dim = [&](const std::string& dim, std::vector<TF>&& values)
+    {
+        cf.data_file->add_dimension(dim, values.size());
+        dims.push_back(dim);
+        coords.emplace_back(dim, std::move(values));
+    };
+
+    auto make_coord = [](const std::vector<int>& idx, const int n, auto&& f)
+    {
+        std::vector<TF> values;
+        if (idx.empty())
+            for (int i=0; i<n; ++i)
+                values.push_back(f(i));
+        else
+            for (const int i : idx)
+                values.push_back(f(i));
+        return values;
+    };
+
+    const std::vector<int> all;
+
+    if (plane == Cross_plane::xz)
+    {
+        add_dim(ydim, make_coord(indices, 0, ycoord));
+        add_dim(zdim, make_coord(all, gd.kmax, zcoord));
+        add_dim(xdim, make_coord(all, gd.itot, xcoord));
+    }
+    else if (plane == Cross_plane::yz)
+    {
+        add_dim(xdim, make_coord(indices, 0, xcoord));
+        add_dim(zdim, make_coord(all, gd.kmax, zcoord));
+        add_dim(ydim, make_coord(all, gd.jtot, ycoord));
+    }
+    else
+    {
+        if (!indices.empty())
+            add_dim(zdim, make_coord(indices, 0, zcoord));
+        add_dim(ydim, make_coord(all, gd.jtot, ycoord));
+        add_dim(xdim, make_coord(all, gd.itot, xcoord));
+    }
+
+    cf.data_file->add_dimension("time");
+
+    for (auto& c : coords)
+    {
+        Netcdf_variable<TF> coord_var = cf.data_file->template add_variable<TF>(c.first, {c.first});
+        coord_var.insert(c.second, {0});
+    }
+
+    // Chunk the data by one slice and as many records as fit in about 4 MiB, instead of
+    // the default of one record of all slices per chunk.
+    const int ndims = dims.size();
+    std::vector<int> chunks(ndims, 1);
+    for (int i=ndims-2; i<ndims; ++i)
+        chunks[i] = coords[i-1].second.size();
+
+    const long plane_size = static_cast<long>(chunks[ndims-2])*chunks[ndims-1]*sizeof(TF);
+    chunks[0] = std::max(1L, std::min(64L, (4L << 20) / plane_size));
+
+    cf.iotime_var = std::make_unique<Netcdf_variable<int>>(
+            cf.data_file->template add_variable<int>("iotime", {"time"}, {1024}));
+    cf.data_var = std::make_unique<Netcdf_variable<TF>>(
+            cf.data_file->template add_variable<TF>(name, dims, chunks));
+
+    return cross_files.emplace(key, std::move(cf)).first->second;
+}
+
+/**
+ * Appends all slices of a variable in one plane to its NetCDF file. An empty list of
+ * indices stores the single 2D plane that data points to. All processes take part.
+ */
+template<typename TF>
+int Cross<TF>::save_slices_nc(
+        TF* restrict data, TF* restrict tmp, const std::string& name, const int iotime,
+        Cross_plane plane, const std::vector<int>& indices, const std::array<int,3>& loc)
+{
+    auto& gd = grid.get_grid_data();
+    auto& md = master.get_MPI_data();
+
+    Cross_file<TF>& cf = get_cross_file(name, plane, indices, loc, iotime);
+
+    if (iotime != cf.last_iotime)
+    {
+        ++cf.record;
+        cf.last_iotime = iotime;
+        cf.iotime_var->insert(iotime, {cf.record});
+    }
+
+    std::vector<TF> slice;
+
+    if (indices.empty())
+    {
+        extract_xy(tmp, data, gd.imax, gd.jmax, gd.igc, gd.jgc, gd.icells);
+        gather_slice(slice, tmp, Cross_plane::xy, 0);
+        cf.data_var->insert(slice, {cf.record, 0, 0}, {1, gd.jtot, gd.itot});
+    }
+    else
+    {
+        for (int n=0; n<cf.nslices; ++n)
+        {
+            const int idx = indices[n];
+
+            if (plane == Cross_plane::xz)
+            {
+                if (md.mpicoordy == idx/gd.jmax)
+                    extract_xz(tmp, data, idx%gd.jmax + gd.jgc,
+                            gd.imax, gd.kmax, gd.igc, gd.kgc, gd.icells, gd.ijcells);
+                gather_slice(slice, tmp, plane, idx);
+                cf.data_var->insert(slice, {cf.record, n, 0, 0}, {1, 1, gd.kmax, gd.itot});
+            }
+            else if (plane == Cross_plane::yz)
+            {
+                if (md.mpicoordx == idx/gd.imax)
+                    extract_yz(tmp, data, idx%gd.imax + gd.igc,
+                            gd.jmax, gd.kmax, gd.jgc, gd.kgc, gd.icells, gd.ijcells);
+                gather_slice(slice, tmp, plane, idx);
+                cf.data_var->insert(slice, {cf.record, n, 0, 0}, {1, 1, gd.kmax, gd.jtot});
+            }
+            else
+            {
+                extract_xy(tmp, &data[(idx+gd.kgc)*gd.ijcells],
+                        gd.imax, gd.jmax, gd.igc, gd.jgc, gd.icells);
+                gather_slice(slice, tmp, plane, idx);
+                cf.data_var->insert(slice, {cf.record, n, 0, 0}, {1, 1, gd.jtot, gd.itot});
+            }
+        }
+    }
+
+    // Flush the record, such that the file is complete and readable if the run is killed.
+    cf.data_file->sync();
+
+    // NetCDF errors throw, so reaching this point means the slices are stored.
+    master.print_message("Saving \"%s\" at iotime %07d ... OK\n", cf.filename.c_str(), iotime);
+
+    return 0;
+}
+
 template<typename TF>
 int Cross<TF>::cross_simple(
         TF* restrict data, const std::string& name, const int iotime, const std::array<int,3>& loc)
@@ -523,6 +827,23 @@ int Cross<TF>::cross_simple(
     auto tmpfld = fields.get_tmp();
     auto tmp = tmpfld->fld.data();
 
+    if (swformat == Cross_format::Netcdf)
+    {
+        const std::vector<int>& jlist = (loc == gd.vloc) ? jxzh : jxz;
+        const std::vector<int>& ilist = (loc == gd.uloc) ? ixzh : ixz;
+        const std::vector<int>& klist = (loc == gd.wloc) ? kxyh : kxy;
+
+        if (!jlist.empty())
+            nerror += save_slices_nc(data, tmp, name, iotime, Cross_plane::xz, jlist, loc);
+        if (!ilist.empty())
+            nerror += save_slices_nc(data, tmp, name, iotime, Cross_plane::yz, ilist, loc);
+        if (!klist.empty())
+            nerror += save_slices_nc(data, tmp, name, iotime, Cross_plane::xy, klist, loc);
+
+        fields.release_tmp(tmpfld);
+        return nerror;
+    }
+
     // Loop over the index arrays to save all xz cross sections.
     if (loc == gd.vloc)
     {
@@ -590,6 +911,14 @@ int Cross<TF>::cross_plane(TF* restrict data, std::string name, int iotime)
     auto tmpfld = fields.get_tmp();
     auto tmp = tmpfld->fld.data();
 
+    if (swformat == Cross_format::Netcdf)
+    {
+        auto& gd = grid.get_grid_data();
+        nerror += save_slices_nc(data, tmp, name, iotime, Cross_plane::xy, std::vector<int>(), gd.sloc);
+        fields.release_tmp(tmpfld);
+        return nerror;
+    }
+
     std::sprintf(filename, "%s.%s.%07d", name.c_str(), "xy", iotime);
     nerror += check_save(field3d_io.save_xy_slice(data, tmp, filename), filename);
     fields.release_tmp(tmpfld);
@@ -618,6 +947,20 @@ int Cross<TF>::cross_lngrad(TF* restrict a, std::string name, int iotime)
                 a, lngrad, gd.dxi, gd.dyi, gd.dzi4.data(),
                 gd.icells, gd.ijcells, gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend);
 
+    if (swformat == Cross_format::Netcdf)
+    {
+        if (!jxz.empty())
+            nerror += save_slices_nc(lngrad, tmp, name, iotime, Cross_plane::xz, jxz, gd.sloc);
+        if (!ixz.empty())
+            nerror += save_slices_nc(lngrad, tmp, name, iotime, Cross_plane::yz, ixz, gd.sloc);
+        if (!kxy.empty())
+            nerror += save_slices_nc(lngrad, tmp, name, iotime, Cross_plane::xy, kxy, gd.sloc);
+
+        fields.release_tmp(tmpfld);
+        fields.release_tmp(lngradfld);
+        return nerror;
+    }
+
     // loop over the index arrays to save all xz cross sections
     for (auto& it: jxz)
     {
@@ -677,15 +1020,14 @@ int Cross<TF>::cross_height_threshold(TF* restrict data, TF threshold, Cross_dir
 
     auto& gd = grid.get_grid_data();
     int nerror = 0;
-    auto tmpfld = fields.get_tmp();
-    auto height = tmpfld->fld.data();
+    auto height_tmp = fields.get_tmp_xy();
+    auto height = height_tmp.data();
 
     TF fillvalue = -1e-9; //TODO: SET FILL VALUE
     bool isupward = (direction == Cross_direction::Bottom_to_top);
     calc_cross_height_threshold<TF>(data, height, gd.z.data(), threshold, isupward, fillvalue, gd.icells, gd.ijcells, gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend);
 
     nerror += cross_plane(height, name, iotime);
-    fields.release_tmp(tmpfld);
     return nerror;
 }
 
@@ -44,6 +44,7 @@ namespace
         const double dxidxi = 1/(dx*dx);
         const double dyidyi = 1/(dy*dy);
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -69,6 +70,7 @@ namespace
         const double dxidxi = 1/(dx*dx);
         const double dyidyi = 1/(dy*dy);
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
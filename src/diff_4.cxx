@@ -72,6 +72,7 @@ namespace
                                 * dzi4[kstart];
             }
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend-1; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -139,6 +140,7 @@ namespace
                                 * dzhi4[kstart+1];
             }
 
+        #pragma omp parallel for
         for (int k=kstart+2; k<kend-1; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
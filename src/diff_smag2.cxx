@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #include "grid.h"
 #include "fields.h"
@@ -36,6 +37,7 @@
 #include "fast_math.h"
 
 #include "diff_smag2.h"
+#include "tile.h"
 
 namespace
 {
@@ -106,6 +108,7 @@ namespace
                 }
         }
 
+        #pragma omp parallel for
         for (int k=kstart+k_offset; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -164,6 +167,7 @@ namespace
 
         if (surface_model == Surface_model::Disabled)
         {
+            #pragma omp parallel for
             for (int k=kstart; k<kend; ++k)
             {
                 // const TF mlen_wall = Constants::kappa<TF>*std::min(z[k], zsize-z[k]);
@@ -206,6 +210,7 @@ namespace
         }
         else
         {
+            #pragma omp parallel for
             for (int k=kstart; k<kend; ++k)
             {
                 // Calculate smagorinsky constant times filter width squared, use wall damping according to Mason's paper.
@@ -243,6 +248,7 @@ namespace
 
         if (surface_model == Surface_model::Disabled)
         {
+            #pragma omp parallel for
             for (int k=kstart; k<kend; ++k)
             {
                 // calculate smagorinsky constant times filter width squared, do not use wall damping with resolved walls.
@@ -301,6 +307,7 @@ namespace
                 }
             }
 
+            #pragma omp parallel for
             for (int k=kstart+1; k<kend; ++k)
             {
                 // calculate smagorinsky constant times filter width squared, use wall damping according to Mason
@@ -333,13 +340,14 @@ namespace
                 const TF* restrict rhoref, const TF* restrict rhorefh,
                 const TF visc,
                 const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
+                const int k0, const int k1,
                 const int jj, const int kk)
     {
         constexpr int k_offset = (surface_model == Surface_model::Disabled) ? 0 : 1;
 
         const int ii = 1;
 
-        if (surface_model == Surface_model::Enabled)
+        if (surface_model == Surface_model::Enabled && k0 == kstart)
         {
             // bottom boundary
             for (int j=jstart; j<jend; ++j)
@@ -365,7 +373,10 @@ namespace
                              + ( rhorefh[kstart+1] * evisct*((u[ijk+kk]-u[ijk   ])* dzhi[kstart+1] + (w[ijk+kk]-w[ijk-ii+kk])*dxi)
                                + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
                 }
+        }
 
+        if (surface_model == Surface_model::Enabled && k1 == kend)
+        {
             // top boundary
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -392,7 +403,8 @@ namespace
                 }
         }
 
-        for (int k=kstart+k_offset; k<kend-k_offset; ++k)
+        #pragma omp parallel for
+        for (int k=std::max(k0, kstart+k_offset); k<std::min(k1, kend-k_offset); ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
                 for (int i=istart; i<iend; ++i)
@@ -426,6 +438,7 @@ namespace
                 TF* restrict rhoref, TF* restrict rhorefh,
                 const TF visc,
                 const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
+                const int k0, const int k1,
                 const int jj, const int kk)
 
     {
@@ -433,7 +446,7 @@ namespace
 
         const int ii = 1;
 
-        if (surface_model == Surface_model::Enabled)
+        if (surface_model == Surface_model::Enabled && k0 == kstart)
         {
             // bottom boundary
             for (int j=jstart; j<jend; ++j)
@@ -459,7 +472,10 @@ namespace
                              + ( rhorefh[kstart+1] * evisct*((v[ijk+kk]-v[ijk   ])*dzhi[kstart+1] + (w[ijk+kk]-w[ijk-jj+kk])*dyi)
                                + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
                 }
+        }
 
+        if (surface_model == Surface_model::Enabled && k1 == kend)
+        {
             // top boundary
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -486,7 +502,8 @@ namespace
                 }
         }
 
-        for (int k=kstart+k_offset; k<kend-k_offset; ++k)
+        #pragma omp parallel for
+        for (int k=std::max(k0, kstart+k_offset); k<std::min(k1, kend-k_offset); ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
                 for (int i=istart; i<iend; ++i)
@@ -519,11 +536,13 @@ namespace
                 const TF* restrict rhoref, const TF* restrict rhorefh,
                 const TF visc,
                 const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
+                const int k0, const int k1,
                 const int jj, const int kk)
     {
         const int ii = 1;
 
-        for (int k=kstart+1; k<kend; ++k)
+        #pragma omp parallel for
+        for (int k=std::max(k0, kstart+1); k<std::min(k1, kend); ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
                 for (int i=istart; i<iend; ++i)
@@ -556,13 +575,14 @@ namespace
                 const TF* restrict rhoref, const TF* restrict rhorefh,
                 const TF tPr, const TF visc,
                 const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
+                const int k0, const int k1,
                 const int jj, const int kk)
     {
         constexpr int k_offset = (surface_model == Surface_model::Disabled) ? 0 : 1;
 
         const int ii = 1;
 
-        if (surface_model == Surface_model::Enabled)
+        if (surface_model == Surface_model::Enabled && k0 == kstart)
         {
             // bottom boundary
             for (int j=jstart; j<jend; ++j)
@@ -585,7 +605,10 @@ namespace
                              + ( rhorefh[kstart+1] * evisct*(a[ijk+kk]-a[ijk   ])*dzhi[kstart+1]
                                + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
                 }
+        }
 
+        if (surface_model == Surface_model::Enabled && k1 == kend)
+        {
             // top boundary
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -609,7 +632,8 @@ namespace
                 }
         }
 
-        for (int k=kstart+k_offset; k<kend-k_offset; ++k)
+        #pragma omp parallel for
+        for (int k=std::max(k0, kstart+k_offset); k<std::min(k1, kend-k_offset); ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
                 for (int i=istart; i<iend; ++i)
@@ -632,6 +656,204 @@ namespace
                 }
     }
 
+    // Batched version of diff_c for ns scalars. The face viscosities of each row are computed
+    // once and shared by all scalars in the batch, such that evisc is read once per sweep.
+    template <typename TF, Surface_model surface_model>
+    void diff_c_batch(TF* const* const at, const TF* const* const a,
+                      const TF* const* const fluxbot, const TF* const* const fluxtop,
+                      const TF* const visc, const int ns,
+                      const TF* restrict dzi, const TF* restrict dzhi, const TF dxidxi, const TF dyidyi,
+                      const TF* restrict evisc,
+                      const TF* restrict rhoref, const TF* restrict rhorefh,
+                      const TF tPr,
+                      const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
+                      const int jj, const int kk)
+    {
+        const int ii = 1;
+        const int nrow = iend-istart;
+
+        #pragma omp parallel
+        {
+            std::vector<TF> evisce_row(nrow);
+            std::vector<TF> eviscw_row(nrow);
+            std::vector<TF> eviscn_row(nrow);
+            std::vector<TF> eviscs_row(nrow);
+            std::vector<TF> evisct_row(nrow);
+            std::vector<TF> eviscb_row(nrow);
+
+            TF* const restrict evisce = evisce_row.data() - istart;
+            TF* const restrict eviscw = eviscw_row.data() - istart;
+            TF* const restrict eviscn = eviscn_row.data() - istart;
+            TF* const restrict eviscs = eviscs_row.data() - istart;
+            TF* const restrict evisct = evisct_row.data() - istart;
+            TF* const restrict eviscb = eviscb_row.data() - istart;
+
+            #pragma omp for
+            for (int k=kstart; k<kend; ++k)
+            {
+                const bool is_bot = (surface_model == Surface_model::Enabled) && (k == kstart);
+                const bool is_top = (surface_model == Surface_model::Enabled) && (k == kend-1);
+
+                for (int j=jstart; j<jend; ++j)
+                {
+                    // The molecular viscosity differs per scalar and is added in the scalar loop.
+                    #pragma ivdep
+                    for (int i=istart; i<iend; ++i)
+                    {
+                        const int ijk = i + j*jj + k*kk;
+                        evisce[i] = TF(0.5)*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
+                        eviscw[i] = TF(0.5)*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
+                        eviscn[i] = TF(0.5)*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
+                        eviscs[i] = TF(0.5)*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
+                        evisct[i] = TF(0.5)*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
+                        eviscb[i] = TF(0.5)*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
+                    }
+
+                    for (int n=0; n<ns; ++n)
+                    {
+                        TF* const restrict atn = at[n];
+                        const TF* const restrict an = a[n];
+                        const TF viscn = visc[n];
+
+                        if (is_bot)
+                        {
+                            const TF* const restrict fluxbotn = fluxbot[n];
+
+                            #pragma ivdep
+                            for (int i=istart; i<iend; ++i)
+                            {
+                                const int ij  = i + j*jj;
+                                const int ijk = i + j*jj + k*kk;
+                                atn[ijk] +=
+                                         + ( (evisce[i]+viscn)*(an[ijk+ii]-an[ijk   ])
+                                           - (eviscw[i]+viscn)*(an[ijk   ]-an[ijk-ii]) ) * dxidxi
+                                         + ( (eviscn[i]+viscn)*(an[ijk+jj]-an[ijk   ])
+                                           - (eviscs[i]+viscn)*(an[ijk   ]-an[ijk-jj]) ) * dyidyi
+                                         + ( rhorefh[k+1] * (evisct[i]+viscn)*(an[ijk+kk]-an[ijk   ])*dzhi[k+1]
+                                           + rhorefh[k  ] * fluxbotn[ij] ) / rhoref[k] * dzi[k];
+                            }
+                        }
+                        else if (is_top)
+                        {
+                            const TF* const restrict fluxtopn = fluxtop[n];
+
+                            #pragma ivdep
+                            for (int i=istart; i<iend; ++i)
+                            {
+                                const int ij  = i + j*jj;
+                                const int ijk = i + j*jj + k*kk;
+                                atn[ijk] +=
+                                         + ( (evisce[i]+viscn)*(an[ijk+ii]-an[ijk   ])
+                                           - (eviscw[i]+viscn)*(an[ijk   ]-an[ijk-ii]) ) * dxidxi
+                                         + ( (eviscn[i]+viscn)*(an[ijk+jj]-an[ijk   ])
+                                           - (eviscs[i]+viscn)*(an[ijk   ]-an[ijk-jj]) ) * dyidyi
+                                         + (-rhorefh[k+1] * fluxtopn[ij]
+                                           - rhorefh[k  ] * (eviscb[i]+viscn)*(an[ijk   ]-an[ijk-kk])*dzhi[k] ) / rhoref[k] * dzi[k];
+                            }
+                        }
+                        else
+                        {
+                            #pragma ivdep
+                            for (int i=istart; i<iend; ++i)
+                            {
+                                const int ijk = i + j*jj + k*kk;
+                                atn[ijk] +=
+                                         + ( (evisce[i]+viscn)*(an[ijk+ii]-an[ijk   ])
+                                           - (eviscw[i]+viscn)*(an[ijk   ]-an[ijk-ii]) ) * dxidxi
+                                         + ( (eviscn[i]+viscn)*(an[ijk+jj]-an[ijk   ])
+                                           - (eviscs[i]+viscn)*(an[ijk   ]-an[ijk-jj]) ) * dyidyi
+                                         + ( rhorefh[k+1] * (evisct[i]+viscn)*(an[ijk+kk]-an[ijk   ])*dzhi[k+1]
+                                           - rhorefh[k  ] * (eviscb[i]+viscn)*(an[ijk   ]-an[ijk-kk])*dzhi[k]  ) / rhoref[k] * dzi[k];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Diffuse all scalars with diff_c_batch, in batches of nbatch scalars.
+    template <typename TF, Surface_model surface_model>
+    void diff_scalars_batched(Fields<TF>& fields, const Grid_data<TF>& gd, const TF tPr, const int nbatch)
+    {
+        std::vector<TF*> at;
+        std::vector<const TF*> a;
+        std::vector<const TF*> fluxbot;
+        std::vector<const TF*> fluxtop;
+        std::vector<TF> visc;
+
+        for (auto& it : fields.st)
+        {
+            at.push_back(it.second->fld.data());
+            a.push_back(fields.sp.at(it.first)->fld.data());
+            fluxbot.push_back(fields.sp.at(it.first)->flux_bot.data());
+            fluxtop.push_back(fields.sp.at(it.first)->flux_top.data());
+            visc.push_back(fields.sp.at(it.first)->visc);
+        }
+
+        const int nscalars = at.size();
+        for (int n=0; n<nscalars; n+=nbatch)
+            diff_c_batch<TF, surface_model>(
+                    &at[n], &a[n], &fluxbot[n], &fluxtop[n], &visc[n], std::min(nbatch, nscalars-n),
+                    gd.dzi.data(), gd.dzhi.data(), 1./(gd.dx*gd.dx), 1./(gd.dy*gd.dy),
+                    fields.sd.at("evisc")->fld.data(),
+                    fields.rhoref.data(), fields.rhorefh.data(), tPr,
+                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                    gd.icells, gd.ijcells);
+    }
+
+    // Diffuse momentum and all scalars on the levels and rows of one tile.
+    template <typename TF, Surface_model surface_model>
+    void diff_tile(Fields<TF>& fields, const Grid_data<TF>& gd, const TF tPr, const Tile& tile)
+    {
+        diff_u<TF, surface_model>(
+                fields.mt.at("u")->fld.data(),
+                fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
+                gd.dzi.data(), gd.dzhi.data(), 1./gd.dx, 1./gd.dy,
+                fields.sd.at("evisc")->fld.data(),
+                fields.mp.at("u")->flux_bot.data(), fields.mp.at("u")->flux_top.data(),
+                fields.rhoref.data(), fields.rhorefh.data(),
+                fields.visc,
+                gd.istart, gd.iend, tile.jstart, tile.jend, gd.kstart, gd.kend,
+                tile.kstart, tile.kend,
+                gd.icells, gd.ijcells);
+
+        diff_v<TF, surface_model>(
+                fields.mt.at("v")->fld.data(),
+                fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
+                gd.dzi.data(), gd.dzhi.data(), 1./gd.dx, 1./gd.dy,
+                fields.sd.at("evisc")->fld.data(),
+                fields.mp.at("v")->flux_bot.data(), fields.mp.at("v")->flux_top.data(),
+                fields.rhoref.data(), fields.rhorefh.data(),
+                fields.visc,
+                gd.istart, gd.iend, tile.jstart, tile.jend, gd.kstart, gd.kend,
+                tile.kstart, tile.kend,
+                gd.icells, gd.ijcells);
+
+        diff_w<TF>(
+                fields.mt.at("w")->fld.data(),
+                fields.mp.at("u")->fld.data(), fields.mp.at("v")->fld.data(), fields.mp.at("w")->fld.data(),
+                gd.dzi.data(), gd.dzhi.data(), 1./gd.dx, 1./gd.dy,
+                fields.sd.at("evisc")->fld.data(),
+                fields.rhoref.data(), fields.rhorefh.data(),
+                fields.visc,
+                gd.istart, gd.iend, tile.jstart, tile.jend, gd.kstart, gd.kend,
+                tile.kstart, tile.kend,
+                gd.icells, gd.ijcells);
+
+        for (auto it : fields.st)
+            diff_c<TF, surface_model>(
+                    it.second->fld.data(), fields.sp.at(it.first)->fld.data(),
+                    gd.dzi.data(), gd.dzhi.data(), 1./(gd.dx*gd.dx), 1./(gd.dy*gd.dy),
+                    fields.sd.at("evisc")->fld.data(),
+                    fields.sp.at(it.first)->flux_bot.data(), fields.sp.at(it.first)->flux_top.data(),
+                    fields.rhoref.data(), fields.rhorefh.data(), tPr,
+                    fields.sp.at(it.first)->visc,
+                    gd.istart, gd.iend, tile.jstart, tile.jend, gd.kstart, gd.kend,
+                    tile.kstart, tile.kend,
+                    gd.icells, gd.ijcells);
+    }
+
     template<typename TF>
     TF calc_dnmul(TF* restrict evisc, const TF* restrict dzi, const TF dxidxi, const TF dyidyi, const TF tPr,
                   const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
@@ -641,6 +863,7 @@ namespace
         TF dnmul = 0;
 
         // get the maximum time step for diffusion
+        #pragma omp parallel for reduction(max:dnmul)
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -756,6 +979,9 @@ Diff_smag2<TF>::Diff_smag2(Master& masterin, Grid<TF>& gridin, Fields<TF>& field
     cs    = inputin.get_item<TF>("diff", "cs"   , "", 0.23 );
     tPr   = inputin.get_item<TF>("diff", "tPr"  , "", 1./3.);
 
+    // Number of scalars that are diffused in one sweep over the eddy viscosity.
+    nbatch = inputin.get_item<int>("diff", "nbatch", "", 8);
+
     fields.init_diagnostic_field("evisc", "Eddy viscosity", "m2 s-1", gd.sloc);
 
     if (grid.get_spatial_order() != Grid_order::Second)
@@ -845,6 +1071,7 @@ void Diff_smag2<TF>::exec(Stats<TF>& stats)
                 fields.rhoref.data(), fields.rhorefh.data(),
                 fields.visc,
                 gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                gd.kstart, gd.kend,
                 gd.icells, gd.ijcells);
 
         diff_v<TF, Surface_model::Enabled>(
@@ -856,6 +1083,7 @@ void Diff_smag2<TF>::exec(Stats<TF>& stats)
                 fields.rhoref.data(), fields.rhorefh.data(),
                 fields.visc,
                 gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                gd.kstart, gd.kend,
                 gd.icells, gd.ijcells);
 
         diff_w<TF>(
@@ -866,19 +1094,26 @@ void Diff_smag2<TF>::exec(Stats<TF>& stats)
                 fields.rhoref.data(), fields.rhorefh.data(),
                 fields.visc,
                 gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                gd.kstart, gd.kend,
                 gd.icells, gd.ijcells);
 
-        for (auto it : fields.st)
+        if (nbatch > 1 && fields.st.size() > 1)
+            diff_scalars_batched<TF, Surface_model::Enabled>(fields, gd, tPr, nbatch);
+        else
         {
-            diff_c<TF, Surface_model::Enabled>(
-                    it.second->fld.data(), fields.sp.at(it.first)->fld.data(),
-                    gd.dzi.data(), gd.dzhi.data(), 1./(gd.dx*gd.dx), 1./(gd.dy*gd.dy),
-                    fields.sd.at("evisc")->fld.data(),
-                    fields.sp.at(it.first)->flux_bot.data(), fields.sp.at(it.first)->flux_top.data(),
-                    fields.rhoref.data(), fields.rhorefh.data(), tPr,
-                    fields.sp.at(it.first)->visc,
-                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
-                    gd.icells, gd.ijcells);
+            for (auto it : fields.st)
+            {
+                diff_c<TF, Surface_model::Enabled>(
+                        it.second->fld.data(), fields.sp.at(it.first)->fld.data(),
+                        gd.dzi.data(), gd.dzhi.data(), 1./(gd.dx*gd.dx), 1./(gd.dy*gd.dy),
+                        fields.sd.at("evisc")->fld.data(),
+                        fields.sp.at(it.first)->flux_bot.data(), fields.sp.at(it.first)->flux_top.data(),
+                        fields.rhoref.data(), fields.rhorefh.data(), tPr,
+                        fields.sp.at(it.first)->visc,
+                        gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                        gd.kstart, gd.kend,
+                        gd.icells, gd.ijcells);
+            }
         }
     }
     else
@@ -892,6 +1127,7 @@ void Diff_smag2<TF>::exec(Stats<TF>& stats)
                 fields.rhoref.data(), fields.rhorefh.data(),
                 fields.visc,
                 gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                gd.kstart, gd.kend,
                 gd.icells, gd.ijcells);
 
         diff_v<TF, Surface_model::Disabled>(
@@ -903,6 +1139,7 @@ void Diff_smag2<TF>::exec(Stats<TF>& stats)
                 fields.rhoref.data(), fields.rhorefh.data(),
                 fields.visc,
                 gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                gd.kstart, gd.kend,
                 gd.icells, gd.ijcells);
 
         diff_w<TF>(
@@ -913,19 +1150,26 @@ void Diff_smag2<TF>::exec(Stats<TF>& stats)
                 fields.rhoref.data(), fields.rhorefh.data(),
                 fields.visc,
                 gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                gd.kstart, gd.kend,
                 gd.icells, gd.ijcells);
 
-        for (auto it : fields.st)
+        if (nbatch > 1 && fields.st.size() > 1)
+            diff_scalars_batched<TF, Surface_model::Disabled>(fields, gd, tPr, nbatch);
+        else
         {
-            diff_c<TF, Surface_model::Disabled>(
-                    it.second->fld.data(), fields.sp.at(it.first)->fld.data(),
-                    gd.dzi.data(), gd.dzhi.data(), 1./(gd.dx*gd.dx), 1./(gd.dy*gd.dy),
-                    fields.sd.at("evisc")->fld.data(),
-                    fields.sp.at(it.first)->flux_bot.data(), fields.sp.at(it.first)->flux_top.data(),
-                    fields.rhoref.data(), fields.rhorefh.data(), tPr,
-                    fields.sp.at(it.first)->visc,
-                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
-                    gd.icells, gd.ijcells);
+            for (auto it : fields.st)
+            {
+                diff_c<TF, Surface_model::Disabled>(
+                        it.second->fld.data(), fields.sp.at(it.first)->fld.data(),
+                        gd.dzi.data(), gd.dzhi.data(), 1./(gd.dx*gd.dx), 1./(gd.dy*gd.dy),
+                        fields.sd.at("evisc")->fld.data(),
+                        fields.sp.at(it.first)->flux_bot.data(), fields.sp.at(it.first)->flux_top.data(),
+                        fields.rhoref.data(), fields.rhorefh.data(), tPr,
+                        fields.sp.at(it.first)->visc,
+                        gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                        gd.kstart, gd.kend,
+                        gd.icells, gd.ijcells);
+            }
         }
     }
 
@@ -936,6 +1180,17 @@ void Diff_smag2<TF>::exec(Stats<TF>& stats)
         stats.calc_tend(*it.second, tend_name);
 }
 
+template<typename TF>
+void Diff_smag2<TF>::exec_tile(const Tile& tile)
+{
+    auto& gd = grid.get_grid_data();
+
+    if (boundary.get_switch() == "surface" || boundary.get_switch() == "surface_bulk")
+        diff_tile<TF, Surface_model::Enabled>(fields, gd, tPr, tile);
+    else
+        diff_tile<TF, Surface_model::Disabled>(fields, gd, tPr, tile);
+}
+
 template<typename TF>
 void Diff_smag2<TF>::exec_viscosity(Thermo<TF>& thermo)
 {
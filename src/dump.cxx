@@ -38,9 +38,25 @@ Dump<TF>::Dump(Master& masterin, Grid<TF>& gridin, Fields<TF>& fieldsin, Input&
     field3d_io(master, grid)
 {
     swdump = inputin.get_item<bool>("dump", "swdump", "", false);
+    swasync = false;
+    staged_iotime = -1;
 
     if (swdump)
     {
+        swasync = inputin.get_item<bool>("dump", "swasync", "", false);
+
+        std::string swcompress = inputin.get_item<std::string>("dump", "swcompress", "", "none");
+        if (swcompress == "lossless")
+            field3d_io.set_compression(Field3d_compression::Lossless);
+        else if (swcompress == "lossy")
+            field3d_io.set_compression(
+                    Field3d_compression::Lossy, inputin.get_item<TF>("dump", "tolerance", "", 0.));
+        else if (swcompress != "none")
+        {
+            std::string msg = swcompress + " is an illegal value for swcompress";
+            throw std::runtime_error(msg);
+        }
+
        // Get the time at which the dump sections are triggered.
         sampletime = inputin.get_item<double>("dump", "sampletime", "");
 
@@ -118,6 +134,16 @@ void Dump<TF>::save_dump(TF* data, std::string varname, int iotime)
     const double no_offset = 0.;
     char filename[256];
 
+    // Make sure that the dumps of the previous dump time are written before the first dump of a new time
+    // is staged, such that the background thread holds the dumps of at most one time in memory.
+    if (swasync && iotime != staged_iotime)
+    {
+        if (field3d_io.wait_staged())
+            throw std::runtime_error("In Dump");
+
+        staged_iotime = iotime;
+    }
+
     std::sprintf(filename, "%s.%07d", varname.c_str(), iotime);
     std::ifstream infile(filename);
     if(infile.good())
@@ -131,9 +157,21 @@ void Dump<TF>::save_dump(TF* data, std::string varname, int iotime)
         auto tmpfld1 = fields.get_tmp();
         auto tmpfld2 = fields.get_tmp();
         auto tmp1 = tmpfld1.get();
-        auto tmp2 = tmpfld1.get();
+        auto tmp2 = tmpfld2.get();
 
-        if (field3d_io.save_field3d(data, tmp1->fld.data(), tmp2->fld.data(), filename, no_offset))
+        if (swasync)
+        {
+            if (field3d_io.stage_field3d(data, tmp1->fld.data(), tmp2->fld.data(), filename, no_offset))
+            {
+                master.print_message("FAILED\n");
+                throw std::runtime_error("In Dump");
+            }
+            else
+            {
+                master.print_message("STAGED\n");
+            }
+        }
+        else if (field3d_io.save_field3d(data, tmp1->fld.data(), tmp2->fld.data(), filename, no_offset))
         {
             master.print_message("FAILED\n");
             throw std::runtime_error("In Dump");
@@ -147,6 +185,16 @@ void Dump<TF>::save_dump(TF* data, std::string varname, int iotime)
     }
 }
 
+template<typename TF>
+void Dump<TF>::wait_save()
+{
+    if (!swasync)
+        return;
+
+    if (field3d_io.wait_staged())
+        throw std::runtime_error("In Dump");
+}
+
 
 template class Dump<double>;
 template class Dump<float>;
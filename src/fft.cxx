@@ -20,17 +20,34 @@
  * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <stdexcept>
 #include "master.h"
 #include "grid.h"
+#include "input.h"
 #include "fft.h"
 
 template<typename TF>
-FFT<TF>::FFT(Master& masterin, Grid<TF>& gridin) :
+FFT<TF>::FFT(Master& masterin, Grid<TF>& gridin, Input& inputin) :
     master(masterin), grid(gridin),
     transpose(master, grid)
 {
     has_fftw_plan = false;
 
+    std::string swtranspose = inputin.get_item<std::string>("fft", "swtranspose", "", "blocking");
+    if (swtranspose == "blocking")
+        transpose_mode = Transpose_mode::Blocking;
+    else if (swtranspose == "pipelined")
+        transpose_mode = Transpose_mode::Pipelined;
+    else if (swtranspose == "alltoall")
+        transpose_mode = Transpose_mode::Alltoall;
+    else
+        throw std::runtime_error("Illegal value for swtranspose");
+
+    nchunks = inputin.get_item<int>("fft", "nchunks", "", 4);
+    if (nchunks < 1)
+        throw std::runtime_error("nchunks should be at least 1");
+
     // Initialize the pointers to zero.
     fftini  = nullptr;
     fftouti = nullptr;
@@ -43,12 +60,15 @@ void FFT<double>::init()
 {
     auto& gd = grid.get_grid_data();
 
+    nchunks = std::min(nchunks, gd.kblock);
+
     fftini  = fftw_alloc_real(gd.itot*gd.jmax);
     fftouti = fftw_alloc_real(gd.itot*gd.jmax);
     fftinj  = fftw_alloc_real(gd.jtot*gd.iblock);
     fftoutj = fftw_alloc_real(gd.jtot*gd.iblock);
 
     transpose.init();
+    transpose.set_mode(transpose_mode);
 }
 
 template<>
@@ -56,12 +76,15 @@ void FFT<float>::init()
 {
     auto& gd = grid.get_grid_data();
 
+    nchunks = std::min(nchunks, gd.kblock);
+
     fftini  = fftwf_alloc_real(gd.itot*gd.jmax);
     fftouti = fftwf_alloc_real(gd.itot*gd.jmax);
     fftinj  = fftwf_alloc_real(gd.jtot*gd.iblock);
     fftoutj = fftwf_alloc_real(gd.jtot*gd.iblock);
 
     transpose.init();
+    transpose.set_mode(transpose_mode);
 }
 
 template<>
@@ -561,12 +584,151 @@ namespace
         // And transpose back...
         transpose.exec_xz(tmp1, data);
     }
+
+    // Fourier transform in x of the slices kstart to kend of a field in x-orientation.
+    template<typename TF>
+    void fft_x_slices(TF* const out, const TF* const in,
+                      TF* const restrict fftini, TF* const restrict fftouti,
+                      fftw_plan& iplan, fftwf_plan& iplanf,
+                      const int kstart, const int kend, const bool normalize,
+                      const Grid_data<TF>& gd)
+    {
+        const int kk = gd.itot*gd.jmax;
+
+        for (int k=kstart; k<kend; ++k)
+        {
+            #pragma ivdep
+            for (int n=0; n<gd.itot*gd.jmax; ++n)
+                fftini[n] = in[n + k*kk];
+
+            fftw_execute_wrapper<TF>(iplan, iplanf);
+
+            if (normalize)
+            {
+                #pragma ivdep
+                for (int n=0; n<gd.itot*gd.jmax; ++n)
+                    out[n + k*kk] = fftouti[n] / gd.itot;
+            }
+            else
+            {
+                #pragma ivdep
+                for (int n=0; n<gd.itot*gd.jmax; ++n)
+                    out[n + k*kk] = fftouti[n];
+            }
+        }
+    }
+
+    // Fourier transform in y of the slices kstart to kend of a field in y-orientation.
+    template<typename TF>
+    void fft_y_slices(TF* const out, const TF* const in,
+                      TF* const restrict fftinj, TF* const restrict fftoutj,
+                      fftw_plan& jplan, fftwf_plan& jplanf,
+                      const int kstart, const int kend, const bool normalize,
+                      const Grid_data<TF>& gd)
+    {
+        const int kk = gd.iblock*gd.jtot;
+
+        for (int k=kstart; k<kend; ++k)
+        {
+            #pragma ivdep
+            for (int n=0; n<gd.iblock*gd.jtot; ++n)
+                fftinj[n] = in[n + k*kk];
+
+            fftw_execute_wrapper<TF>(jplan, jplanf);
+
+            if (normalize)
+            {
+                #pragma ivdep
+                for (int n=0; n<gd.iblock*gd.jtot; ++n)
+                    out[n + k*kk] = fftoutj[n] / gd.jtot;
+            }
+            else
+            {
+                #pragma ivdep
+                for (int n=0; n<gd.iblock*gd.jtot; ++n)
+                    out[n + k*kk] = fftoutj[n];
+            }
+        }
+    }
+
+    // The pipelined variants split every transpose into nchunks slabs of levels, such that
+    // the Fourier transforms of one chunk overlap with the communication of the others.
+    template<typename TF>
+    void fft_forward_pipelined(TF* const restrict data,   TF* const restrict tmp1,
+                               TF* const restrict fftini, TF* const restrict fftouti,
+                               TF* const restrict fftinj, TF* const restrict fftoutj,
+                               fftw_plan& iplanf, fftwf_plan& iplanff,
+                               fftw_plan& jplanf, fftwf_plan& jplanff,
+                               const Grid_data<TF>& gd, Transpose<TF>& transpose, const int nchunks)
+    {
+        auto kstart = [&](const int n) { return n*gd.kblock/nchunks; };
+
+        for (int n=0; n<nchunks; ++n)
+            transpose.exec_begin(tmp1, data, Transpose_type::zx, kstart(n), kstart(n+1)-kstart(n), n);
+
+        for (int n=0; n<nchunks; ++n)
+        {
+            transpose.exec_finish(n);
+            fft_x_slices(tmp1, tmp1, fftini, fftouti, iplanf, iplanff, kstart(n), kstart(n+1), false, gd);
+            transpose.exec_begin(data, tmp1, Transpose_type::xy, kstart(n), kstart(n+1)-kstart(n), n);
+        }
+
+        for (int n=0; n<nchunks; ++n)
+        {
+            transpose.exec_finish(n);
+            fft_y_slices(tmp1, data, fftinj, fftoutj, jplanf, jplanff, kstart(n), kstart(n+1), false, gd);
+            transpose.exec_begin(data, tmp1, Transpose_type::yz, kstart(n), kstart(n+1)-kstart(n), n);
+        }
+
+        for (int n=0; n<nchunks; ++n)
+            transpose.exec_finish(n);
+    }
+
+    template<typename TF>
+    void fft_backward_pipelined(TF* const restrict data,   TF* const restrict tmp1,
+                                TF* const restrict fftini, TF* const restrict fftouti,
+                                TF* const restrict fftinj, TF* const restrict fftoutj,
+                                fftw_plan& iplanb, fftwf_plan& iplanbf,
+                                fftw_plan& jplanb, fftwf_plan& jplanbf,
+                                const Grid_data<TF>& gd, Transpose<TF>& transpose, const int nchunks)
+    {
+        auto kstart = [&](const int n) { return n*gd.kblock/nchunks; };
+
+        for (int n=0; n<nchunks; ++n)
+            transpose.exec_begin(tmp1, data, Transpose_type::zy, kstart(n), kstart(n+1)-kstart(n), n);
+
+        for (int n=0; n<nchunks; ++n)
+        {
+            transpose.exec_finish(n);
+            fft_y_slices(data, tmp1, fftinj, fftoutj, jplanb, jplanbf, kstart(n), kstart(n+1), true, gd);
+            transpose.exec_begin(tmp1, data, Transpose_type::yx, kstart(n), kstart(n+1)-kstart(n), n);
+        }
+
+        for (int n=0; n<nchunks; ++n)
+        {
+            transpose.exec_finish(n);
+            fft_x_slices(data, tmp1, fftini, fftouti, iplanb, iplanbf, kstart(n), kstart(n+1), true, gd);
+            transpose.exec_begin(tmp1, data, Transpose_type::xz, kstart(n), kstart(n+1)-kstart(n), n);
+        }
+
+        for (int n=0; n<nchunks; ++n)
+            transpose.exec_finish(n);
+    }
     #endif
 }
 
 template<typename TF>
 void FFT<TF>::exec_forward(TF* const restrict data, TF* const restrict tmp1)
 {
+    #ifdef USEMPI
+    if (transpose_mode == Transpose_mode::Pipelined)
+    {
+        fft_forward_pipelined(data, tmp1, fftini, fftouti, fftinj, fftoutj,
+                iplanf, iplanff, jplanf, jplanff, grid.get_grid_data(), transpose, nchunks);
+        return;
+    }
+    #endif
+
     fft_forward(data, tmp1, fftini, fftouti, fftinj, fftoutj,
             iplanf, iplanff, jplanf, jplanff, grid.get_grid_data(), transpose);
 }
@@ -574,6 +736,15 @@ void FFT<TF>::exec_forward(TF* const restrict data, TF* const restrict tmp1)
 template<typename TF>
 void FFT<TF>::exec_backward(TF* const restrict data, TF* const restrict tmp1)
 {
+    #ifdef USEMPI
+    if (transpose_mode == Transpose_mode::Pipelined)
+    {
+        fft_backward_pipelined(data, tmp1, fftini, fftouti, fftinj, fftoutj,
+                iplanb, iplanbf, jplanb, jplanbf, grid.get_grid_data(), transpose, nchunks);
+        return;
+    }
+    #endif
+
     fft_backward(data, tmp1, fftini, fftouti, fftinj, fftoutj,
             iplanb, iplanbf, jplanb, jplanbf, grid.get_grid_data(), transpose);
 }
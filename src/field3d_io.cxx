@@ -21,8 +21,12 @@
  */
 
 #include <cstdio>
+#include <cstdint>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <zlib.h>
 #include "master.h"
 #include "grid.h"
 #include "field3d.h"
@@ -36,11 +40,36 @@ Field3d_io<TF>::Field3d_io(Master& masterin, Grid<TF>& gridin) :
     transpose(master, grid)
 {
     mpitypes = false;
+
+    compression = Field3d_compression::None;
+    tolerance = 0;
+
+    restart_alignment = 4096;
+
+    #ifdef USEMPI
+    io_info = MPI_INFO_NULL;
+    io_comm = MPI_COMM_NULL;
+    #endif
+
+    io_busy = false;
+    io_stop = false;
+    io_nerror = 0;
 }
 
 template<typename TF>
 Field3d_io<TF>::~Field3d_io()
 {
+    // Let the background thread finish the writes in its queue.
+    if (io_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(io_mutex);
+            io_stop = true;
+        }
+        io_cv.notify_all();
+        io_thread.join();
+    }
+
     exit_mpi();
 }
 
@@ -97,6 +126,14 @@ void Field3d_io<TF>::init_mpi()
     MPI_Type_create_subarray(2, totxysize, subxysize, subxystart, MPI_ORDER_C, mpi_fp_type<TF>(), &subxyslice);
     MPI_Type_commit(&subxyslice);
 
+    // Pass the hints, such as collective buffering and striping, to the opening of the 3d field files.
+    if (!io_hints.empty())
+    {
+        MPI_Info_create(&io_info);
+        for (auto& h : io_hints)
+            MPI_Info_set(io_info, h.first.c_str(), h.second.c_str());
+    }
+
     mpitypes = true;
 }
 
@@ -110,11 +147,21 @@ void Field3d_io<TF>::exit_mpi()
         MPI_Type_free(&subyzslice);
         MPI_Type_free(&subxyslice);
     }
+
+    if (io_info != MPI_INFO_NULL)
+        MPI_Info_free(&io_info);
+
+    // The background thread is joined in the destructor before this is called.
+    if (io_comm != MPI_COMM_NULL)
+        MPI_Comm_free(&io_comm);
 }
 
 template<typename TF>
 int Field3d_io<TF>::save_field3d(TF* restrict data, TF* restrict tmp1, TF* restrict tmp2, const char* filename, TF offset)
 {
+    if (compression != Field3d_compression::None)
+        return save_field3d_compressed(data, tmp1, tmp2, filename, offset);
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -142,14 +189,14 @@ int Field3d_io<TF>::save_field3d(TF* restrict data, TF* restrict tmp1, TF* restr
     transpose.exec_zx(tmp2, tmp1);
 
     MPI_File fh;
-    if (MPI_File_open(md.commxy, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, MPI_INFO_NULL, &fh))
+    if (MPI_File_open(md.commxy, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, io_info, &fh))
         return 1;
 
     // select noncontiguous part of 3d array to store the selected data
     MPI_Offset fileoff = 0; // the offset within the file (header size)
     char name[] = "native";
 
-    if (MPI_File_set_view(fh, fileoff, mpi_fp_type<TF>(), subarray, name, MPI_INFO_NULL))
+    if (MPI_File_set_view(fh, fileoff, mpi_fp_type<TF>(), subarray, name, io_info))
         return 1;
 
     if (MPI_File_write_all(fh, tmp2, count, mpi_fp_type<TF>(), MPI_STATUS_IGNORE))
@@ -164,6 +211,9 @@ int Field3d_io<TF>::save_field3d(TF* restrict data, TF* restrict tmp1, TF* restr
 template<typename TF>
 int Field3d_io<TF>::load_field3d(TF* const restrict data, TF* const restrict tmp1, TF* const restrict tmp2, const char* filename, TF offset)
 {
+    if (is_compressed(filename))
+        return load_field3d_compressed(data, tmp1, tmp2, filename, offset);
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -172,13 +222,13 @@ int Field3d_io<TF>::load_field3d(TF* const restrict data, TF* const restrict tmp
 
     // read the file
     MPI_File fh;
-    if (MPI_File_open(md.commxy, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh))
+    if (MPI_File_open(md.commxy, filename, MPI_MODE_RDONLY, io_info, &fh))
         return 1;
 
     // select noncontiguous part of 3d array to store the selected data
     MPI_Offset fileoff = 0; // the offset within the file (header size)
     char name[] = "native";
-    MPI_File_set_view(fh, fileoff, mpi_fp_type<TF>(), subarray, name, MPI_INFO_NULL);
+    MPI_File_set_view(fh, fileoff, mpi_fp_type<TF>(), subarray, name, io_info);
 
     // extract the data from the 3d field without the ghost cells
     int count = gd.imax*gd.jmax*gd.kmax;
@@ -449,6 +499,9 @@ template<typename TF>
 int Field3d_io<TF>::save_field3d(TF* restrict data, TF* restrict tmp1, TF* restrict tmp2,
         const char* filename, const TF offset)
 {
+    if (compression != Field3d_compression::None)
+        return save_field3d_compressed(data, tmp1, tmp2, filename, offset);
+
     auto& gd = grid.get_grid_data();
 
     FILE *pFile;
@@ -487,6 +540,9 @@ template<typename TF>
 int Field3d_io<TF>::load_field3d(TF* restrict data, TF* restrict tmp1, TF* restrict tmp2,
         const char* filename, const TF offset)
 {
+    if (is_compressed(filename))
+        return load_field3d_compressed(data, tmp1, tmp2, filename, offset);
+
     auto& gd = grid.get_grid_data();
 
     FILE *pFile;
@@ -663,5 +719,1001 @@ int Field3d_io<TF>::load_xy_slice(TF* restrict data, TF* restrict tmp, const cha
 }
 #endif
 
+namespace
+{
+    // Header of a compressed 3d field, followed by the offsets and sizes of all chunks.
+    // A chunk is a block of nrows rows of one level, and chunk index c = k*(jtot/nrows) + jblock.
+    const char compressed_magic[8] = {'M', 'H', 'H', 'Z', '3', 'D', '0', '1'};
+
+    struct Compressed_header
+    {
+        char magic[8];
+        int32_t itot;
+        int32_t jtot;
+        int32_t ktot;
+        int32_t nrows;       // Number of rows in y-direction per chunk.
+        int32_t nchunks;
+        int32_t stored_size; // Size in bytes of the stored values (4 or 8).
+        int32_t mode;        // 1 is lossless, 2 is lossy.
+        int32_t padding;
+        double tolerance;
+    };
+
+    // Transposes the bytes of the values, such that the exponent bytes end up next to each other.
+    template<typename TS>
+    void shuffle_bytes(unsigned char* const restrict out, const TS* const restrict in, const int n)
+    {
+        const unsigned char* const restrict bytes = reinterpret_cast<const unsigned char*>(in);
+        for (int b=0; b<int(sizeof(TS)); ++b)
+            #pragma ivdep
+            for (int i=0; i<n; ++i)
+                out[b*n + i] = bytes[i*sizeof(TS) + b];
+    }
+
+    template<typename TS>
+    void unshuffle_bytes(TS* const restrict out, const unsigned char* const restrict in, const int n)
+    {
+        unsigned char* const restrict bytes = reinterpret_cast<unsigned char*>(out);
+        for (int b=0; b<int(sizeof(TS)); ++b)
+            #pragma ivdep
+            for (int i=0; i<n; ++i)
+                bytes[i*sizeof(TS) + b] = in[b*n + i];
+    }
+
+    template<typename TF>
+    int compress_chunk(
+            std::vector<char>& out, const TF* const restrict in, const int n,
+            const Field3d_compression compression, const TF tolerance)
+    {
+        std::vector<unsigned char> shuffled;
+
+        if (compression == Field3d_compression::Lossy)
+        {
+            // Quantize to multiples of twice the tolerance, such that the error is at most the tolerance
+            // (on top of the float rounding), and the low mantissa bits become compressible.
+            std::vector<float> values(n);
+            if (tolerance > TF(0))
+            {
+                const TF step = TF(2)*tolerance;
+                for (int i=0; i<n; ++i)
+                    values[i] = static_cast<float>(std::round(in[i]/step)*step);
+            }
+            else
+            {
+                for (int i=0; i<n; ++i)
+                    values[i] = static_cast<float>(in[i]);
+            }
+
+            shuffled.resize(n*sizeof(float));
+            shuffle_bytes(shuffled.data(), values.data(), n);
+        }
+        else
+        {
+            shuffled.resize(n*sizeof(TF));
+            shuffle_bytes(shuffled.data(), in, n);
+        }
+
+        uLongf size = compressBound(shuffled.size());
+        out.resize(size);
+        const int zerr = compress2(
+                reinterpret_cast<Bytef*>(out.data()), &size,
+                shuffled.data(), shuffled.size(), Z_BEST_SPEED);
+        out.resize(size);
+
+        return (zerr == Z_OK) ? 0 : 1;
+    }
+
+    template<typename TF>
+    int decompress_chunk(
+            TF* const restrict out, const std::vector<char>& in, const int n, const int stored_size)
+    {
+        std::vector<unsigned char> shuffled(n*stored_size);
+
+        uLongf size = shuffled.size();
+        const int zerr = uncompress(
+                shuffled.data(), &size,
+                reinterpret_cast<const Bytef*>(in.data()), in.size());
+
+        if (zerr != Z_OK || size != shuffled.size())
+            return 1;
+
+        if (stored_size == sizeof(float))
+        {
+            std::vector<float> values(n);
+            unshuffle_bytes(values.data(), shuffled.data(), n);
+            for (int i=0; i<n; ++i)
+                out[i] = values[i];
+        }
+        else
+        {
+            std::vector<double> values(n);
+            unshuffle_bytes(values.data(), shuffled.data(), n);
+            for (int i=0; i<n; ++i)
+                out[i] = values[i];
+        }
+
+        return 0;
+    }
+}
+
+template<typename TF>
+void Field3d_io<TF>::set_compression(const Field3d_compression compression_in, const TF tolerance_in)
+{
+    compression = compression_in;
+    tolerance = tolerance_in;
+}
+
+template<typename TF>
+void Field3d_io<TF>::set_io_hints(const std::vector<std::string>& hints)
+{
+    io_hints.clear();
+    for (auto& h : hints)
+    {
+        const size_t pos = h.find('=');
+        if (pos == std::string::npos || pos == 0)
+            throw std::runtime_error("MPI-IO hint \"" + h + "\" is not of the form key=value");
+
+        io_hints.emplace_back(h.substr(0, pos), h.substr(pos+1));
+    }
+}
+
+template<typename TF>
+void Field3d_io<TF>::set_restart_alignment(const long alignment)
+{
+    if (alignment <= 0 || alignment % sizeof(double) != 0)
+        throw std::runtime_error("The alignment of the restart fields has to be a positive multiple of 8 bytes");
+
+    restart_alignment = alignment;
+}
+
+template<typename TF>
+const TF* Field3d_io<TF>::extract_field3d(TF* restrict data, TF* restrict tmp1, TF* restrict tmp2, const TF offset)
+{
+    auto& gd = grid.get_grid_data();
+
+    const int jj  = gd.icells;
+    const int kk  = gd.icells*gd.jcells;
+    const int jjb = gd.imax;
+    const int kkb = gd.imax*gd.jmax;
+
+    // Extract the data from the 3d field without the ghost cells.
+    for (int k=0; k<gd.kmax; ++k)
+        for (int j=0; j<gd.jmax; ++j)
+            #pragma ivdep
+            for (int i=0; i<gd.imax; ++i)
+            {
+                const int ijk  = i+gd.igc + (j+gd.jgc)*jj + (k+gd.kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                tmp1[ijkb] = data[ijk] + offset;
+            }
+
+    #ifdef USEMPI
+    // Store the data in transposed order, such that each process owns contiguous blocks of the file.
+    transpose.exec_zx(tmp2, tmp1);
+    return tmp2;
+    #else
+    return tmp1;
+    #endif
+}
+
+template<typename TF>
+void Field3d_io<TF>::insert_field3d(TF* restrict data, TF* restrict tmp1, TF* restrict tmp2, const TF offset)
+{
+    auto& gd = grid.get_grid_data();
+
+    #ifdef USEMPI
+    // Transpose the data back from the file order.
+    transpose.exec_xz(tmp2, tmp1);
+    const TF* const restrict loaded = tmp2;
+    #else
+    const TF* const restrict loaded = tmp1;
+    #endif
+
+    const int jj  = gd.icells;
+    const int kk  = gd.icells*gd.jcells;
+    const int jjb = gd.imax;
+    const int kkb = gd.imax*gd.jmax;
+
+    // Put the data back into the 3d field with ghost cells.
+    for (int k=0; k<gd.kmax; ++k)
+        for (int j=0; j<gd.jmax; ++j)
+            #pragma ivdep
+            for (int i=0; i<gd.imax; ++i)
+            {
+                const int ijk  = i+gd.igc + (j+gd.jgc)*jj + (k+gd.kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                data[ijk] = loaded[ijkb] - offset;
+            }
+}
+
+template<typename TF>
+int Field3d_io<TF>::create_file(const std::string& filename)
+{
+    // Create the file on the main process only, failing if it already exists.
+    int nerror = 0;
+    if (master.get_mpiid() == 0)
+    {
+        FILE *pFile = fopen(filename.c_str(), "wbx");
+        if (pFile == NULL)
+            ++nerror;
+        else
+            fclose(pFile);
+    }
+
+    master.sum(&nerror, 1);
+    return nerror;
+}
+
+template<typename TF>
+void Field3d_io<TF>::build_raw_job(Io_job& job, const TF* const restrict staged)
+{
+    auto& gd = grid.get_grid_data();
+
+    job.data.assign(
+            reinterpret_cast<const char*>(staged),
+            reinterpret_cast<const char*>(staged + gd.imax*gd.jmax*gd.kmax));
+    job.segments.clear();
+
+    // Each process writes its slab of kblock levels and jmax rows of the {kmax, jtot, itot} file,
+    // which consists of one contiguous block per level.
+    #ifdef USEMPI
+    auto& md = master.get_MPI_data();
+    const long block_size = gd.itot*gd.jmax;
+    const long block_start = md.mpicoordy*gd.jmax*gd.itot;
+    const long block_stride = gd.jtot*gd.itot;
+    const long k0 = md.mpicoordx*gd.kblock;
+
+    for (int n=0; n<gd.kblock; ++n)
+        job.segments.emplace_back((block_start + (k0+n)*block_stride)*sizeof(TF), block_size*sizeof(TF));
+    #else
+    job.segments.emplace_back(0, job.data.size());
+    #endif
+}
+
+template<typename TF>
+int Field3d_io<TF>::build_compressed_job(Io_job& job, const TF* const restrict staged)
+{
+    auto& gd = grid.get_grid_data();
+
+    #ifdef USEMPI
+    auto& md = master.get_MPI_data();
+    const int nk = gd.kblock;
+    const int k0 = md.mpicoordx*gd.kblock;
+    const int nrows = gd.jmax;
+    const int jblock = md.mpicoordy;
+    const int nblocks = md.npy;
+    #else
+    const int nk = gd.kmax;
+    const int k0 = 0;
+    const int nrows = gd.jtot;
+    const int jblock = 0;
+    const int nblocks = 1;
+    #endif
+
+    const int nchunks = gd.kmax*nblocks;
+    const int chunk_size = nrows*gd.itot;
+
+    // Compress the levels of the slab independently.
+    std::vector<std::vector<char>> chunks(nk);
+    int nerror = 0;
+
+    #pragma omp parallel for reduction(+:nerror)
+    for (int n=0; n<nk; ++n)
+        nerror += compress_chunk(chunks[n], &staged[n*chunk_size], chunk_size, compression, tolerance);
+
+    master.sum(&nerror, 1);
+    if (nerror)
+        return nerror;
+
+    // The compressed data of the processes is stored in order of their rank after the header and index.
+    const long long header_size = sizeof(Compressed_header) + 2*nchunks*sizeof(long long);
+
+    long long local_size = 0;
+    for (auto& c : chunks)
+        local_size += c.size();
+
+    long long local_start = 0;
+    #ifdef USEMPI
+    MPI_Exscan(&local_size, &local_start, 1, MPI_LONG_LONG, MPI_SUM, md.commxy);
+    if (md.mpiid == 0)
+        local_start = 0;
+    #endif
+    local_start += header_size;
+
+    // Fill in the offsets and sizes of the own chunks, and gather the index on the main process.
+    std::vector<long long> index(2*nchunks, 0);
+    long long chunk_start = local_start;
+    for (int n=0; n<nk; ++n)
+    {
+        const int c = (k0+n)*nblocks + jblock;
+        index[c] = chunk_start;
+        index[nchunks+c] = chunks[n].size();
+        chunk_start += chunks[n].size();
+    }
+
+    #ifdef USEMPI
+    if (md.mpiid == 0)
+        MPI_Reduce(MPI_IN_PLACE, index.data(), 2*nchunks, MPI_LONG_LONG, MPI_SUM, 0, md.commxy);
+    else
+        MPI_Reduce(index.data(), nullptr, 2*nchunks, MPI_LONG_LONG, MPI_SUM, 0, md.commxy);
+    #endif
+
+    job.data.clear();
+    job.segments.clear();
+
+    if (master.get_mpiid() == 0)
+    {
+        Compressed_header header;
+        std::copy(compressed_magic, compressed_magic+8, header.magic);
+        header.itot = gd.itot;
+        header.jtot = gd.jtot;
+        header.ktot = gd.kmax;
+        header.nrows = nrows;
+        header.nchunks = nchunks;
+        header.stored_size = (compression == Field3d_compression::Lossy) ? sizeof(float) : sizeof(TF);
+        header.mode = (compression == Field3d_compression::Lossy) ? 2 : 1;
+        header.padding = 0;
+        header.tolerance = tolerance;
+
+        const char* header_ptr = reinterpret_cast<const char*>(&header);
+        const char* index_ptr = reinterpret_cast<const char*>(index.data());
+        job.data.insert(job.data.end(), header_ptr, header_ptr + sizeof(Compressed_header));
+        job.data.insert(job.data.end(), index_ptr, index_ptr + index.size()*sizeof(long long));
+        job.segments.emplace_back(0, header_size);
+    }
+
+    for (auto& c : chunks)
+        job.data.insert(job.data.end(), c.begin(), c.end());
+    job.segments.emplace_back(local_start, local_size);
+
+    return 0;
+}
+
+#ifdef USEMPI
+template<typename TF>
+int Field3d_io<TF>::write_job(const Io_job& job)
+{
+    int nerror = 0;
+
+    // The counts of MPI are of type int, which overflows for more than 2 GiB per process. Therefore, the
+    // segments are written in rounds of at most max_round bytes per process, and all processes take part
+    // in the number of rounds that the process with the most data needs.
+    const long max_round = 1L << 30;
+
+    long size = 0;
+    for (auto& s : job.segments)
+        size += s.second;
+
+    long nrounds = (size + max_round - 1) / max_round;
+    MPI_Allreduce(MPI_IN_PLACE, &nrounds, 1, MPI_LONG, MPI_MAX, job.comm);
+
+    MPI_File fh;
+    if (MPI_File_open(job.comm, job.filename.c_str(), MPI_MODE_WRONLY, io_info, &fh))
+        return 1;
+
+    char name[] = "native";
+
+    size_t iseg = 0;  // Segment that is written next.
+    long seg_pos = 0; // Number of bytes of that segment that are written.
+    long data_pos = 0;
+
+    for (long r=0; r<nrounds; ++r)
+    {
+        // Describe the pieces of the segments of this round as one file view, such that the pieces of all
+        // processes are written in a single collective call, and MPI-IO can aggregate them into stripe-sized writes.
+        std::vector<int> lengths;
+        std::vector<MPI_Aint> displacements;
+
+        long count = 0;
+        while (iseg < job.segments.size() && count < max_round)
+        {
+            const long length = std::min(job.segments[iseg].second - seg_pos, max_round - count);
+            displacements.push_back(job.segments[iseg].first + seg_pos);
+            lengths.push_back(length);
+            count += length;
+            seg_pos += length;
+
+            if (seg_pos == job.segments[iseg].second)
+            {
+                ++iseg;
+                seg_pos = 0;
+            }
+        }
+
+        // A process without data in this round joins the collective write with an empty write.
+        MPI_Datatype filetype = MPI_BYTE;
+        if (count > 0)
+        {
+            MPI_Type_create_hindexed(lengths.size(), lengths.data(), displacements.data(), MPI_BYTE, &filetype);
+            MPI_Type_commit(&filetype);
+        }
+
+        if (MPI_File_set_view(fh, 0, MPI_BYTE, filetype, name, io_info))
+            ++nerror;
+
+        if (MPI_File_write_all(fh, job.data.data() + data_pos, count, MPI_BYTE, MPI_STATUS_IGNORE))
+            ++nerror;
+
+        if (count > 0)
+            MPI_Type_free(&filetype);
+
+        data_pos += count;
+    }
+
+    if (MPI_File_close(&fh))
+        ++nerror;
+
+    return nerror;
+}
+#else
+template<typename TF>
+int Field3d_io<TF>::write_job(const Io_job& job)
+{
+    int nerror = 0;
+    FILE *pFile = fopen(job.filename.c_str(), "r+b");
+
+    if (pFile == NULL)
+        return 1;
+
+    long pos = 0;
+    for (auto& s : job.segments)
+    {
+        if (fseek(pFile, s.first, SEEK_SET) != 0 ||
+            fwrite(&job.data[pos], 1, s.second, pFile) != static_cast<size_t>(s.second))
+        {
+            ++nerror;
+            break;
+        }
+        pos += s.second;
+    }
+
+    if (fclose(pFile) != 0)
+        ++nerror;
+
+    return nerror;
+}
+#endif
+
+template<typename TF>
+int Field3d_io<TF>::save_field3d_compressed(TF* restrict data, TF* restrict tmp1, TF* restrict tmp2,
+        const char* filename, const TF offset)
+{
+    const TF* staged = extract_field3d(data, tmp1, tmp2, offset);
+
+    if (create_file(filename))
+        return 1;
+
+    Io_job job;
+    job.filename = filename;
+    #ifdef USEMPI
+    job.comm = master.get_MPI_data().commxy;
+    #endif
+    if (build_compressed_job(job, staged))
+        return 1;
+
+    // The file exists before any process opens it, because create_file() is collective.
+    int nerror = write_job(job);
+    master.sum(&nerror, 1);
+
+    return nerror;
+}
+
+template<typename TF>
+bool Field3d_io<TF>::is_compressed(const char* filename)
+{
+    // Only the main process reads the magic bytes, to avoid that all processes open the file.
+    int compressed = 0;
+
+    if (master.get_mpiid() == 0)
+    {
+        char magic[8] = {0};
+
+        FILE *pFile = fopen(filename, "rb");
+        if (pFile != NULL)
+        {
+            const size_t nread = fread(magic, 1, 8, pFile);
+            fclose(pFile);
+
+            compressed = (nread == 8) && std::equal(magic, magic+8, compressed_magic);
+        }
+    }
+
+    master.broadcast(&compressed, 1);
+
+    return compressed;
+}
+
+template<typename TF>
+int Field3d_io<TF>::load_field3d_compressed(TF* restrict data, TF* restrict tmp1, TF* restrict tmp2,
+        const char* filename, const TF offset)
+{
+    auto& gd = grid.get_grid_data();
+
+    // Each process reads the levels and rows that it owns in the transposed layout.
+    #ifdef USEMPI
+    auto& md = master.get_MPI_data();
+    const int nk = gd.kblock;
+    const int k0 = md.mpicoordx*gd.kblock;
+    const int jrows = gd.jmax;
+    const int j0 = md.mpicoordy*gd.jmax;
+    #else
+    const int nk = gd.kmax;
+    const int k0 = 0;
+    const int jrows = gd.jtot;
+    const int j0 = 0;
+    #endif
+
+    int nerror = 0;
+
+    // Only the main process reads the header and the index, the other processes receive them.
+    Compressed_header header;
+    std::vector<long long> index;
+
+    if (master.get_mpiid() == 0)
+    {
+        FILE *pFile = fopen(filename, "rb");
+        if (pFile == NULL)
+            ++nerror;
+        else
+        {
+            if (fread(&header, sizeof(Compressed_header), 1, pFile) != 1)
+                ++nerror;
+            else if (header.itot != gd.itot || header.jtot != gd.jtot || header.ktot != gd.kmax
+                    || header.nrows <= 0 || gd.jtot % header.nrows != 0
+                    || header.nchunks != gd.kmax*(gd.jtot/header.nrows))
+                ++nerror;
+            else
+            {
+                index.resize(2*header.nchunks);
+                if (fread(index.data(), sizeof(long long), index.size(), pFile) != index.size())
+                    ++nerror;
+            }
+
+            fclose(pFile);
+        }
+    }
+
+    // The error is known on all processes, so they can all leave before the collective calls.
+    master.broadcast(&nerror, 1);
+    if (nerror)
+        return nerror;
+
+    master.broadcast(reinterpret_cast<char*>(&header), sizeof(Compressed_header));
+    index.resize(2*header.nchunks);
+    master.broadcast(reinterpret_cast<char*>(index.data()), index.size()*sizeof(long long));
+
+    // Each process reads its own chunks at the offsets in the index.
+    #ifdef USEMPI
+    MPI_File fh;
+    const bool file_open = (MPI_File_open(md.commxy, filename, MPI_MODE_RDONLY, io_info, &fh) == MPI_SUCCESS);
+    #else
+    FILE *pFile = fopen(filename, "rb");
+    const bool file_open = (pFile != NULL);
+    #endif
+
+    if (!file_open)
+        ++nerror;
+    else
+    {
+        const int nrows = header.nrows;
+        const int nblocks = gd.jtot/nrows;
+
+        std::vector<char> buffer;
+        std::vector<TF> chunk(nrows*gd.itot);
+
+        for (int n=0; n<nk && !nerror; ++n)
+            for (int jb=j0/nrows; jb<=(j0+jrows-1)/nrows && !nerror; ++jb)
+            {
+                const int c = (k0+n)*nblocks + jb;
+                buffer.resize(index[header.nchunks+c]);
+
+                #ifdef USEMPI
+                MPI_Status status;
+                int nread = 0;
+                const bool read_ok =
+                    MPI_File_read_at(fh, index[c], buffer.data(), buffer.size(), MPI_BYTE, &status) == MPI_SUCCESS &&
+                    MPI_Get_count(&status, MPI_BYTE, &nread) == MPI_SUCCESS &&
+                    nread == int(buffer.size());
+                #else
+                const bool read_ok =
+                    fseek(pFile, index[c], SEEK_SET) == 0 &&
+                    fread(buffer.data(), 1, buffer.size(), pFile) == buffer.size();
+                #endif
+
+                if (!read_ok || decompress_chunk(chunk.data(), buffer, chunk.size(), header.stored_size))
+                {
+                    ++nerror;
+                    break;
+                }
+
+                // Copy the rows of the chunk that fall within the own slab.
+                const int jbeg = std::max(j0, jb*nrows);
+                const int jend = std::min(j0+jrows, (jb+1)*nrows);
+                for (int j=jbeg; j<jend; ++j)
+                    std::copy(&chunk[(j-jb*nrows)*gd.itot], &chunk[(j-jb*nrows+1)*gd.itot],
+                              &tmp1[(n*jrows + j-j0)*gd.itot]);
+            }
+
+        #ifdef USEMPI
+        if (MPI_File_close(&fh))
+            ++nerror;
+        #else
+        fclose(pFile);
+        #endif
+    }
+
+    // The transpose is collective, so it is executed even if reading failed on this process.
+    insert_field3d(data, tmp1, tmp2, offset);
+
+    master.sum(&nerror, 1);
+
+    return nerror;
+}
+
+template<typename TF>
+int Field3d_io<TF>::stage_field3d(TF* restrict data, TF* restrict tmp1, TF* restrict tmp2,
+        const std::string& filename, const TF offset)
+{
+    #ifdef USEMPI
+    // The background threads of all processes write the staged fields collectively, in the order in which
+    // they are staged, on a communicator of their own, while the master threads continue to communicate.
+    if (io_comm == MPI_COMM_NULL)
+    {
+        if (master.get_MPI_data().thread_level < MPI_THREAD_MULTIPLE)
+            throw std::runtime_error("Writing in the background (swasync) requires MPI_THREAD_MULTIPLE support");
+
+        MPI_Comm_dup(master.get_MPI_data().commxy, &io_comm);
+    }
+    #endif
+
+    const TF* staged = extract_field3d(data, tmp1, tmp2, offset);
+
+    if (create_file(filename))
+        return 1;
+
+    // The compression and its index need collective communication, so they are done before staging.
+    // The background thread only writes the prepared segments.
+    Io_job job;
+    job.filename = filename;
+    #ifdef USEMPI
+    job.comm = io_comm;
+    #endif
+    if (compression == Field3d_compression::None)
+        build_raw_job(job, staged);
+    else if (build_compressed_job(job, staged))
+        return 1;
+
+    {
+        std::lock_guard<std::mutex> lock(io_mutex);
+        io_jobs.push_back(std::move(job));
+    }
+
+    if (!io_thread.joinable())
+        io_thread = std::thread(&Field3d_io<TF>::write_staged, this);
+
+    io_cv.notify_all();
+
+    return 0;
+}
+
+template<typename TF>
+int Field3d_io<TF>::wait_staged()
+{
+    int nerror = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(io_mutex);
+        io_cv.wait(lock, [&]{ return io_jobs.empty() && !io_busy; });
+        nerror = io_nerror;
+        io_nerror = 0;
+    }
+
+    master.sum(&nerror, 1);
+
+    return nerror;
+}
+
+template<typename TF>
+void Field3d_io<TF>::write_staged()
+{
+    while (true)
+    {
+        Io_job job;
+        {
+            std::unique_lock<std::mutex> lock(io_mutex);
+            io_cv.wait(lock, [&]{ return !io_jobs.empty() || io_stop; });
+
+            if (io_jobs.empty())
+                return;
+
+            job = std::move(io_jobs.front());
+            io_jobs.pop_front();
+            io_busy = true;
+        }
+
+        const int nerror = write_job(job);
+
+        {
+            std::lock_guard<std::mutex> lock(io_mutex);
+            io_nerror += nerror;
+            io_busy = false;
+        }
+        io_cv.notify_all();
+    }
+}
+
+namespace
+{
+    // Header of a restart file, followed by the index of the fields, the vertical grid (z and zh) and the fields.
+    // Each field is stored as {ktot, jtot, itot} and starts at a multiple of the alignment, such that the
+    // fields do not share file system stripes.
+    const char restart_magic[8] = {'M', 'H', 'H', 'R', 'S', 'T', '0', '1'};
+
+    struct Restart_header
+    {
+        char magic[8];
+        int32_t itot;
+        int32_t jtot;
+        int32_t ktot;
+        int32_t nfields;
+        int32_t value_size;  // Size in bytes of the stored values (4 or 8).
+        int32_t iteration;
+        uint64_t itime;
+        uint64_t idt;
+        int64_t field_size;  // Size in bytes of one field.
+        int64_t grid_offset; // Offset of z and zh, which directly follow the index.
+    };
+
+    struct Restart_index_entry
+    {
+        char name[56];
+        int64_t offset;
+    };
+
+    long align_offset(const long offset, const long alignment)
+    {
+        return ((offset + alignment - 1) / alignment) * alignment;
+    }
+}
+
+template<typename TF>
+int Field3d_io<TF>::save_restart(
+        const std::string& filename, const std::vector<std::pair<std::string, TF*>>& fields,
+        const Restart_state& state, TF* restrict tmp1, TF* restrict tmp2)
+{
+    auto& gd = grid.get_grid_data();
+
+    const int nfields = fields.size();
+
+    // All processes build the header and index, such that they know the offsets of the fields.
+    Restart_header header;
+    std::copy(restart_magic, restart_magic+8, header.magic);
+    header.itot = gd.itot;
+    header.jtot = gd.jtot;
+    header.ktot = gd.kmax;
+    header.nfields = nfields;
+    header.value_size = sizeof(TF);
+    header.iteration = state.iteration;
+    header.itime = state.itime;
+    header.idt = state.idt;
+    header.field_size = static_cast<int64_t>(gd.itot)*gd.jtot*gd.kmax*sizeof(TF);
+    header.grid_offset = sizeof(Restart_header) + nfields*sizeof(Restart_index_entry);
+
+    const long data_start = align_offset(header.grid_offset + 2*gd.kmax*sizeof(TF), restart_alignment);
+    const long field_stride = align_offset(header.field_size, restart_alignment);
+
+    std::vector<Restart_index_entry> index(nfields);
+    for (int n=0; n<nfields; ++n)
+    {
+        if (fields[n].first.size() >= sizeof(index[n].name))
+            return 1;
+
+        std::fill(index[n].name, index[n].name + sizeof(index[n].name), '\0');
+        fields[n].first.copy(index[n].name, fields[n].first.size());
+        index[n].offset = data_start + n*field_stride;
+    }
+
+    std::vector<char> header_data;
+    auto append = [&](const void* ptr, const size_t size)
+    {
+        const char* bytes = static_cast<const char*>(ptr);
+        header_data.insert(header_data.end(), bytes, bytes + size);
+    };
+
+    append(&header, sizeof(Restart_header));
+    append(index.data(), nfields*sizeof(Restart_index_entry));
+    append(&gd.z [gd.kstart], gd.kmax*sizeof(TF));
+    append(&gd.zh[gd.kstart], gd.kmax*sizeof(TF));
+
+    // The offset is kept at zero, because otherwise bitwise identical restarts are not possible.
+    const TF no_offset = 0.;
+
+    int nerror = 0;
+
+    #ifdef USEMPI
+    auto& md = master.get_MPI_data();
+    const int count = gd.imax*gd.jmax*gd.kmax;
+
+    MPI_File fh;
+    if (MPI_File_open(md.commxy, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, io_info, &fh))
+        return 1;
+
+    // The main process writes the header with the default view of bytes.
+    if (md.mpiid == 0)
+        if (MPI_File_write_at(fh, 0, header_data.data(), header_data.size(), MPI_CHAR, MPI_STATUS_IGNORE))
+            ++nerror;
+
+    // Each field is one collective write of the transposed slabs of all processes. All processes
+    // take part in all writes, also after an error, to prevent deadlocks.
+    char name[] = "native";
+    for (int n=0; n<nfields; ++n)
+    {
+        const TF* staged = extract_field3d(fields[n].second, tmp1, tmp2, no_offset);
+
+        if (MPI_File_set_view(fh, index[n].offset, mpi_fp_type<TF>(), subarray, name, io_info))
+            ++nerror;
+
+        if (MPI_File_write_all(fh, staged, count, mpi_fp_type<TF>(), MPI_STATUS_IGNORE))
+            ++nerror;
+    }
+
+    if (MPI_File_close(&fh))
+        ++nerror;
+    #else
+    const size_t count = static_cast<size_t>(gd.itot)*gd.jtot*gd.kmax;
+
+    FILE *pFile = fopen(filename.c_str(), "wbx");
+    if (pFile == NULL)
+        return 1;
+
+    if (fwrite(header_data.data(), 1, header_data.size(), pFile) != header_data.size())
+        ++nerror;
+
+    for (int n=0; n<nfields && !nerror; ++n)
+    {
+        const TF* staged = extract_field3d(fields[n].second, tmp1, tmp2, no_offset);
+
+        if (fseek(pFile, index[n].offset, SEEK_SET) != 0 ||
+            fwrite(staged, sizeof(TF), count, pFile) != count)
+            ++nerror;
+    }
+
+    if (fclose(pFile) != 0)
+        ++nerror;
+    #endif
+
+    master.sum(&nerror, 1);
+
+    return nerror;
+}
+
+template<typename TF>
+int Field3d_io<TF>::load_restart(
+        const std::string& filename, const std::vector<std::pair<std::string, TF*>>& fields,
+        Restart_state& state, TF* restrict tmp1, TF* restrict tmp2)
+{
+    auto& gd = grid.get_grid_data();
+
+    const int nfields = fields.size();
+
+    int nerror = 0;
+
+    // The main process reads and checks the header, index and grid, and shares them with the other processes.
+    Restart_header header;
+    std::vector<char> header_data;
+    int header_size = 0;
+
+    if (master.get_mpiid() == 0)
+    {
+        FILE *pFile = fopen(filename.c_str(), "rb");
+        if (pFile == NULL)
+            ++nerror;
+        else
+        {
+            if (fread(&header, sizeof(Restart_header), 1, pFile) != 1
+                    || !std::equal(restart_magic, restart_magic+8, header.magic)
+                    || header.itot != gd.itot || header.jtot != gd.jtot || header.ktot != gd.kmax
+                    || header.nfields < 0 || header.value_size != sizeof(TF))
+                ++nerror;
+            else
+            {
+                header_size = header.grid_offset + 2*header.ktot*sizeof(TF);
+                header_data.resize(header_size);
+
+                if (fseek(pFile, 0, SEEK_SET) != 0 ||
+                    fread(header_data.data(), 1, header_size, pFile) != static_cast<size_t>(header_size))
+                    ++nerror;
+            }
+
+            fclose(pFile);
+        }
+
+        // The stored vertical grid has to be identical to the grid of the run.
+        if (!nerror)
+        {
+            const TF* z  = reinterpret_cast<const TF*>(&header_data[header.grid_offset]);
+            const TF* zh = z + gd.kmax;
+
+            if (!std::equal(z, z+gd.kmax, &gd.z[gd.kstart]) || !std::equal(zh, zh+gd.kmax, &gd.zh[gd.kstart]))
+                ++nerror;
+        }
+    }
+
+    master.sum(&nerror, 1);
+    if (nerror)
+        return nerror;
+
+    master.broadcast(&header_size, 1);
+    header_data.resize(header_size);
+    master.broadcast(header_data.data(), header_size);
+
+    std::copy(header_data.begin(), header_data.begin() + sizeof(Restart_header), reinterpret_cast<char*>(&header));
+
+    std::vector<Restart_index_entry> index(header.nfields);
+    std::copy(header_data.begin() + sizeof(Restart_header), header_data.begin() + header.grid_offset,
+              reinterpret_cast<char*>(index.data()));
+
+    state.itime = header.itime;
+    state.idt = header.idt;
+    state.iteration = header.iteration;
+
+    // Look up the offsets of the requested fields, which are the same on all processes.
+    std::vector<long> offsets(nfields, -1);
+    for (int n=0; n<nfields; ++n)
+        for (auto& e : index)
+            if (fields[n].first == e.name)
+                offsets[n] = e.offset;
+
+    if (std::find(offsets.begin(), offsets.end(), -1) != offsets.end())
+        return 1;
+
+    const TF no_offset = 0.;
+
+    #ifdef USEMPI
+    auto& md = master.get_MPI_data();
+    const int count = gd.imax*gd.jmax*gd.kmax;
+
+    MPI_File fh;
+    if (MPI_File_open(md.commxy, filename.c_str(), MPI_MODE_RDONLY, io_info, &fh))
+        return 1;
+
+    char name[] = "native";
+    for (int n=0; n<nfields; ++n)
+    {
+        if (MPI_File_set_view(fh, offsets[n], mpi_fp_type<TF>(), subarray, name, io_info))
+            ++nerror;
+
+        if (MPI_File_read_all(fh, tmp1, count, mpi_fp_type<TF>(), MPI_STATUS_IGNORE))
+            ++nerror;
+
+        insert_field3d(fields[n].second, tmp1, tmp2, no_offset);
+    }
+
+    if (MPI_File_close(&fh))
+        ++nerror;
+    #else
+    const size_t count = static_cast<size_t>(gd.itot)*gd.jtot*gd.kmax;
+
+    FILE *pFile = fopen(filename.c_str(), "rb");
+    if (pFile == NULL)
+        return 1;
+
+    for (int n=0; n<nfields && !nerror; ++n)
+    {
+        if (fseek(pFile, offsets[n], SEEK_SET) != 0 ||
+            fread(tmp1, sizeof(TF), count, pFile) != count)
+            ++nerror;
+        else
+            insert_field3d(fields[n].second, tmp1, tmp2, no_offset);
+    }
+
+    fclose(pFile);
+    #endif
+
+    master.sum(&nerror, 1);
+
+    return nerror;
+}
+
 template class Field3d_io<double>;
 template class Field3d_io<float>;
@@ -114,7 +114,7 @@ TF Field3d_operators<TF>::calc_mean(const TF* const restrict fld)
 
     double sum = 0;
 
-    #pragma omp parallel for
+    #pragma omp parallel for reduction(+:sum)
     for (int k=gd.kstart; k<gd.kend; ++k)
         for (int j=gd.jstart; j<gd.jend; ++j)
             #pragma ivdep
@@ -41,6 +41,7 @@
 #include "cross.h"
 #include "dump.h"
 #include "diff.h"
+#include "timeloop.h"
 
 namespace
 {
@@ -235,7 +236,8 @@ Fields<TF>::Fields(Master& masterin, Grid<TF>& gridin, Input& input) :
     master(masterin),
     grid(gridin),
     field3d_io(master, grid),
-    field3d_operators(master, grid, *this)
+    field3d_operators(master, grid, *this),
+    scratch_pool(master)
 {
     auto& gd = grid.get_grid_data();
     calc_mean_profs = false;
@@ -247,6 +249,24 @@ Fields<TF>::Fields(Master& masterin, Grid<TF>& gridin, Input& input) :
     // obligatory parameters
     visc = input.get_item<TF>("fields", "visc", "");
 
+    swasync = input.get_item<bool>("fields", "swasync", "", false);
+
+    // Restart files can only be compressed losslessly, to keep restarts bitwise identical.
+    const bool swcompress = input.get_item<bool>("fields", "swcompress", "", false);
+    if (swcompress)
+        field3d_io.set_compression(Field3d_compression::Lossless);
+
+    swrestartfile = input.get_item<bool>("fields", "swrestartfile", "", false);
+    if (swrestartfile)
+    {
+        if (swasync || swcompress)
+            throw std::runtime_error("swrestartfile cannot be combined with swasync or swcompress");
+
+        field3d_io.set_restart_alignment(input.get_item<int>("fields", "restartalign", "", 4096));
+    }
+
+    field3d_io.set_io_hints(input.get_list<std::string>("fields", "iohints", "", std::vector<std::string>()));
+
     // Initialize the passive scalars
     std::vector<std::string> slist = input.get_list<std::string>("fields", "slist", "", std::vector<std::string>());
     for (auto& s : slist)
@@ -269,6 +289,10 @@ Fields<TF>::Fields(Master& masterin, Grid<TF>& gridin, Input& input) :
     // Set a default of 4 temporary fields. Other classes can increase this number
     // before the init phase, where they are initialized in Fields::init()
     n_tmp_fields = 4;
+    n_tmp_in_use = 0;
+    n_tmp_peak = 0;
+
+    prognostic_version = 0;
 
     // Specify the masks that fields can provide / calculate
     available_masks.insert(available_masks.end(), {"default", "wplus", "wmin"});
@@ -292,6 +316,15 @@ Fields<TF>::Fields(Master& masterin, Grid<TF>& gridin, Input& input) :
 template<typename TF>
 Fields<TF>::~Fields()
 {
+    // Report the high-water mark of the temporary fields, to help tuning the memory use.
+    if (n_tmp_peak > 0)
+    {
+        auto& gd = grid.get_grid_data();
+        const double mbytes = double(n_tmp_peak) * gd.ncells * sizeof(TF) / (1024.*1024.);
+        master.print_message("Scratch buffers %-8s: peak %3d of %9d elements (%.1f MB)\n",
+                "3d", n_tmp_peak, gd.ncells, mbytes);
+    }
+    scratch_pool.print_usage();
 }
 
 template<typename TF>
@@ -335,6 +368,11 @@ void Fields<TF>::init(Dump<TF>& dump, Cross<TF>& cross)
     // Get the grid data.
     const Grid_data<TF>& gd = grid.get_grid_data();
 
+    // Register the size classes of the scratch buffers.
+    scratch_pool.add_size_class("xy", gd.ijcells);
+    scratch_pool.add_size_class("xz", gd.icells*gd.kcells);
+    scratch_pool.add_size_class("z" , gd.kcells);
+
     rhoref .resize(gd.kcells);
     rhorefh.resize(gd.kcells);
 
@@ -365,6 +403,9 @@ void Fields<TF>::exec()
     {
         for (auto& it : ap)
             field3d_operators.calc_mean_profile(it.second->fld_mean.data(), it.second->fld.data());
+
+        // The means enter the base state of the thermodynamics.
+        update_prognostic_version();
     }
 }
 #endif
@@ -448,20 +489,27 @@ std::shared_ptr<Field3d<TF>> Fields<TF>::get_tmp()
 {
     std::shared_ptr<Field3d<TF>> tmp;
 
-    #pragma omp critical
     {
-        // In case of insufficient tmp fields, allocate a new one.
-        if (atmp.empty())
+        std::lock_guard<std::mutex> lock(tmp_fld_mutex);
+
+        if (!atmp.empty())
         {
-            init_tmp_field();
             tmp = atmp.back();
-            tmp->init();
+            atmp.pop_back();
         }
-        else
-            tmp = atmp.back();
 
-        atmp.pop_back();
+        ++n_tmp_in_use;
+        n_tmp_peak = std::max(n_tmp_peak, n_tmp_in_use);
     }
+
+    // In case of insufficient tmp fields, allocate a new one outside of the lock.
+    if (tmp == nullptr)
+    {
+        tmp = std::make_shared<Field3d<TF>>(master, grid, "tmp", "", "", grid.get_grid_data().sloc);
+        tmp->init();
+        master.print_message("Allocating temporary field: tmp\n");
+    }
+
     return tmp;
 }
 
@@ -471,7 +519,30 @@ void Fields<TF>::release_tmp(std::shared_ptr<Field3d<TF>>& tmp)
     if (tmp == nullptr)
         throw std::runtime_error("Cannot release a tmp field with value nullptr");
 
+    std::lock_guard<std::mutex> lock(tmp_fld_mutex);
     atmp.push_back(std::move(tmp));
+    --n_tmp_in_use;
+}
+
+template<typename TF>
+Scratch_buffer<TF> Fields<TF>::get_tmp_xy()
+{
+    auto& gd = grid.get_grid_data();
+    return scratch_pool.get(gd.ijcells);
+}
+
+template<typename TF>
+Scratch_buffer<TF> Fields<TF>::get_tmp_xz()
+{
+    auto& gd = grid.get_grid_data();
+    return scratch_pool.get(gd.icells*gd.kcells);
+}
+
+template<typename TF>
+Scratch_buffer<TF> Fields<TF>::get_tmp_z()
+{
+    auto& gd = grid.get_grid_data();
+    return scratch_pool.get(gd.kcells);
 }
 
 template<typename TF>
@@ -673,6 +744,8 @@ void Fields<TF>::create(Input& input, Netcdf_file& input_nc)
         mp.at("w")->fld[lbot+l] = 0.;
         mp.at("w")->fld[ltop+l] = 0.;
     }
+
+    update_prognostic_version();
 }
 
 template<typename TF>
@@ -898,6 +971,11 @@ void Fields<TF>::save(int n)
     auto tmp2 = get_tmp();
 
     int nerror = 0;
+
+    // Make sure that the previous restart files are complete, before staging the new ones.
+    if (swasync)
+        nerror += field3d_io.wait_staged();
+
     for (auto& f : ap)
     {
         char filename[256];
@@ -905,7 +983,20 @@ void Fields<TF>::save(int n)
         master.print_message("Saving \"%s\" ... ", filename);
 
         // The offset is kept at zero, because otherwise bitwise identical restarts are not possible.
-        if (field3d_io.save_field3d(f.second->fld.data(), tmp1->fld.data(), tmp2->fld.data(),
+        if (swasync)
+        {
+            if (field3d_io.stage_field3d(f.second->fld.data(), tmp1->fld.data(), tmp2->fld.data(),
+                        filename, no_offset))
+            {
+                master.print_message("FAILED\n");
+                ++nerror;
+            }
+            else
+            {
+                master.print_message("STAGED\n");
+            }
+        }
+        else if (field3d_io.save_field3d(f.second->fld.data(), tmp1->fld.data(), tmp2->fld.data(),
                     filename, no_offset))
         {
             master.print_message("FAILED\n");
@@ -926,6 +1017,16 @@ void Fields<TF>::save(int n)
         throw std::runtime_error("Error allocating fields");
 }
 
+template<typename TF>
+void Fields<TF>::wait_save()
+{
+    if (!swasync)
+        return;
+
+    if (field3d_io.wait_staged())
+        throw std::runtime_error("Error saving fields in the background");
+}
+
 template<typename TF>
 void Fields<TF>::load(int n)
 {
@@ -958,12 +1059,80 @@ void Fields<TF>::load(int n)
     release_tmp(tmp1);
     release_tmp(tmp2);
 
+    update_prognostic_version();
+
     master.sum(&nerror, 1);
 
     if (nerror)
         throw std::runtime_error("Error loading fields");
 }
 
+template<typename TF>
+void Fields<TF>::save_restart(Timeloop<TF>& timeloop)
+{
+    auto tmp1 = get_tmp();
+    auto tmp2 = get_tmp();
+
+    char filename[256];
+    std::sprintf(filename, "%s.%07d", "restart", timeloop.get_iotime());
+    master.print_message("Saving \"%s\" ... ", filename);
+
+    std::vector<std::pair<std::string, TF*>> restart_fields;
+    for (auto& f : ap)
+        restart_fields.emplace_back(f.second->name, f.second->fld.data());
+
+    const Restart_state state = {timeloop.get_itime(), timeloop.get_idt(), timeloop.get_iteration()};
+
+    const int nerror = field3d_io.save_restart(
+            filename, restart_fields, state, tmp1->fld.data(), tmp2->fld.data());
+
+    release_tmp(tmp1);
+    release_tmp(tmp2);
+
+    if (nerror)
+    {
+        master.print_message("FAILED\n");
+        throw std::runtime_error("Error saving restart file");
+    }
+    else
+        master.print_message("OK\n");
+}
+
+template<typename TF>
+void Fields<TF>::load_restart(Timeloop<TF>& timeloop)
+{
+    auto tmp1 = get_tmp();
+    auto tmp2 = get_tmp();
+
+    char filename[256];
+    std::sprintf(filename, "%s.%07d", "restart", timeloop.get_iotime());
+    master.print_message("Loading \"%s\" ... ", filename);
+
+    std::vector<std::pair<std::string, TF*>> restart_fields;
+    for (auto& f : ap)
+        restart_fields.emplace_back(f.second->name, f.second->fld.data());
+
+    Restart_state state;
+
+    const int nerror = field3d_io.load_restart(
+            filename, restart_fields, state, tmp1->fld.data(), tmp2->fld.data());
+
+    release_tmp(tmp1);
+    release_tmp(tmp2);
+
+    if (nerror)
+    {
+        master.print_message("FAILED\n");
+        throw std::runtime_error("Error loading restart file");
+    }
+    else
+        master.print_message("OK\n");
+
+    timeloop.set_restart_state(state.itime, state.idt, state.iteration);
+
+    update_prognostic_version();
+}
+
 #ifndef USECUDA
 template<typename TF>
 TF Fields<TF>::check_momentum()
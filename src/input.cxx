@@ -229,6 +229,53 @@ namespace
     }
 }
 
+bool Input::peek_switch(const std::string& file_name, const std::string& blockname, const std::string& itemname)
+{
+    std::ifstream infile(file_name);
+    std::string blockname_line;
+    std::string line;
+
+    while (std::getline(infile, line))
+    {
+        // Strip of the comments and the whitespace.
+        line = line.substr(0, line.find('#'));
+        boost::trim(line);
+
+        if (line.empty())
+            continue;
+
+        if (line.front() == '[' && line.back() == ']')
+        {
+            blockname_line = line.substr(1, line.size()-2);
+            continue;
+        }
+
+        std::vector<std::string> strings;
+        boost::split(strings, line, boost::is_any_of("="));
+
+        if (strings.size() != 2 || blockname_line != blockname)
+            continue;
+
+        boost::trim(strings[0]);
+        boost::trim(strings[1]);
+
+        // The errors in the file are reported when it is read by the constructor.
+        if (strings[0] == itemname)
+        {
+            try
+            {
+                return convert_value_to_item<bool>(strings[1]);
+            }
+            catch (std::runtime_error&)
+            {
+                return false;
+            }
+        }
+    }
+
+    return false;
+}
+
 template<typename T>
 T Input::get_item(const std::string& blockname,
                   const std::string& itemname,
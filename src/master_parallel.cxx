@@ -27,13 +27,20 @@
 #include "defines.h"
 #include "master.h"
 
-Master::Master()
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+Master::Master() :
+    profiler(*this)
 {
     initialized = false;
     allocated   = false;
+    nthreads    = 1;
 
     // set the mpiid, to ensure that errors can be written if MPI init fails
     md.mpiid = 0;
+    md.nodeid = 0;
 }
 
 Master::~Master()
@@ -41,6 +48,11 @@ Master::~Master()
     if (allocated)
     {
         delete[] reqs;
+
+        for (MPI_Win& win : node_windows)
+            MPI_Win_free(&win);
+
+        MPI_Comm_free(&md.commnode);
         MPI_Comm_free(&md.commxy);
         MPI_Comm_free(&md.commx);
         MPI_Comm_free(&md.commy);
@@ -52,10 +64,14 @@ Master::~Master()
         MPI_Finalize();
 }
 
-void Master::start()
+void Master::start(const bool thread_multiple)
 {
-    // initialize the MPI
-    int n = MPI_Init(NULL, NULL);
+    // Initialize the MPI. The time loop only communicates from the master thread of each process,
+    // but the background writers of the 3d fields (swasync) do MPI-IO on their own communicator,
+    // which needs the multiple thread level. As this level makes the MPI library lock on every call,
+    // it is only requested for runs with swasync, the others get the funneled level.
+    const int thread_required = thread_multiple ? MPI_THREAD_MULTIPLE : MPI_THREAD_FUNNELED;
+    int n = MPI_Init_thread(NULL, NULL, thread_required, &md.thread_level);
     if (check_error(n))
         throw std::runtime_error("MPI init error");
 
@@ -91,6 +107,17 @@ void Master::init(Input& input)
 
     wall_clock_end = wall_clock_start + 3600.*wall_clock_limit;
 
+    // Get the number of OpenMP threads per process, by default the value of OMP_NUM_THREADS.
+    #ifdef _OPENMP
+    nthreads = input.get_item<int>("master", "nthreads", "", omp_get_max_threads());
+    if (nthreads < 1)
+        throw std::runtime_error("nthreads has to be at least 1");
+    #else
+    nthreads = 1;
+    #endif
+
+    profiler.init(input);
+
     if (md.nprocs != md.npx*md.npy)
     {
         std::string msg = "nprocs = " + std::to_string(md.nprocs) + " does not equal npx*npy = " + std::to_string(md.npx) + "*" + std::to_string(md.npy);
@@ -150,6 +177,15 @@ void Master::init(Input& input)
     if (check_error(n))
         throw std::runtime_error("MPI init error");
 
+    // group the processes that can share memory
+    n = MPI_Comm_split_type(md.commxy, MPI_COMM_TYPE_SHARED, md.mpiid, MPI_INFO_NULL, &md.commnode);
+    if (check_error(n))
+        throw std::runtime_error("MPI init error");
+
+    n = MPI_Comm_rank(md.commnode, &md.nodeid);
+    if (check_error(n))
+        throw std::runtime_error("MPI init error");
+
     // create the requests arrays for the nonblocking sends
     int npmax;
     npmax = std::max(md.npx, md.npy);
@@ -167,6 +203,36 @@ double Master::get_wall_clock_time()
     return MPI_Wtime();
 }
 
+void* Master::allocate_node_shared(const size_t nbytes)
+{
+    // The node leader allocates all memory, the other processes get a pointer to it.
+    const MPI_Aint size = (md.nodeid == 0) ? nbytes : 0;
+
+    void* ptr;
+    MPI_Win win;
+    int n = MPI_Win_allocate_shared(size, 1, MPI_INFO_NULL, md.commnode, &ptr, &win);
+    if (check_error(n))
+        throw std::runtime_error("MPI shared memory allocation error");
+
+    if (md.nodeid != 0)
+    {
+        MPI_Aint size_leader;
+        int disp_unit;
+        n = MPI_Win_shared_query(win, 0, &size_leader, &disp_unit, &ptr);
+        if (check_error(n))
+            throw std::runtime_error("MPI shared memory allocation error");
+    }
+
+    node_windows.push_back(win);
+
+    return ptr;
+}
+
+void Master::node_barrier()
+{
+    MPI_Barrier(md.commnode);
+}
+
 int Master::check_error(int n)
 {
     char errbuffer[MPI_MAX_ERROR_STRING];
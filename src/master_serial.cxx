@@ -22,14 +22,21 @@
 
 #ifndef USEMPI
 #include <sys/time.h>
+#include <stdexcept>
 #include "grid.h"
 #include "defines.h"
 #include "master.h"
 
-Master::Master()
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+Master::Master() :
+    profiler(*this)
 {
     initialized = false;
     allocated   = false;
+    nthreads    = 1;
 }
 
 Master::~Master()
@@ -37,12 +44,13 @@ Master::~Master()
     print_message("Finished run on %d processes\n", md.nprocs);
 }
 
-void Master::start()
+void Master::start(const bool thread_multiple)
 {
     initialized = true;
 
     // Set the rank of the only process to 0.
     md.mpiid = 0;
+    md.nodeid = 0;
     // Set the number of processes to 1.
     md.nprocs = 1;
 
@@ -63,6 +71,17 @@ void Master::init(Input& input)
 
     wall_clock_end = wall_clock_start + 3600.*wall_clock_limit;
 
+    // Get the number of OpenMP threads per process, by default the value of OMP_NUM_THREADS.
+    #ifdef _OPENMP
+    nthreads = input.get_item<int>("master", "nthreads", "", omp_get_max_threads());
+    if (nthreads < 1)
+        throw std::runtime_error("nthreads has to be at least 1");
+    #else
+    nthreads = 1;
+    #endif
+
+    profiler.init(input);
+
     if (md.nprocs != md.npx*md.npy)
     {
         std::string msg = "npx*npy = " + std::to_string(md.npy) + "*" + std::to_string(md.npy) + " has to be equal to 1*1 in serial mode";
@@ -83,6 +102,14 @@ double Master::get_wall_clock_time()
     return (double)timestruct.tv_sec + (double)timestruct.tv_usec*1.e-6;
 }
 
+void* Master::allocate_node_shared(const size_t nbytes)
+{
+    node_buffers.emplace_back(nbytes);
+    return node_buffers.back().data();
+}
+
+void Master::node_barrier() {}
+
 // void Master::wait_all() {}
 
 // All broadcasts return directly, because there is nothing to broadcast.
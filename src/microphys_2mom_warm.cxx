@@ -51,6 +51,7 @@ namespace
                                 const int iend,   const int jend,   const int kend,
                                 const int jj,     const int kk)
     {
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -68,19 +69,57 @@ namespace
             field[n] = TF(0);
     }
 
+    // Find the columns of row j that contain rain or cloud water, and store their i-indices.
     template<typename TF>
-    TF* get_tmp_slice(std::vector<std::shared_ptr<Field3d<TF>>> &tmp_fields, int &slice_counter,
-                      const int jcells, const int ikcells)
+    int find_active_columns(int* const restrict active_i, int* const restrict is_active,
+                            const TF* const restrict qr, const TF* const restrict ql,
+                            const int istart, const int iend, const int kstart, const int kend,
+                            const int icells, const int ijcells, const int j)
     {
-        const int tmp_index   = slice_counter / jcells;     // Which tmp field in tmp_fields vector?
-        const int fld_index   = slice_counter % jcells;     // Which slice in tmp field?
-        const int slice_start = fld_index * ikcells;        // Start index of slice
+        for (int i=istart; i<iend; i++)
+            is_active[i] = 0;
+
+        for (int k=kstart; k<kend; k++)
+            #pragma ivdep
+            for (int i=istart; i<iend; i++)
+            {
+                const int ijk = i + j*icells + k*ijcells;
+                is_active[i] |= (qr[ijk] > qr_min<TF>) | (ql[ijk] > ql_min<TF>);
+            }
+
+        int ncol = 0;
+        for (int i=istart; i<iend; i++)
+            if (is_active[i])
+                active_i[ncol++] = i;
 
-        slice_counter++;
+        return ncol;
+    }
 
-        return &(tmp_fields[tmp_index]->fld[slice_start]);
+    // Gather levels kstart to kend of the active columns of row j into a slice with ncol points per level.
+    template<typename TF>
+    void pack_columns(TF* const restrict packed, const TF* const restrict field,
+                      const int* const restrict active_i, const int ncol,
+                      const int kstart, const int kend,
+                      const int icells, const int ijcells, const int j)
+    {
+        for (int k=kstart; k<kend; k++)
+            #pragma ivdep
+            for (int n=0; n<ncol; n++)
+                packed[n + k*ncol] = field[active_i[n] + j*icells + k*ijcells];
     }
 
+    // Scatter levels kstart to kend of a packed slice back to the active columns of row j.
+    template<typename TF>
+    void unpack_columns(TF* const restrict field, const TF* const restrict packed,
+                        const int* const restrict active_i, const int ncol,
+                        const int kstart, const int kend,
+                        const int icells, const int ijcells, const int j)
+    {
+        for (int k=kstart; k<kend; k++)
+            #pragma ivdep
+            for (int n=0; n<ncol; n++)
+                field[active_i[n] + j*icells + k*ijcells] = packed[n + k*ncol];
+    }
 }
 
 // Microphysics calculated over entire 3D field
@@ -101,6 +140,7 @@ namespace mp3d
         const TF nu_c   = 1;             // SB06, Table 1., same as UCLA-LES
         const TF kccxs  = k_cc / (TF(20.) * x_star) * (nu_c+2)*(nu_c+4) / pow(nu_c+1, 2);
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -135,6 +175,7 @@ namespace mp3d
     {
         const TF k_cr  = 5.25; // SB06, p49
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -172,6 +213,7 @@ namespace mp3d
         const TF b_R = a_R * exp(c_R*Dv); // UCLA-LES
 
         // Calculate sedimentation velocity at cell centre
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -362,21 +404,16 @@ namespace mp2d
             }
     }
 
-    // Sedimentation from Stevens and Seifert (2008)
+    // Sedimentation velocity and CFL number of qr and nr, as used by the Stevens and Seifert (2008) scheme
     template<typename TF>
-    void sedimentation_ss08(TF* const restrict qrt, TF* const restrict nrt, TF* const restrict rr_bot,
-                            TF* const restrict w_qr, TF* const restrict w_nr,
-                            TF* const restrict c_qr, TF* const restrict c_nr,
-                            TF* const restrict slope_qr, TF* const restrict slope_nr,
-                            TF* const restrict flux_qr, TF* const restrict flux_nr,
-                            const TF* const restrict mu_r, const TF* const restrict lambda_r,
-                            const TF* const restrict qr, const TF* const restrict nr,
-                            const TF* const restrict rho, const TF* const restrict rhoh,
-                            const TF* const restrict dzi,
-                            const TF* const restrict dz, const double dt,
-                            const int istart, const int jstart, const int kstart,
-                            const int iend,   const int jend,   const int kend,
-                            const int icells, const int kcells, const int ijcells, const int j)
+    void sedimentation_velocity_cfl(TF* const restrict w_qr, TF* const restrict w_nr,
+                                    TF* const restrict c_qr, TF* const restrict c_nr,
+                                    const TF* const restrict mu_r, const TF* const restrict lambda_r,
+                                    const TF* const restrict qr, const TF* const restrict rho,
+                                    const TF* const restrict dzi, const double dt,
+                                    const int istart, const int kstart,
+                                    const int iend,   const int kend,
+                                    const int icells, const int ijcells, const int j)
     {
         const TF w_max = 9.65; // 9.65=UCLA, 20=SS08, appendix A
         const TF a_R = 9.65;   // SB06, p51
@@ -384,7 +421,6 @@ namespace mp2d
         const TF Dv  = 25.0e-6;
         const TF b_R = a_R * exp(c_R*Dv); // UCLA-LES
 
-        const int kk3d = ijcells;
         const int kk2d = icells;
 
         // 1. Calculate sedimentation velocity at cell center
@@ -431,6 +467,24 @@ namespace mp2d
                 c_qr[ik] = TF(0.25) * (w_qr[ik-kk2d] + TF(2.)*w_qr[ik] + w_qr[ik+kk2d]) * dzi[k] * dt;
                 c_nr[ik] = TF(0.25) * (w_nr[ik-kk2d] + TF(2.)*w_nr[ik] + w_nr[ik+kk2d]) * dzi[k] * dt;
             }
+    }
+
+    // Sedimentation fluxes and tendencies of the Stevens and Seifert (2008) scheme,
+    // given the CFL numbers from sedimentation_velocity_cfl()
+    template<typename TF>
+    void sedimentation_ss08_fluxes(TF* const restrict qrt, TF* const restrict nrt, TF* const restrict rr_bot,
+                                   TF* const restrict slope_qr, TF* const restrict slope_nr,
+                                   TF* const restrict flux_qr, TF* const restrict flux_nr,
+                                   const TF* const restrict c_qr, const TF* const restrict c_nr,
+                                   const TF* const restrict qr, const TF* const restrict nr,
+                                   const TF* const restrict rho, const TF* const restrict dzi,
+                                   const TF* const restrict dz, const double dt,
+                                   const int istart, const int kstart,
+                                   const int iend,   const int kend,
+                                   const int icells, const int ijcells, const int j)
+    {
+        const int kk3d = ijcells;
+        const int kk2d = icells;
 
         // 3. Calculate slopes
         for (int k=kstart; k<kend; k++)
@@ -529,6 +583,145 @@ namespace mp2d
             rr_bot[ij] = -flux_qr[ik];
         }
     }
+
+    // Sedimentation from Stevens and Seifert (2008)
+    template<typename TF>
+    void sedimentation_ss08(TF* const restrict qrt, TF* const restrict nrt, TF* const restrict rr_bot,
+                            TF* const restrict w_qr, TF* const restrict w_nr,
+                            TF* const restrict c_qr, TF* const restrict c_nr,
+                            TF* const restrict slope_qr, TF* const restrict slope_nr,
+                            TF* const restrict flux_qr, TF* const restrict flux_nr,
+                            const TF* const restrict mu_r, const TF* const restrict lambda_r,
+                            const TF* const restrict qr, const TF* const restrict nr,
+                            const TF* const restrict rho, const TF* const restrict rhoh,
+                            const TF* const restrict dzi,
+                            const TF* const restrict dz, const double dt,
+                            const int istart, const int jstart, const int kstart,
+                            const int iend,   const int jend,   const int kend,
+                            const int icells, const int kcells, const int ijcells, const int j)
+    {
+        sedimentation_velocity_cfl(w_qr, w_nr, c_qr, c_nr, mu_r, lambda_r, qr, rho, dzi, dt,
+                                   istart, kstart, iend, kend, icells, ijcells, j);
+
+        sedimentation_ss08_fluxes(qrt, nrt, rr_bot, slope_qr, slope_nr, flux_qr, flux_nr, c_qr, c_nr,
+                                  qr, nr, rho, dzi, dz, dt, istart, kstart, iend, kend, icells, ijcells, j);
+    }
+
+    // Sedimentation from Stevens and Seifert (2008) with column-local sub-stepping. Columns in which the
+    // sedimentation CFL number exceeds cflmax are integrated in nsub = ceil(cfl/cflmax) sub-steps of dt/nsub,
+    // with the velocities recalculated from the updated rain each sub-step. The columns of the row with equal
+    // nsub are packed and processed together, and the tendency and surface rain rate are the means over the
+    // sub-steps. Rows without columns that need sub-stepping give the same result as sedimentation_ss08().
+    template<typename TF>
+    void sedimentation_ss08_substep(TF* const restrict qrt, TF* const restrict nrt, TF* const restrict rr_bot,
+                                    TF* const restrict w_qr, TF* const restrict w_nr,
+                                    TF* const restrict c_qr, TF* const restrict c_nr,
+                                    TF* const restrict slope_qr, TF* const restrict slope_nr,
+                                    TF* const restrict flux_qr, TF* const restrict flux_nr,
+                                    TF* const restrict rain_mass, TF* const restrict rain_diam,
+                                    TF* const restrict mu_r, TF* const restrict lambda_r,
+                                    TF* const restrict qr_s, TF* const restrict nr_s,
+                                    TF* const restrict qrt_s, TF* const restrict nrt_s,
+                                    TF* const restrict dqr_s, TF* const restrict dnr_s,
+                                    TF* const restrict rr_s, TF* const restrict rr_sum,
+                                    int* const restrict nsub, int* const restrict cols,
+                                    const TF* const restrict qr, const TF* const restrict nr,
+                                    const TF* const restrict rho, const TF* const restrict rhoh,
+                                    const TF* const restrict dzi,
+                                    const TF* const restrict dz, const double dt, const TF cflmax,
+                                    const int istart, const int jstart, const int kstart,
+                                    const int iend,   const int jend,   const int kend,
+                                    const int icells, const int kcells, const int ijcells, const int j)
+    {
+        sedimentation_velocity_cfl(w_qr, w_nr, c_qr, c_nr, mu_r, lambda_r, qr, rho, dzi, dt,
+                                   istart, kstart, iend, kend, icells, ijcells, j);
+
+        // Number of sub-steps per column from the maximum CFL number in the column.
+        for (int i=istart; i<iend; i++)
+            nsub[i] = 1;
+
+        for (int k=kstart; k<kend; k++)
+            for (int i=istart; i<iend; i++)
+            {
+                const int ik = i + k*icells;
+                const TF cfl = std::max(c_qr[ik], c_nr[ik]);
+                if (cfl > cflmax)
+                    nsub[i] = std::max(nsub[i], static_cast<int>(std::ceil(cfl / cflmax)));
+            }
+
+        int nsub_max = 1;
+        for (int i=istart; i<iend; i++)
+            nsub_max = std::max(nsub_max, nsub[i]);
+
+        if (nsub_max == 1)
+        {
+            sedimentation_ss08_fluxes(qrt, nrt, rr_bot, slope_qr, slope_nr, flux_qr, flux_nr, c_qr, c_nr,
+                                      qr, nr, rho, dzi, dz, dt, istart, kstart, iend, kend, icells, ijcells, j);
+            return;
+        }
+
+        // Process the groups of columns with equal nsub, nsub is set to zero once a column is done.
+        for (int i0=istart; i0<iend; i0++)
+        {
+            const int n_steps = nsub[i0];
+            if (n_steps == 0)
+                continue;
+
+            int ncol = 0;
+            for (int i=i0; i<iend; i++)
+                if (nsub[i] == n_steps)
+                {
+                    cols[ncol++] = i;
+                    nsub[i] = 0;
+                }
+
+            pack_columns(qr_s, qr, cols, ncol, 0, kcells, icells, ijcells, j);
+            pack_columns(nr_s, nr, cols, ncol, 0, kcells, icells, ijcells, j);
+            pack_columns(qrt_s, qrt, cols, ncol, kstart, kend, icells, ijcells, j);
+            pack_columns(nrt_s, nrt, cols, ncol, kstart, kend, icells, ijcells, j);
+
+            for (int n=0; n<ncol; n++)
+                rr_sum[n] = TF(0);
+
+            const double dt_sub = dt / n_steps;
+            const TF fac = TF(1) / n_steps;
+
+            for (int s=0; s<n_steps; s++)
+            {
+                // The packed columns are processed as a row of ncol points with ncol points per level.
+                prepare_microphysics_slice(rain_mass, rain_diam, mu_r, lambda_r, qr_s, nr_s, rho,
+                                           0, ncol, kstart, kend, ncol, ncol, 0);
+
+                zero_field(dqr_s, ncol*kcells);
+                zero_field(dnr_s, ncol*kcells);
+
+                sedimentation_ss08(dqr_s, dnr_s, rr_s,
+                                   w_qr, w_nr, c_qr, c_nr, slope_qr, slope_nr, flux_qr, flux_nr, mu_r, lambda_r,
+                                   qr_s, nr_s, rho, rhoh, dzi, dz, dt_sub,
+                                   0, 0, kstart, ncol, 1, kend, ncol, kcells, ncol, 0);
+
+                for (int k=kstart; k<kend; k++)
+                    #pragma ivdep
+                    for (int n=0; n<ncol; n++)
+                    {
+                        const int nk = n + k*ncol;
+                        qrt_s[nk] += fac * dqr_s[nk];
+                        nrt_s[nk] += fac * dnr_s[nk];
+                        qr_s[nk] = std::max(TF(0), qr_s[nk] + TF(dt_sub) * dqr_s[nk]);
+                        nr_s[nk] = std::max(TF(0), nr_s[nk] + TF(dt_sub) * dnr_s[nk]);
+                    }
+
+                for (int n=0; n<ncol; n++)
+                    rr_sum[n] += rr_s[n];
+            }
+
+            unpack_columns(qrt, qrt_s, cols, ncol, kstart, kend, icells, ijcells, j);
+            unpack_columns(nrt, nrt_s, cols, ncol, kstart, kend, icells, ijcells, j);
+
+            for (int n=0; n<ncol; n++)
+                rr_bot[cols[n] + j*icells] = fac * rr_sum[n];
+        }
+    }
 }
 
 template<typename TF>
@@ -542,6 +735,13 @@ Microphys_2mom_warm<TF>::Microphys_2mom_warm(Master& masterin, Grid<TF>& gridin,
     swmicrobudget = inputin.get_item<bool>("micro", "swmicrobudget", "", false);
     cflmax        = inputin.get_item<TF>("micro", "cflmax", "", 2.);
     Nc0<TF>       = inputin.get_item<TF>("micro", "Nc0", "", 70e6);
+    swactivecolumns = inputin.get_item<bool>("micro", "swactivecolumns", "", true);
+    swsedsubstep    = inputin.get_item<bool>("micro", "swsedsubstep", "", false);
+
+    #ifdef USECUDA
+    if (swsedsubstep)
+        throw std::runtime_error("swsedsubstep is not supported on the GPU");
+    #endif
 
     // Initialize the qr (rain water specific humidity) and nr (droplot number concentration) fields
     fields.init_prognostic_field("qr", "Rain water specific humidity", "kg kg-1", gd.sloc);
@@ -636,38 +836,62 @@ void Microphys_2mom_warm<TF>::exec(Thermo<TF>& thermo, const double dt, Stats<TF
     std::vector<TF> p     = thermo.get_p_vector();
     std::vector<TF> exner = thermo.get_exner_vector();
 
+    if (swactivecolumns)
+    {
+        exec_active_columns(ql->fld.data(), p, exner, dt);
+
+        fields.release_tmp(ql);
+
+        stats.calc_tend(*fields.st.at("thl"), tend_name);
+        stats.calc_tend(*fields.st.at("qt"),  tend_name);
+        stats.calc_tend(*fields.st.at("qr"),  tend_name);
+        stats.calc_tend(*fields.st.at("nr"),  tend_name);
+        return;
+    }
+
     // Microphysics is handled in XZ slices, to
-    // (1) limit the required number of tmp fields
+    // (1) limit the required scratch memory to one slice per variable
     // (2) re-use some expensive calculations used in multiple microphysics routines.
-    const int ikcells    = gd.icells * gd.kcells;                           // Size of XZ slice
-    const int n_slices   = 12;                                              // Number of XZ slices required
-    const int n_tmp_flds = std::ceil(static_cast<TF>(n_slices)/gd.jcells);  // Number of required tmp fields
+    const int n_slices = swsedsubstep ? 20 : 12; // Number of XZ slices required
 
-    // Load the required number of tmp fields:
-    std::vector<std::shared_ptr<Field3d<TF>>> tmp_fields;
-    for (int n=0; n<n_tmp_flds; ++n)
-        tmp_fields.push_back(fields.get_tmp());
+    // Take the slices from the scratch pool, they are returned when they go out of scope.
+    std::vector<Scratch_buffer<TF>> slices;
+    for (int n=0; n<n_slices; ++n)
+        slices.push_back(fields.get_tmp_xz());
 
-    // Get pointers to slices in tmp fields:
+    // Get pointers to the slices:
     int slice_counter = 0;
 
-    TF* w_qr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-    TF* w_nr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+    TF* w_qr = slices[slice_counter++].data();
+    TF* w_nr = slices[slice_counter++].data();
+
+    TF* c_qr = slices[slice_counter++].data();
+    TF* c_nr = slices[slice_counter++].data();
 
-    TF* c_qr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-    TF* c_nr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+    TF* slope_qr = slices[slice_counter++].data();
+    TF* slope_nr = slices[slice_counter++].data();
 
-    TF* slope_qr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-    TF* slope_nr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+    TF* flux_qr = slices[slice_counter++].data();
+    TF* flux_nr = slices[slice_counter++].data();
 
-    TF* flux_qr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-    TF* flux_nr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+    TF* rain_mass = slices[slice_counter++].data();
+    TF* rain_diam = slices[slice_counter++].data();
 
-    TF* rain_mass = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-    TF* rain_diam = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+    TF* lambda_r = slices[slice_counter++].data();
+    TF* mu_r     = slices[slice_counter++].data();
 
-    TF* lambda_r = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-    TF* mu_r     = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+    // Packed columns and tendencies of the sedimentation sub-stepping.
+    TF* qr_s   = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+    TF* nr_s   = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+    TF* qrt_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+    TF* nrt_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+    TF* dqr_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+    TF* dnr_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+    TF* rr_s   = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+    TF* rr_sum = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+
+    std::vector<int> nsub(swsedsubstep ? gd.icells : 0);
+    std::vector<int> cols(swsedsubstep ? gd.icells : 0);
 
     // ---------------------------------
     // Calculate microphysics tendencies
@@ -712,19 +936,26 @@ void Microphys_2mom_warm<TF>::exec(Thermo<TF>& thermo, const double dt, Stats<TF
                                      gd.icells, gd.ijcells, j);
 
         // Sedimentation; sub-grid sedimentation of rain
-        mp2d::sedimentation_ss08(fields.st.at("qr")->fld.data(), fields.st.at("nr")->fld.data(), rr_bot.data(),
-                                 w_qr, w_nr, c_qr, c_nr, slope_qr, slope_nr, flux_qr, flux_nr, mu_r, lambda_r,
-                                 fields.sp.at("qr")->fld.data(), fields.sp.at("nr")->fld.data(),
-                                 fields.rhoref.data(), fields.rhorefh.data(), gd.dzi.data(), gd.dz.data(), dt,
-                                 gd.istart, gd.jstart, gd.kstart,
-                                 gd.iend,   gd.jend,   gd.kend,
-                                 gd.icells, gd.kcells, gd.ijcells, j);
+        if (swsedsubstep)
+            mp2d::sedimentation_ss08_substep(fields.st.at("qr")->fld.data(), fields.st.at("nr")->fld.data(), rr_bot.data(),
+                                             w_qr, w_nr, c_qr, c_nr, slope_qr, slope_nr, flux_qr, flux_nr,
+                                             rain_mass, rain_diam, mu_r, lambda_r,
+                                             qr_s, nr_s, qrt_s, nrt_s, dqr_s, dnr_s, rr_s, rr_sum, nsub.data(), cols.data(),
+                                             fields.sp.at("qr")->fld.data(), fields.sp.at("nr")->fld.data(),
+                                             fields.rhoref.data(), fields.rhorefh.data(), gd.dzi.data(), gd.dz.data(), dt, cflmax,
+                                             gd.istart, gd.jstart, gd.kstart,
+                                             gd.iend,   gd.jend,   gd.kend,
+                                             gd.icells, gd.kcells, gd.ijcells, j);
+        else
+            mp2d::sedimentation_ss08(fields.st.at("qr")->fld.data(), fields.st.at("nr")->fld.data(), rr_bot.data(),
+                                     w_qr, w_nr, c_qr, c_nr, slope_qr, slope_nr, flux_qr, flux_nr, mu_r, lambda_r,
+                                     fields.sp.at("qr")->fld.data(), fields.sp.at("nr")->fld.data(),
+                                     fields.rhoref.data(), fields.rhorefh.data(), gd.dzi.data(), gd.dz.data(), dt,
+                                     gd.istart, gd.jstart, gd.kstart,
+                                     gd.iend,   gd.jend,   gd.kend,
+                                     gd.icells, gd.kcells, gd.ijcells, j);
     }
 
-    // Release all local tmp fields in use
-    for (auto& it: tmp_fields)
-        fields.release_tmp(it);
-
     fields.release_tmp(ql);
 
     stats.calc_tend(*fields.st.at("thl"), tend_name);
@@ -732,6 +963,153 @@ void Microphys_2mom_warm<TF>::exec(Thermo<TF>& thermo, const double dt, Stats<TF
     stats.calc_tend(*fields.st.at("qr"),  tend_name);
     stats.calc_tend(*fields.st.at("nr"),  tend_name);
 }
+
+// Run the microphysics only on the columns that contain rain or cloud water. The active columns of each
+// row are packed into XZ slices, on which the same kernels as in exec() are run, such that the results
+// are identical and the costs scale with the cloud and rain fraction instead of with the domain size.
+template<typename TF>
+void Microphys_2mom_warm<TF>::exec_active_columns(
+        const TF* const ql, const std::vector<TF>& p, const std::vector<TF>& exner, const double dt)
+{
+    auto& gd = grid.get_grid_data();
+
+    const TF* const qr  = fields.sp.at("qr")->fld.data();
+    const TF* const nr  = fields.sp.at("nr")->fld.data();
+    const TF* const qt  = fields.sp.at("qt")->fld.data();
+    const TF* const thl = fields.sp.at("thl")->fld.data();
+
+    TF* const qrt  = fields.st.at("qr")->fld.data();
+    TF* const nrt  = fields.st.at("nr")->fld.data();
+    TF* const qtt  = fields.st.at("qt")->fld.data();
+    TF* const thlt = fields.st.at("thl")->fld.data();
+
+    const TF* const rho  = fields.rhoref.data();
+    const TF* const rhoh = fields.rhorefh.data();
+
+    #pragma omp parallel
+    {
+        // Each thread takes its own slices from the scratch pool, they are returned when they go out of scope.
+        const int n_slices = swsedsubstep ? 30 : 22; // Number of XZ slices required
+        std::vector<Scratch_buffer<TF>> slices;
+        for (int n=0; n<n_slices; ++n)
+            slices.push_back(fields.get_tmp_xz());
+
+        int slice_counter = 0;
+
+        TF* w_qr = slices[slice_counter++].data();
+        TF* w_nr = slices[slice_counter++].data();
+
+        TF* c_qr = slices[slice_counter++].data();
+        TF* c_nr = slices[slice_counter++].data();
+
+        TF* slope_qr = slices[slice_counter++].data();
+        TF* slope_nr = slices[slice_counter++].data();
+
+        TF* flux_qr = slices[slice_counter++].data();
+        TF* flux_nr = slices[slice_counter++].data();
+
+        TF* rain_mass = slices[slice_counter++].data();
+        TF* rain_diam = slices[slice_counter++].data();
+
+        TF* lambda_r = slices[slice_counter++].data();
+        TF* mu_r     = slices[slice_counter++].data();
+
+        // Packed columns and tendencies of the sedimentation sub-stepping.
+        TF* qr_s   = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* nr_s   = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* qrt_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* nrt_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* dqr_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* dnr_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* rr_s   = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* rr_sum = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+
+        std::vector<int> nsub(swsedsubstep ? gd.icells : 0);
+        std::vector<int> cols(swsedsubstep ? gd.icells : 0);
+
+        // Packed fields and tendencies of the active columns of one row.
+        TF* qr_c  = slices[slice_counter++].data();
+        TF* nr_c  = slices[slice_counter++].data();
+        TF* ql_c  = slices[slice_counter++].data();
+        TF* qt_c  = slices[slice_counter++].data();
+        TF* thl_c = slices[slice_counter++].data();
+
+        TF* qrt_c  = slices[slice_counter++].data();
+        TF* nrt_c  = slices[slice_counter++].data();
+        TF* qtt_c  = slices[slice_counter++].data();
+        TF* thlt_c = slices[slice_counter++].data();
+
+        TF* rr_bot_c = slices[slice_counter++].data();
+
+        std::vector<int> active_i(gd.icells);
+        std::vector<int> is_active(gd.icells);
+
+        #pragma omp for schedule(dynamic)
+        for (int j=gd.jstart; j<gd.jend; ++j)
+        {
+            const int ncol = find_active_columns(
+                    active_i.data(), is_active.data(), qr, ql,
+                    gd.istart, gd.iend, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+
+            for (int i=gd.istart; i<gd.iend; ++i)
+                rr_bot[i + j*gd.icells] = TF(0);
+
+            if (ncol == 0)
+                continue;
+
+            // The sedimentation needs the ghost cells of qr and nr.
+            pack_columns(qr_c, qr, active_i.data(), ncol, 0, gd.kcells, gd.icells, gd.ijcells, j);
+            pack_columns(nr_c, nr, active_i.data(), ncol, 0, gd.kcells, gd.icells, gd.ijcells, j);
+
+            pack_columns(ql_c,  ql,  active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+            pack_columns(qt_c,  qt,  active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+            pack_columns(thl_c, thl, active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+
+            pack_columns(qrt_c,  qrt,  active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+            pack_columns(nrt_c,  nrt,  active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+            pack_columns(qtt_c,  qtt,  active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+            pack_columns(thlt_c, thlt, active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+
+            // The packed slice is processed as a row of ncol points with ncol points per level.
+            mp3d::autoconversion(qrt_c, nrt_c, qtt_c, thlt_c, qr_c, ql_c, rho, exner.data(), Nc0<TF>,
+                                 0, 0, gd.kstart, ncol, 1, gd.kend, ncol, ncol);
+
+            mp3d::accretion(qrt_c, qtt_c, thlt_c, qr_c, ql_c, rho, exner.data(),
+                            0, 0, gd.kstart, ncol, 1, gd.kend, ncol, ncol);
+
+            mp2d::prepare_microphysics_slice(rain_mass, rain_diam, mu_r, lambda_r, qr_c, nr_c, rho,
+                                             0, ncol, gd.kstart, gd.kend, ncol, ncol, 0);
+
+            mp2d::evaporation(qrt_c, nrt_c, qtt_c, thlt_c, qr_c, nr_c, ql_c, qt_c, thl_c,
+                              rho, exner.data(), p.data(), rain_mass, rain_diam,
+                              0, 0, gd.kstart, ncol, 1, gd.kend, ncol, ncol, 0);
+
+            mp2d::selfcollection_breakup(nrt_c, qr_c, nr_c, rho, rain_mass, rain_diam, lambda_r,
+                                         0, 0, gd.kstart, ncol, 1, gd.kend, ncol, ncol, 0);
+
+            if (swsedsubstep)
+                mp2d::sedimentation_ss08_substep(qrt_c, nrt_c, rr_bot_c,
+                                                 w_qr, w_nr, c_qr, c_nr, slope_qr, slope_nr, flux_qr, flux_nr,
+                                                 rain_mass, rain_diam, mu_r, lambda_r,
+                                                 qr_s, nr_s, qrt_s, nrt_s, dqr_s, dnr_s, rr_s, rr_sum, nsub.data(), cols.data(),
+                                                 qr_c, nr_c, rho, rhoh, gd.dzi.data(), gd.dz.data(), dt, cflmax,
+                                                 0, 0, gd.kstart, ncol, 1, gd.kend, ncol, gd.kcells, ncol, 0);
+            else
+                mp2d::sedimentation_ss08(qrt_c, nrt_c, rr_bot_c,
+                                         w_qr, w_nr, c_qr, c_nr, slope_qr, slope_nr, flux_qr, flux_nr, mu_r, lambda_r,
+                                         qr_c, nr_c, rho, rhoh, gd.dzi.data(), gd.dz.data(), dt,
+                                         0, 0, gd.kstart, ncol, 1, gd.kend, ncol, gd.kcells, ncol, 0);
+
+            unpack_columns(qrt,  qrt_c,  active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+            unpack_columns(nrt,  nrt_c,  active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+            unpack_columns(qtt,  qtt_c,  active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+            unpack_columns(thlt, thlt_c, active_i.data(), ncol, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
+
+            for (int n=0; n<ncol; ++n)
+                rr_bot[active_i[n] + j*gd.icells] = rr_bot_c[n];
+        }
+    }
+}
 #endif
 
 template<typename TF>
@@ -760,37 +1138,48 @@ void Microphys_2mom_warm<TF>::exec_stats(Stats<TF>& stats, Thermo<TF>& thermo, c
         std::vector<TF> exner = thermo.get_exner_vector();
 
         // Microphysics is (partially) handled in XZ slices, to
-        // (1) limit the required number of tmp fields
+        // (1) limit the required scratch memory to one slice per variable
         // (2) re-use some expensive calculations used in multiple microphysics routines.
-        const int ikcells    = gd.icells * gd.kcells;                           // Size of XZ slice
-        const int n_slices   = 12;                                              // Number of XZ slices required
-        const int n_tmp_flds = std::ceil(static_cast<TF>(n_slices)/gd.jcells);  // Number of required tmp fields
+        const int n_slices = swsedsubstep ? 20 : 12; // Number of XZ slices required
 
-        // Load the required number of tmp fields:
-        std::vector<std::shared_ptr<Field3d<TF>>> tmp_fields;
-        for (int n=0; n<n_tmp_flds; ++n)
-            tmp_fields.push_back(fields.get_tmp());
+        // Take the slices from the scratch pool, they are returned when they go out of scope.
+        std::vector<Scratch_buffer<TF>> slices;
+        for (int n=0; n<n_slices; ++n)
+            slices.push_back(fields.get_tmp_xz());
 
-        // Get pointers to slices in tmp fields:
+        // Get pointers to the slices:
         int slice_counter = 0;
 
-        TF* w_qr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-        TF* w_nr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+        TF* w_qr = slices[slice_counter++].data();
+        TF* w_nr = slices[slice_counter++].data();
+
+        TF* c_qr = slices[slice_counter++].data();
+        TF* c_nr = slices[slice_counter++].data();
 
-        TF* c_qr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-        TF* c_nr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+        TF* slope_qr = slices[slice_counter++].data();
+        TF* slope_nr = slices[slice_counter++].data();
 
-        TF* slope_qr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-        TF* slope_nr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+        TF* flux_qr = slices[slice_counter++].data();
+        TF* flux_nr = slices[slice_counter++].data();
 
-        TF* flux_qr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-        TF* flux_nr = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+        TF* rain_mass = slices[slice_counter++].data();
+        TF* rain_diam = slices[slice_counter++].data();
 
-        TF* rain_mass = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-        TF* rain_diam = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+        TF* lambda_r = slices[slice_counter++].data();
+        TF* mu_r     = slices[slice_counter++].data();
 
-        TF* lambda_r = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
-        TF* mu_r     = get_tmp_slice<TF>(tmp_fields, slice_counter, gd.jcells, ikcells);
+        // Packed columns and tendencies of the sedimentation sub-stepping.
+        TF* qr_s   = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* nr_s   = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* qrt_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* nrt_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* dqr_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* dnr_s  = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* rr_s   = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+        TF* rr_sum = swsedsubstep ? slices[slice_counter++].data() : nullptr;
+
+        std::vector<int> nsub(swsedsubstep ? gd.icells : 0);
+        std::vector<int> cols(swsedsubstep ? gd.icells : 0);
 
         // Get 4 tmp fields for all tendencies (qrt, nrt, thlt, qtt) :-(
         auto qrt  = fields.get_tmp();
@@ -895,22 +1284,29 @@ void Microphys_2mom_warm<TF>::exec_stats(Stats<TF>& stats, Thermo<TF>& thermo, c
                                              fields.sp.at("qr")->fld.data(), fields.sp.at("nr")->fld.data(), fields.rhoref.data(),
                                              gd.istart, gd.iend, gd.kstart, gd.kend, gd.icells, gd.ijcells, j);
 
-            mp2d::sedimentation_ss08(qrt->fld.data(), nrt->fld.data(), rr_bot.data(),
-                                     w_qr, w_nr, c_qr, c_nr, slope_qr, slope_nr, flux_qr, flux_nr, mu_r, lambda_r,
-                                     fields.sp.at("qr")->fld.data(), fields.sp.at("nr")->fld.data(),
-                                     fields.rhoref.data(), fields.rhorefh.data(), gd.dzi.data(), gd.dz.data(), dt,
-                                     gd.istart, gd.jstart, gd.kstart,
-                                     gd.iend,   gd.jend,   gd.kend,
-                                     gd.icells, gd.kcells, gd.ijcells, j);
+            if (swsedsubstep)
+                mp2d::sedimentation_ss08_substep(qrt->fld.data(), nrt->fld.data(), rr_bot.data(),
+                                                 w_qr, w_nr, c_qr, c_nr, slope_qr, slope_nr, flux_qr, flux_nr,
+                                                 rain_mass, rain_diam, mu_r, lambda_r,
+                                                 qr_s, nr_s, qrt_s, nrt_s, dqr_s, dnr_s, rr_s, rr_sum, nsub.data(), cols.data(),
+                                                 fields.sp.at("qr")->fld.data(), fields.sp.at("nr")->fld.data(),
+                                                 fields.rhoref.data(), fields.rhorefh.data(), gd.dzi.data(), gd.dz.data(), dt, cflmax,
+                                                 gd.istart, gd.jstart, gd.kstart,
+                                                 gd.iend,   gd.jend,   gd.kend,
+                                                 gd.icells, gd.kcells, gd.ijcells, j);
+            else
+                mp2d::sedimentation_ss08(qrt->fld.data(), nrt->fld.data(), rr_bot.data(),
+                                         w_qr, w_nr, c_qr, c_nr, slope_qr, slope_nr, flux_qr, flux_nr, mu_r, lambda_r,
+                                         fields.sp.at("qr")->fld.data(), fields.sp.at("nr")->fld.data(),
+                                         fields.rhoref.data(), fields.rhorefh.data(), gd.dzi.data(), gd.dz.data(), dt,
+                                         gd.istart, gd.jstart, gd.kstart,
+                                         gd.iend,   gd.jend,   gd.kend,
+                                         gd.icells, gd.kcells, gd.ijcells, j);
         }
 
         stats.calc_stats("sed_qrt" , *qrt , no_offset, no_threshold);
         stats.calc_stats("sed_nrt" , *nrt , no_offset, no_threshold);
 
-        // Release all local tmp fields in use
-        for (auto& it: tmp_fields)
-            fields.release_tmp(it);
-
         fields.release_tmp(ql  );
         fields.release_tmp(qrt );
         fields.release_tmp(nrt );
@@ -936,6 +1332,10 @@ void Microphys_2mom_warm<TF>::exec_cross(Cross<TF>& cross, unsigned long iotime)
 template<typename TF>
 unsigned long Microphys_2mom_warm<TF>::get_time_limit(unsigned long idt, const double dt)
 {
+    // With sub-stepping, the sedimentation takes as many steps as it needs per column.
+    if (swsedsubstep)
+        return Constants::ulhuge;
+
     auto& gd = grid.get_grid_data();
 
     // Calculate the maximum sedimentation CFL number
@@ -118,6 +118,72 @@ namespace
     using namespace Thermo_moist_functions;
     using namespace Fast_math;
     using Micro_2mom_warm_functions::minmod;
+    using namespace Nsw6_lookup;
+
+    template<typename TF>
+    using Slope_table = Lookup_table<TF, n_slope_powers>;
+
+    template<typename TF>
+    using Temperature_table = Lookup_table<TF, n_temperature_factors>;
+
+    // Powers of the slope parameter lambda (Tomita Eq. 27) of a species at mass content rho_q,
+    // with lambda_fac = a * N_0 * gamma(b+1). Without all, only the powers that are also used
+    // in the absence of the species are calculated.
+    template<typename TF>
+    inline void calc_slope_powers(
+            TF* const restrict pw, const TF rho_q, const TF lambda_fac,
+            const TF b, const TF d, const bool all)
+    {
+        pw[lambda_1] = std::pow(lambda_fac / rho_q, TF(1.) / (b + TF(1.)));
+        pw[lambda_vent] = std::pow(pw[lambda_1], TF(0.5) * (TF(5.) + d));
+
+        if (all)
+        {
+            pw[lambda_md] = std::pow(pw[lambda_1], -d);
+            pw[lambda_3d] = std::pow(pw[lambda_1], TF(3.) + d);
+            pw[lambda_6d] = std::pow(pw[lambda_1], TF(6.) + d);
+            pw[lambda_b1] = std::pow(pw[lambda_1], b + TF(1.));
+            pw[lambda_b2] = std::pow(pw[lambda_1], b + TF(2.));
+            pw[lambda_b3] = std::pow(pw[lambda_1], b + TF(3.));
+        }
+    }
+
+    // Slope parameter powers from the lookup table if available, otherwise calculated.
+    template<typename TF>
+    inline void get_slope_powers(
+            TF* const restrict pw, const TF rho_q, const TF lambda_fac,
+            const TF b, const TF d, const bool all,
+            const Slope_table<TF>* const lut)
+    {
+        if (lut)
+            lut->get(pw, std::log(rho_q));
+        else
+            calc_slope_powers(pw, rho_q, lambda_fac, b, d, all);
+    }
+
+    // Temperature dependent factors of the process rates.
+    template<typename TF>
+    inline void calc_temperature_factors(TF* const restrict tf, const TF T)
+    {
+        // Tomita Eq. 39, 49, 53 and 54
+        tf[exp_sacr] = std::exp(gamma_sacr<TF> * (T - T0<TF>));
+        tf[exp_gacs] = std::exp(gamma_gacs<TF> * (T - T0<TF>));
+        tf[exp_saut] = std::exp(gamma_saut<TF> * (T - T0<TF>));
+        tf[exp_gaut] = std::exp(gamma_gaut<TF> * (T - T0<TF>));
+
+        tf[esat_l] = esat_liq(T);
+        tf[esat_i] = esat_ice(T);
+
+        // Tomita Eq. 57
+        tf[g_liq] = TF(1.) / (
+            Lv<TF> / (K_a<TF> * T) * (Lv<TF> / (Rv<TF> * T) - TF(1.))
+            + Rv<TF>*T / (K_d<TF> * tf[esat_l]) );
+
+        // Tomita Eq. 62
+        tf[g_ice] = TF(1.) / (
+            Ls<TF> / (K_a<TF> * T) * (Ls<TF> / (Rv<TF> * T) - TF(1.))
+            + Rv<TF>*T / (K_d<TF> * tf[esat_i]) );
+    }
 
     // Compute all microphysical tendencies.
     template<typename TF>
@@ -130,6 +196,8 @@ namespace
             const TF* const restrict rho, const TF* const restrict exner, const TF* const restrict p,
             const TF* const restrict dzi, const TF* const restrict dzhi,
             const TF N_d, const TF dt,
+            const Slope_table<TF>* const lut_r, const Slope_table<TF>* const lut_s,
+            const Slope_table<TF>* const lut_g, const Temperature_table<TF>* const lut_T,
             const int istart, const int jstart, const int kstart,
             const int iend, const int jend, const int kend,
             const int jj, const int kk)
@@ -137,6 +205,11 @@ namespace
         // Tomita Eq. 51. N_d is converted from SI units (m-3 instead of cm-3).
         const TF D_d = TF(0.146) - TF(5.964e-2)*std::log((N_d*TF(1.e-6)) / TF(2.e3));
 
+        // Part of Tomita Eq. 27
+        const TF lambda_fac_r = a_r<TF> * N_0r<TF> * std::tgamma(b_r<TF> + TF(1.));
+        const TF lambda_fac_s = a_s<TF> * N_0s<TF> * std::tgamma(b_s<TF> + TF(1.));
+        const TF lambda_fac_g = a_g<TF> * N_0g<TF> * std::tgamma(b_g<TF> + TF(1.));
+
         for (int k=kstart; k<kend; ++k)
         {
             const TF rho0_rho_sqrt = std::sqrt(rho[kstart]/rho[k]);
@@ -208,42 +281,47 @@ namespace
                     if (! (has_liq || has_ice || has_rain || has_snow || has_graupel) )
                         continue;
 
-                    // Tomita Eq. 27
-                    const TF lambda_r = std::pow(
-                            a_r<TF> * N_0r<TF> * std::tgamma(b_r<TF> + TF(1.))
-                            / (rho[k] * (qr[ijk] + q_tiny<TF>)),
-                            TF(1.) / (b_r<TF> + TF(1.)) );
+                    // Tomita Eq. 27. The powers of the slope parameter of rain are only used where
+                    // there is rain, those of snow and graupel also in the deposition terms.
+                    TF pw_r[n_slope_powers] = {};
+                    TF pw_s[n_slope_powers] = {};
+                    TF pw_g[n_slope_powers] = {};
 
-                    const TF lambda_s = std::pow(
-                            a_s<TF> * N_0s<TF> * std::tgamma(b_s<TF> + TF(1.))
-                            / (rho[k] * (qs[ijk] + q_tiny<TF>)),
-                            TF(1.) / (b_s<TF> + TF(1.)) );
+                    if (has_rain)
+                        get_slope_powers(pw_r, rho[k] * (qr[ijk] + q_tiny<TF>), lambda_fac_r, b_r<TF>, d_r<TF>, true, lut_r);
+                    get_slope_powers(pw_s, rho[k] * (qs[ijk] + q_tiny<TF>), lambda_fac_s, b_s<TF>, d_s<TF>, has_snow, lut_s);
+                    get_slope_powers(pw_g, rho[k] * (qg[ijk] + q_tiny<TF>), lambda_fac_g, b_g<TF>, d_g<TF>, has_graupel, lut_g);
 
-                    const TF lambda_g = std::pow(
-                            a_g<TF> * N_0g<TF> * std::tgamma(b_g<TF> + TF(1.))
-                            / (rho[k] * (qg[ijk] + q_tiny<TF>)),
-                            TF(1.) / (b_g<TF> + TF(1.)) );
+                    const TF lambda_r = pw_r[lambda_1];
+                    const TF lambda_s = pw_s[lambda_1];
+                    const TF lambda_g = pw_g[lambda_1];
+
+                    TF tf[n_temperature_factors];
+                    if (lut_T)
+                        lut_T->get(tf, T);
+                    else
+                        calc_temperature_factors(tf, T);
 
                     // Tomita Eq. 28
                     const TF V_Tr = !(has_rain) ? TF(0.) :
                         c_r<TF> * rho0_rho_sqrt
                         * std::tgamma(b_r<TF> + d_r<TF> + TF(1.)) / std::tgamma(b_r<TF> + TF(1.))
-                        * std::pow(lambda_r, -d_r<TF>);
+                        * pw_r[lambda_md];
 
                     const TF V_Ts = !(has_snow) ? TF(0.) :
                         c_s<TF> * rho0_rho_sqrt
                         * std::tgamma(b_s<TF> + d_s<TF> + TF(1.)) / std::tgamma(b_s<TF> + TF(1.))
-                        * std::pow(lambda_s, -d_s<TF>);
+                        * pw_s[lambda_md];
 
                     const TF V_Tg = !(has_graupel) ? TF(0.) :
                         c_g<TF> * rho0_rho_sqrt
                         * std::tgamma(b_g<TF> + d_g<TF> + TF(1.)) / std::tgamma(b_g<TF> + TF(1.))
-                        * std::pow(lambda_g, -d_g<TF>);
+                        * pw_g[lambda_md];
 
                     // ACCRETION
                     // Tomita Eq. 29
                     const TF P_iacr = !(has_rain && has_ice) ? TF(0.) :
-                        fac_iacr / std::pow(lambda_r, TF(6.) + d_r<TF>) * qi[ijk];
+                        fac_iacr / pw_r[lambda_6d] * qi[ijk];
 
                     // Tomita Eq. 30
                     const TF delta_1 = TF(qr[ijk] >= TF(1.e-4));
@@ -254,7 +332,7 @@ namespace
 
                     // Tomita Eq. 32
                     const TF P_raci = !(has_rain && has_ice) ? TF(0.) :
-                        fac_raci / std::pow(lambda_r, TF(3.) + d_r<TF>) * qi[ijk];
+                        fac_raci / pw_r[lambda_3d] * qi[ijk];
 
                     // Tomita Eq. 33
                     TF P_raci_s = (TF(1.) - delta_1) * P_raci;
@@ -262,20 +340,20 @@ namespace
 
                     // Tomita Eq. 34, 35
                     TF P_racw = !(has_liq && has_rain) ? TF(0.) :
-                        fac_racw / std::pow(lambda_r, TF(3.) + d_r<TF>) * ql[ijk];
+                        fac_racw / pw_r[lambda_3d] * ql[ijk];
                     TF P_sacw = !(has_liq && has_snow) ? TF(0.) :
-                        fac_sacw / std::pow(lambda_s, TF(3.) + d_s<TF>) * ql[ijk];
+                        fac_sacw / pw_s[lambda_3d] * ql[ijk];
 
                     // Tomita Eq. 39
-                    const TF E_si = std::exp(gamma_sacr<TF> * (T - T0<TF>));
+                    const TF E_si = tf[exp_sacr];
 
                     // Tomita Eq. 36 - 38
                     TF P_saci = !(has_snow && has_ice) ? TF(0.) :
-                        fac_saci * E_si / std::pow(lambda_s, TF(3.) + d_s<TF>) * qi[ijk];
+                        fac_saci * E_si / pw_s[lambda_3d] * qi[ijk];
                     TF P_gacw = !(has_graupel && has_liq) ? TF(0.) :
-                        fac_gacw / std::pow(lambda_g, TF(3.) + d_g<TF>) * ql[ijk];
+                        fac_gacw / pw_g[lambda_3d] * ql[ijk];
                     TF P_gaci = !(has_graupel && has_ice) ? TF(0.) :
-                        fac_gaci / std::pow(lambda_g, TF(3.) + d_g<TF>) * qi[ijk];
+                        fac_gaci / pw_g[lambda_3d] * qi[ijk];
 
                     // Accretion of falling hydrometeors.
                     // Tomita Eq. 42
@@ -285,47 +363,47 @@ namespace
                     TF P_racs = !(has_rain && has_snow) ? TF(0.) :
                         (TF(1.) - delta_2)
                         * pi<TF> * a_s<TF> * std::abs(V_Tr - V_Ts) * E_sr<TF> * N_0s<TF> * N_0r<TF> / (TF(4.)*rho[k])
-                        * (          std::tgamma(b_s<TF> + TF(3.)) * std::tgamma(TF(1.)) / ( std::pow(lambda_s, b_s<TF> + TF(3.)) * lambda_r )
-                          + TF(2.) * std::tgamma(b_s<TF> + TF(2.)) * std::tgamma(TF(2.)) / ( std::pow(lambda_s, b_s<TF> + TF(2.)) * pow2(lambda_r) )
-                          +          std::tgamma(b_s<TF> + TF(1.)) * std::tgamma(TF(3.)) / ( std::pow(lambda_s, b_s<TF> + TF(1.)) * pow3(lambda_r) ) );
+                        * (          std::tgamma(b_s<TF> + TF(3.)) * std::tgamma(TF(1.)) / ( pw_s[lambda_b3] * lambda_r )
+                          + TF(2.) * std::tgamma(b_s<TF> + TF(2.)) * std::tgamma(TF(2.)) / ( pw_s[lambda_b2] * pow2(lambda_r) )
+                          +          std::tgamma(b_s<TF> + TF(1.)) * std::tgamma(TF(3.)) / ( pw_s[lambda_b1] * pow3(lambda_r) ) );
 
                     // Tomita Eq. 44
                     const TF P_sacr = !(has_snow && has_rain) ? TF(0.) :
                           pi<TF> * a_r<TF> * std::abs(V_Ts - V_Tr) * E_sr<TF> * N_0r<TF> * N_0s<TF> / (TF(4.)*rho[k])
-                        * (          std::tgamma(b_r<TF> + TF(1.)) * std::tgamma(TF(3.)) / ( std::pow(lambda_r, b_r<TF> + TF(1.)) * pow3(lambda_s) )
-                          + TF(2.) * std::tgamma(b_r<TF> + TF(2.)) * std::tgamma(TF(2.)) / ( std::pow(lambda_r, b_r<TF> + TF(2.)) * pow2(lambda_s) )
-                          +          std::tgamma(b_r<TF> + TF(3.)) * std::tgamma(TF(1.)) / ( std::pow(lambda_r, b_r<TF> + TF(3.)) * lambda_s ) );
+                        * (          std::tgamma(b_r<TF> + TF(1.)) * std::tgamma(TF(3.)) / ( pw_r[lambda_b1] * pow3(lambda_s) )
+                          + TF(2.) * std::tgamma(b_r<TF> + TF(2.)) * std::tgamma(TF(2.)) / ( pw_r[lambda_b2] * pow2(lambda_s) )
+                          +          std::tgamma(b_r<TF> + TF(3.)) * std::tgamma(TF(1.)) / ( pw_r[lambda_b3] * lambda_s ) );
 
                     // Tomita Eq. 43
                     TF P_sacr_g = (TF(1.) - delta_2) * P_sacr;
                     TF P_sacr_s = delta_2 * P_sacr;
 
                     // Tomita Eq. 49
-                    const TF E_gs = std::min( TF(1.), std::exp(gamma_gacs<TF> * (T - T0<TF>)) );
+                    const TF E_gs = std::min( TF(1.), tf[exp_gacs] );
 
                     // Tomita Eq. 47
                     TF P_gacr = !(has_graupel && has_rain) ? TF(0.) :
                           pi<TF> * a_r<TF> * std::abs(V_Tg - V_Tr) * E_gr<TF> * N_0g<TF> * N_0r<TF> / (TF(4.)*rho[k])
-                        * (          std::tgamma(b_r<TF> + TF(1.)) * std::tgamma(TF(3.)) / ( std::pow(lambda_r, b_r<TF> + TF(1.)) * pow3(lambda_g) )
-                          + TF(2.) * std::tgamma(b_r<TF> + TF(2.)) * std::tgamma(TF(2.)) / ( std::pow(lambda_r, b_r<TF> + TF(2.)) * pow2(lambda_g) )
-                          +          std::tgamma(b_r<TF> + TF(3.)) * std::tgamma(TF(1.)) / ( std::pow(lambda_r, b_r<TF> + TF(3.)) * lambda_g ) );
+                        * (          std::tgamma(b_r<TF> + TF(1.)) * std::tgamma(TF(3.)) / ( pw_r[lambda_b1] * pow3(lambda_g) )
+                          + TF(2.) * std::tgamma(b_r<TF> + TF(2.)) * std::tgamma(TF(2.)) / ( pw_r[lambda_b2] * pow2(lambda_g) )
+                          +          std::tgamma(b_r<TF> + TF(3.)) * std::tgamma(TF(1.)) / ( pw_r[lambda_b3] * lambda_g ) );
 
                     // Tomita Eq. 48
                     TF P_gacs = !(has_graupel && has_snow) ? TF(0.) :
                           pi<TF> * a_s<TF> * std::abs(V_Tg - V_Ts) * E_gs * N_0g<TF> * N_0s<TF> / (TF(4.)*rho[k])
-                        * (          std::tgamma(b_s<TF> + TF(1.)) * std::tgamma(TF(3.)) / ( std::pow(lambda_s, b_s<TF> + TF(1.)) * pow3(lambda_g) )
-                          + TF(2.) * std::tgamma(b_s<TF> + TF(2.)) * std::tgamma(TF(2.)) / ( std::pow(lambda_s, b_s<TF> + TF(2.)) * pow2(lambda_g) )
-                          +          std::tgamma(b_s<TF> + TF(3.)) * std::tgamma(TF(1.)) / ( std::pow(lambda_s, b_s<TF> + TF(3.)) * lambda_g ) );
+                        * (          std::tgamma(b_s<TF> + TF(1.)) * std::tgamma(TF(3.)) / ( pw_s[lambda_b1] * pow3(lambda_g) )
+                          + TF(2.) * std::tgamma(b_s<TF> + TF(2.)) * std::tgamma(TF(2.)) / ( pw_s[lambda_b2] * pow2(lambda_g) )
+                          +          std::tgamma(b_s<TF> + TF(3.)) * std::tgamma(TF(1.)) / ( pw_s[lambda_b3] * lambda_g ) );
 
                     // AUTOCONVERSION.
                     constexpr TF q_icrt = TF(0.);
                     constexpr TF q_scrt = TF(6.e-4);
 
                     // Tomita Eq. 53
-                    const TF beta_1 = std::min( beta_saut<TF>, beta_saut<TF>*std::exp(gamma_saut<TF> * (T - T0<TF>)) );
+                    const TF beta_1 = std::min( beta_saut<TF>, beta_saut<TF>*tf[exp_saut] );
 
                     // Tomita Eq. 54
-                    const TF beta_2 = std::min( beta_gaut<TF>, beta_gaut<TF>*std::exp(gamma_gaut<TF> * (T - T0<TF>)) );
+                    const TF beta_2 = std::min( beta_gaut<TF>, beta_gaut<TF>*tf[exp_gaut] );
 
                     // Tomita Eq. 50. Our N_d is SI units, so conversion is applied.
                     TF P_raut = !(has_liq) ? TF(0.) :
@@ -359,17 +437,13 @@ namespace
 
                     // PHASE CHANGES.
                     // Tomita Eq. 57
-                    const TF G_w = TF(1.) / (
-                        Lv<TF> / (K_a<TF> * T) * (Lv<TF> / (Rv<TF> * T) - TF(1.))
-                        + Rv<TF>*T / (K_d<TF> * esat_liq(T)) );
+                    const TF G_w = tf[g_liq];
 
                     // Tomita Eq. 62
-                    const TF G_i = TF(1.) / (
-                        Ls<TF> / (K_a<TF> * T) * (Ls<TF> / (Rv<TF> * T) - TF(1.))
-                        + Rv<TF>*T / (K_d<TF> * esat_ice(T)) );
+                    const TF G_i = tf[g_ice];
 
-                    const TF S_w = (qt[ijk] - ql[ijk] - qi[ijk]) / qsat_liq(p[k], T);
-                    const TF S_i = (qt[ijk] - ql[ijk] - qi[ijk]) / qsat_ice(p[k], T);
+                    const TF S_w = (qt[ijk] - ql[ijk] - qi[ijk]) / (ep<TF>*tf[esat_l]/(p[k]-(TF(1.)-ep<TF>)*tf[esat_l]));
+                    const TF S_i = (qt[ijk] - ql[ijk] - qi[ijk]) / (ep<TF>*tf[esat_i]/(p[k]-(TF(1.)-ep<TF>)*tf[esat_i]));
 
                     // Tomita Eq. 63
                     const TF delta_3 = TF(S_i <= TF(1.)); // Subsaturated, then delta_3 = 1.
@@ -380,7 +454,7 @@ namespace
                         * ( f_1r<TF> * std::tgamma(TF(2.)) / pow2(lambda_r)
                           + f_2r<TF> * std::sqrt(c_r<TF> * rho0_rho_sqrt / nu<TF>)
                           * std::tgamma( TF(0.5) * (TF(5.) + d_r<TF>) )
-                          / std::pow(lambda_r, TF(0.5) * (TF(5.) + d_r<TF>)) );
+                          / pw_r[lambda_vent] );
 
                     // Tomita Eq. 60. Negative for sublimation, positive for deposition.
                     const TF P_sdep_ssub = 
@@ -388,7 +462,7 @@ namespace
                         * ( f_1s<TF> * std::tgamma(TF(2.)) / pow2(lambda_s)
                           + f_2s<TF> * std::sqrt(c_s<TF> * rho0_rho_sqrt / nu<TF>)
                           * std::tgamma( TF(0.5) * (TF(5.) + d_s<TF>) )
-                          / std::pow(lambda_s, TF(0.5) * (TF(5.) + d_s<TF>)) );
+                          / pw_s[lambda_vent] );
 
                     // Tomita Eq. 51
                     const TF P_gdep_gsub = 
@@ -396,7 +470,7 @@ namespace
                         * ( f_1g<TF> * std::tgamma(TF(2.)) / pow2(lambda_g)
                           + f_2g<TF> * std::sqrt(c_g<TF> * rho0_rho_sqrt / nu<TF>)
                           * std::tgamma( TF(0.5) * (TF(5.) + d_g<TF>) )
-                          / std::pow(lambda_g, TF(0.5) * (TF(5.) + d_g<TF>)) );
+                          / pw_g[lambda_vent] );
 
                     // Tomita Eq. 64
                     TF P_sdep = !(has_vapor) ? TF(0.) :
@@ -418,7 +492,7 @@ namespace
                         * ( f_1s<TF> * std::tgamma(TF(2.)) / pow2(lambda_s)
                           + f_2s<TF> * std::sqrt(c_s<TF> * rho0_rho_sqrt / nu<TF>)
                           * std::tgamma( TF(0.5) * (TF(5.) + d_s<TF>) )
-                          / std::pow(lambda_s, TF(0.5) * (TF(5.) + d_s<TF>)) )
+                          / pw_s[lambda_vent] )
                         + C_l<TF> * (T - T0<TF>) / Lf<TF> * (P_sacw + P_sacr);
 
                     // Tomita Eq. 69
@@ -427,7 +501,7 @@ namespace
                         * ( f_1g<TF> * std::tgamma(TF(2.)) / pow2(lambda_g)
                           + f_2g<TF> * std::sqrt(c_g<TF> * rho0_rho_sqrt / nu<TF>)
                           * std::tgamma( TF(0.5) * (TF(5.) + d_g<TF>) )
-                          / std::pow(lambda_g, TF(0.5) * (TF(5.) + d_g<TF>)) )
+                          / pw_g[lambda_vent] )
                         + C_l<TF> * (T - T0<TF>) / Lf<TF> * (P_gacw + P_gacr);
 
                     // Tomita Eq. 70
@@ -671,6 +745,7 @@ namespace
         //     ( std::pow(m_i50, TF(1.) - a_2) - std::pow(m_i40, TF(1.) - a_2) )
         //     / (a_1 * (TF(1.) - a_2));
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -681,18 +756,16 @@ namespace
                 }
     }
 
-    // Sedimentation based on Stevens and Seifert (2008)
+    // Sedimentation velocity and CFL number as used by the Stevens and Seifert (2008) scheme.
     template<typename TF>
-    void sedimentation_ss08(
-            TF* const restrict qct, TF* const restrict rc_bot,
+    void sedimentation_velocity_cfl(
             TF* const restrict w_qc, TF* const restrict c_qc,
-            TF* const restrict slope_qc, TF* const restrict flux_qc,
             const TF* const restrict qc,
             const TF* const restrict rho,
-            const TF* const restrict dzi, const TF* const restrict dz,
+            const TF* const restrict dzi,
             const double dt,
             const TF a_c, const TF b_c, const TF c_c, const TF d_c, const TF N_0c,
-            const TF qc_min,
+            const TF qc_min, const Slope_table<TF>* const lut,
             const int istart, const int jstart, const int kstart,
             const int iend, const int jend, const int kend,
             const int jj, const int kk)
@@ -700,7 +773,13 @@ namespace
         constexpr TF V_Tmin = TF(0.1);
         constexpr TF V_Tmax = TF(10.);
 
+        // Part of Tomita Eq. 27 and 28
+        const TF lambda_fac = a_c * N_0c * std::tgamma(b_c + TF(1.));
+        const TF gamma_b1 = std::tgamma(b_c + TF(1.));
+        const TF gamma_bd1 = std::tgamma(b_c + d_c + TF(1.));
+
         // 1. Calculate sedimentation velocity at cell center
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
         {
             const TF rho0_rho_sqrt = std::sqrt(rho[kstart]/rho[k]);
@@ -713,15 +792,25 @@ namespace
 
                     if (qc[ijk] > qc_min)
                     {
-                        const TF lambda_c = std::pow(
-                            a_c * N_0c * std::tgamma(b_c + TF(1.))
-                            / (rho[k] * qc[ijk]),
-                            TF(1.) / (b_c + TF(1.)) );
+                        TF lambda_c_md;
+                        if (lut)
+                        {
+                            TF pw[n_slope_powers];
+                            lut->get(pw, std::log(rho[k] * qc[ijk]));
+                            lambda_c_md = pw[lambda_md];
+                        }
+                        else
+                        {
+                            const TF lambda_c = std::pow(
+                                lambda_fac / (rho[k] * qc[ijk]),
+                                TF(1.) / (b_c + TF(1.)) );
+                            lambda_c_md = std::pow(lambda_c, -d_c);
+                        }
 
                         TF V_T =
                             c_c * rho0_rho_sqrt
-                            * std::tgamma(b_c + d_c + TF(1.)) / std::tgamma(b_c + TF(1.))
-                            * std::pow(lambda_c, -d_c);
+                            * gamma_bd1 / gamma_b1
+                            * lambda_c_md;
 
                         // Constrain the terminal velocity between 0.1 and 10.
                         V_T = std::max(V_Tmin, std::min(V_T, V_Tmax));
@@ -744,6 +833,7 @@ namespace
             }
 
         // 2. Calculate CFL number using interpolated sedimentation velocity
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -752,8 +842,25 @@ namespace
                     const int ijk = i + j*jj + k*kk;
                     c_qc[ijk] = TF(0.25) * (w_qc[ijk-kk] + TF(2.)*w_qc[ijk] + w_qc[ijk+kk]) * dzi[k] * dt;
                 }
+    }
 
+    // Sedimentation fluxes and tendency of the Stevens and Seifert (2008) scheme,
+    // given the CFL numbers from sedimentation_velocity_cfl().
+    template<typename TF>
+    void sedimentation_ss08_fluxes(
+            TF* const restrict qct, TF* const restrict rc_bot,
+            TF* const restrict slope_qc, TF* const restrict flux_qc,
+            const TF* const restrict c_qc,
+            const TF* const restrict qc,
+            const TF* const restrict rho,
+            const TF* const restrict dzi, const TF* const restrict dz,
+            const double dt,
+            const int istart, const int jstart, const int kstart,
+            const int iend, const int jend, const int kend,
+            const int jj, const int kk)
+    {
         // 3. Calculate slopes
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -801,6 +908,7 @@ namespace
                 }
 
         // Calculate tendency
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -823,6 +931,153 @@ namespace
             }
     }
 
+    // Sedimentation based on Stevens and Seifert (2008)
+    template<typename TF>
+    void sedimentation_ss08(
+            TF* const restrict qct, TF* const restrict rc_bot,
+            TF* const restrict w_qc, TF* const restrict c_qc,
+            TF* const restrict slope_qc, TF* const restrict flux_qc,
+            const TF* const restrict qc,
+            const TF* const restrict rho,
+            const TF* const restrict dzi, const TF* const restrict dz,
+            const double dt,
+            const TF a_c, const TF b_c, const TF c_c, const TF d_c, const TF N_0c,
+            const TF qc_min, const Slope_table<TF>* const lut,
+            const int istart, const int jstart, const int kstart,
+            const int iend, const int jend, const int kend,
+            const int jj, const int kk)
+    {
+        sedimentation_velocity_cfl(
+                w_qc, c_qc, qc, rho, dzi, dt,
+                a_c, b_c, c_c, d_c, N_0c, qc_min, lut,
+                istart, jstart, kstart, iend, jend, kend, jj, kk);
+
+        sedimentation_ss08_fluxes(
+                qct, rc_bot, slope_qc, flux_qc, c_qc, qc, rho, dzi, dz, dt,
+                istart, jstart, kstart, iend, jend, kend, jj, kk);
+    }
+
+    // Sedimentation based on Stevens and Seifert (2008) with column-local sub-stepping. Columns in which
+    // the CFL number exceeds cfl_max take nsub = ceil(cfl/cfl_max) sub-steps of dt/nsub. The columns with
+    // equal nsub are packed and processed together, and the tendency and surface flux are the means over
+    // the sub-steps. Without columns that need sub-stepping, the result equals that of sedimentation_ss08().
+    template<typename TF>
+    void sedimentation_ss08_substep(
+            TF* const restrict qct, TF* const restrict rc_bot,
+            TF* const restrict w_qc, TF* const restrict c_qc,
+            TF* const restrict slope_qc, TF* const restrict flux_qc,
+            TF* const restrict qc_s, TF* const restrict qct_s, TF* const restrict dqc_s,
+            TF* const restrict rc_s, TF* const restrict rc_sum,
+            int* const restrict nsub, int* const restrict cols,
+            const TF* const restrict qc,
+            const TF* const restrict rho,
+            const TF* const restrict dzi, const TF* const restrict dz,
+            const double dt, const double cfl_max,
+            const TF a_c, const TF b_c, const TF c_c, const TF d_c, const TF N_0c,
+            const TF qc_min, const Slope_table<TF>* const lut,
+            const int istart, const int jstart, const int kstart,
+            const int iend, const int jend, const int kend,
+            const int kcells, const int jj, const int kk)
+    {
+        sedimentation_velocity_cfl(
+                w_qc, c_qc, qc, rho, dzi, dt,
+                a_c, b_c, c_c, d_c, N_0c, qc_min, lut,
+                istart, jstart, kstart, iend, jend, kend, jj, kk);
+
+        // Number of sub-steps per column from the maximum CFL number in the column.
+        int nsub_max = 1;
+
+        #pragma omp parallel for reduction(max:nsub_max)
+        for (int j=jstart; j<jend; ++j)
+            for (int i=istart; i<iend; ++i)
+            {
+                const int ij = i + j*jj;
+
+                TF cfl = TF(0.);
+                for (int k=kstart; k<kend; ++k)
+                    cfl = std::max(cfl, c_qc[ij + k*kk]);
+
+                nsub[ij] = (cfl > cfl_max) ? static_cast<int>(std::ceil(cfl / cfl_max)) : 1;
+                nsub_max = std::max(nsub_max, nsub[ij]);
+            }
+
+        if (nsub_max == 1)
+        {
+            sedimentation_ss08_fluxes(
+                    qct, rc_bot, slope_qc, flux_qc, c_qc, qc, rho, dzi, dz, dt,
+                    istart, jstart, kstart, iend, jend, kend, jj, kk);
+            return;
+        }
+
+        // Process the groups of columns with equal nsub, nsub is set to zero once a column is done.
+        for (int j0=jstart; j0<jend; ++j0)
+            for (int i0=istart; i0<iend; ++i0)
+            {
+                const int n_steps = nsub[i0 + j0*jj];
+                if (n_steps == 0)
+                    continue;
+
+                int ncol = 0;
+                for (int j=j0; j<jend; ++j)
+                    for (int i=istart; i<iend; ++i)
+                    {
+                        const int ij = i + j*jj;
+                        if (nsub[ij] == n_steps)
+                        {
+                            cols[ncol++] = ij;
+                            nsub[ij] = 0;
+                        }
+                    }
+
+                #pragma omp parallel for
+                for (int k=0; k<kcells; ++k)
+                    for (int n=0; n<ncol; ++n)
+                    {
+                        qc_s [n + k*ncol] = qc [cols[n] + k*kk];
+                        qct_s[n + k*ncol] = qct[cols[n] + k*kk];
+                    }
+
+                for (int n=0; n<ncol; ++n)
+                    rc_sum[n] = TF(0.);
+
+                const double dt_sub = dt / n_steps;
+                const TF fac = TF(1.) / n_steps;
+
+                for (int s=0; s<n_steps; ++s)
+                {
+                    for (int n=0; n<ncol*kcells; ++n)
+                        dqc_s[n] = TF(0.);
+
+                    // The packed columns are processed as a single row of ncol points.
+                    sedimentation_ss08(
+                            dqc_s, rc_s, w_qc, c_qc, slope_qc, flux_qc, qc_s, rho, dzi, dz, dt_sub,
+                            a_c, b_c, c_c, d_c, N_0c, qc_min, lut,
+                            0, 0, kstart, ncol, 1, kend, ncol, ncol);
+
+                    #pragma omp parallel for
+                    for (int k=kstart; k<kend; ++k)
+                        #pragma ivdep
+                        for (int n=0; n<ncol; ++n)
+                        {
+                            const int nk = n + k*ncol;
+                            qct_s[nk] += fac * dqc_s[nk];
+                            qc_s[nk] = std::max(TF(0.), qc_s[nk] + TF(dt_sub) * dqc_s[nk]);
+                        }
+
+                    for (int n=0; n<ncol; ++n)
+                        rc_sum[n] += rc_s[n];
+                }
+
+                #pragma omp parallel for
+                for (int k=kstart; k<kend; ++k)
+                    for (int n=0; n<ncol; ++n)
+                        qct[cols[n] + k*kk] = qct_s[n + k*ncol];
+
+                for (int n=0; n<ncol; ++n)
+                    rc_bot[cols[n]] = fac * rc_sum[n];
+            }
+    }
+
     // Sedimentation from Stevens and Seifert (2008)
     template<typename TF>
     TF calc_cfl_ss08(
@@ -832,7 +1087,7 @@ namespace
             const TF* const restrict dzi, const TF* const restrict dz,
             const double dt,
             const TF a_c, const TF b_c, const TF c_c, const TF d_c, const TF N_0c,
-            const TF qc_min,
+            const TF qc_min, const Slope_table<TF>* const lut,
             const int istart, const int jstart, const int kstart,
             const int iend, const int jend, const int kend,
             const int jj, const int kk)
@@ -842,7 +1097,13 @@ namespace
         constexpr TF V_Tmin = TF(0.1);
         constexpr TF V_Tmax = TF(10.);
 
+        // Part of Tomita Eq. 27 and 28
+        const TF lambda_fac = a_c * N_0c * std::tgamma(b_c + TF(1.));
+        const TF gamma_b1 = std::tgamma(b_c + TF(1.));
+        const TF gamma_bd1 = std::tgamma(b_c + d_c + TF(1.));
+
         // 1. Calculate sedimentation velocity at cell center
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
         {
             const TF rho0_rho_sqrt = std::sqrt(rho[kstart]/rho[k]);
@@ -855,15 +1116,25 @@ namespace
 
                     if (qc[ijk] > qc_min)
                     {
-                        const TF lambda_c = std::pow(
-                            a_c * N_0c * std::tgamma(b_c + TF(1.))
-                            / (rho[k] * qc[ijk]),
-                            TF(1.) / (b_c + TF(1.)) );
+                        TF lambda_c_md;
+                        if (lut)
+                        {
+                            TF pw[n_slope_powers];
+                            lut->get(pw, std::log(rho[k] * qc[ijk]));
+                            lambda_c_md = pw[lambda_md];
+                        }
+                        else
+                        {
+                            const TF lambda_c = std::pow(
+                                lambda_fac / (rho[k] * qc[ijk]),
+                                TF(1.) / (b_c + TF(1.)) );
+                            lambda_c_md = std::pow(lambda_c, -d_c);
+                        }
 
                         TF V_T =
                             c_c * rho0_rho_sqrt
-                            * std::tgamma(b_c + d_c + TF(1.)) / std::tgamma(b_c + TF(1.))
-                            * std::pow(lambda_c, -d_c);
+                            * gamma_bd1 / gamma_b1
+                            * lambda_c_md;
 
                         // Constrain the terminal velocity between 0.1 and 10.
                         V_T = std::max(V_Tmin, std::min(V_T, V_Tmax));
@@ -910,6 +1181,8 @@ Microphys_nsw6<TF>::Microphys_nsw6(Master& masterin, Grid<TF>& gridin, Fields<TF
     // Read microphysics switches and settings
     // swmicrobudget = inputin.get_item<bool>("micro", "swmicrobudget", "", false);
     cfl_max = inputin.get_item<TF>("micro", "cflmax", "", 1.2);
+    swsedsubstep = inputin.get_item<bool>("micro", "swsedsubstep", "", false);
+    swlookup = inputin.get_item<bool>("micro", "swlookup", "", false);
 
     N_d = inputin.get_item<TF>("micro", "Nd", "", 100.e6); // CvH: 50 cm-3 do we need conversion, or do we stick with Tomita?
 
@@ -937,6 +1210,35 @@ void Microphys_nsw6<TF>::init()
     rr_bot.resize(gd.ijcells);
     rs_bot.resize(gd.ijcells);
     rg_bot.resize(gd.ijcells);
+
+    if (swlookup)
+    {
+        // The powers of the slope parameter are tabulated as function of ln(rho*q), from below the
+        // minimum mass content of the species up to 1 kg m-3. The spacing of 0.01 keeps the relative
+        // interpolation error of the steepest power, lambda^(6+d) of rain, below 4e-5.
+        const TF ln_rho_q_min = std::log(TF(1.e-18));
+        const TF ln_rho_q_max = TF(0.);
+        const int n_rho_q = 4146;
+
+        auto init_slope_table = [&](Slope_table<TF>& lut, const TF a, const TF b, const TF d, const TF N_0)
+        {
+            const TF lambda_fac = a * N_0 * std::tgamma(b + TF(1.));
+            lut.init(ln_rho_q_min, ln_rho_q_max, n_rho_q, [&](TF* const values, const TF ln_rho_q)
+            {
+                calc_slope_powers(values, std::exp(ln_rho_q), lambda_fac, b, d, true);
+            });
+        };
+
+        init_slope_table(lut_rain,    a_r<TF>, b_r<TF>, d_r<TF>, N_0r<TF>);
+        init_slope_table(lut_snow,    a_s<TF>, b_s<TF>, d_s<TF>, N_0s<TF>);
+        init_slope_table(lut_graupel, a_g<TF>, b_g<TF>, d_g<TF>, N_0g<TF>);
+
+        // The temperature factors are tabulated with a spacing of 0.1 K.
+        lut_temperature.init(TF(150.), TF(350.), 2001, [](TF* const values, const TF T)
+        {
+            calc_temperature_factors(values, T);
+        });
+    }
 }
 
 template<typename TF>
@@ -983,6 +1285,12 @@ void Microphys_nsw6<TF>::exec(Thermo<TF>& thermo, const double dt, Stats<TF>& st
     const std::vector<TF>& p = thermo.get_p_vector();
     const std::vector<TF>& exner = thermo.get_exner_vector();
 
+    // Without the lookup tables, the kernels calculate all functions.
+    const Slope_table<TF>* const lut_r = swlookup ? &lut_rain : nullptr;
+    const Slope_table<TF>* const lut_s = swlookup ? &lut_snow : nullptr;
+    const Slope_table<TF>* const lut_g = swlookup ? &lut_graupel : nullptr;
+    const Temperature_table<TF>* const lut_T = swlookup ? &lut_temperature : nullptr;
+
     conversion(
             fields.st.at("qr")->fld.data(), fields.st.at("qs")->fld.data(), fields.st.at("qg")->fld.data(),
             fields.st.at("qt")->fld.data(), fields.st.at("thl")->fld.data(),
@@ -992,6 +1300,7 @@ void Microphys_nsw6<TF>::exec(Thermo<TF>& thermo, const double dt, Stats<TF>& st
             fields.rhoref.data(), exner.data(), p.data(),
             gd.dzi.data(), gd.dzhi.data(),
             this->N_d, TF(dt),
+            lut_r, lut_s, lut_g, lut_T,
             gd.istart, gd.jstart, gd.kstart,
             gd.iend, gd.jend, gd.kend,
             gd.icells, gd.ijcells);
@@ -1004,50 +1313,98 @@ void Microphys_nsw6<TF>::exec(Thermo<TF>& thermo, const double dt, Stats<TF>& st
     auto tmp3 = fields.get_tmp();
     auto tmp4 = fields.get_tmp();
 
-    // Falling rain.
-    sedimentation_ss08(
-            fields.st.at("qr")->fld.data(), rr_bot.data(),
-            tmp1->fld.data(), tmp2->fld.data(),
-            tmp3->fld.data(), tmp4->fld.data(),
-            fields.sp.at("qr")->fld.data(),
-            fields.rhoref.data(),
-            gd.dzi.data(), gd.dz.data(),
-            dt,
-            a_r<TF>, b_r<TF>, c_r<TF>, d_r<TF>, N_0r<TF>,
-            qr_min<TF>,
-            gd.istart, gd.jstart, gd.kstart,
-            gd.iend, gd.jend, gd.kend,
-            gd.icells, gd.ijcells);
-
-    // Falling snow.
-    sedimentation_ss08(
-            fields.st.at("qs")->fld.data(), rs_bot.data(),
-            tmp1->fld.data(), tmp2->fld.data(),
-            tmp3->fld.data(), tmp4->fld.data(),
-            fields.sp.at("qs")->fld.data(),
-            fields.rhoref.data(),
-            gd.dzi.data(), gd.dz.data(),
-            dt,
-            a_s<TF>, b_s<TF>, c_s<TF>, d_s<TF>, N_0s<TF>,
-            qs_min<TF>,
-            gd.istart, gd.jstart, gd.kstart,
-            gd.iend, gd.jend, gd.kend,
-            gd.icells, gd.ijcells);
-
-    // Falling graupel.
-    sedimentation_ss08(
-            fields.st.at("qg")->fld.data(), rg_bot.data(),
-            tmp1->fld.data(), tmp2->fld.data(),
-            tmp3->fld.data(), tmp4->fld.data(),
-            fields.sp.at("qg")->fld.data(),
-            fields.rhoref.data(),
-            gd.dzi.data(), gd.dz.data(),
-            dt,
-            a_g<TF>, b_g<TF>, c_g<TF>, d_g<TF>, N_0g<TF>,
-            qg_min<TF>,
-            gd.istart, gd.jstart, gd.kstart,
-            gd.iend, gd.jend, gd.kend,
-            gd.icells, gd.ijcells);
+    if (swsedsubstep)
+    {
+        auto qc_s  = fields.get_tmp();
+        auto qct_s = fields.get_tmp();
+        auto dqc_s = fields.get_tmp();
+
+        std::vector<TF> rc_s(gd.ijcells);
+        std::vector<TF> rc_sum(gd.ijcells);
+        std::vector<int> nsub(gd.ijcells);
+        std::vector<int> cols(gd.ijcells);
+
+        auto sedimentation = [&](
+                TF* const qct, TF* const rc_bot, const TF* const qc,
+                const TF a_c, const TF b_c, const TF c_c, const TF d_c, const TF N_0c, const TF qc_min,
+                const Slope_table<TF>* const lut)
+        {
+            sedimentation_ss08_substep(
+                    qct, rc_bot,
+                    tmp1->fld.data(), tmp2->fld.data(),
+                    tmp3->fld.data(), tmp4->fld.data(),
+                    qc_s->fld.data(), qct_s->fld.data(), dqc_s->fld.data(),
+                    rc_s.data(), rc_sum.data(), nsub.data(), cols.data(),
+                    qc,
+                    fields.rhoref.data(),
+                    gd.dzi.data(), gd.dz.data(),
+                    dt, this->cfl_max,
+                    a_c, b_c, c_c, d_c, N_0c,
+                    qc_min, lut,
+                    gd.istart, gd.jstart, gd.kstart,
+                    gd.iend, gd.jend, gd.kend,
+                    gd.kcells, gd.icells, gd.ijcells);
+        };
+
+        // Falling rain, snow and graupel.
+        sedimentation(fields.st.at("qr")->fld.data(), rr_bot.data(), fields.sp.at("qr")->fld.data(),
+                      a_r<TF>, b_r<TF>, c_r<TF>, d_r<TF>, N_0r<TF>, qr_min<TF>, lut_r);
+        sedimentation(fields.st.at("qs")->fld.data(), rs_bot.data(), fields.sp.at("qs")->fld.data(),
+                      a_s<TF>, b_s<TF>, c_s<TF>, d_s<TF>, N_0s<TF>, qs_min<TF>, lut_s);
+        sedimentation(fields.st.at("qg")->fld.data(), rg_bot.data(), fields.sp.at("qg")->fld.data(),
+                      a_g<TF>, b_g<TF>, c_g<TF>, d_g<TF>, N_0g<TF>, qg_min<TF>, lut_g);
+
+        fields.release_tmp(qc_s);
+        fields.release_tmp(qct_s);
+        fields.release_tmp(dqc_s);
+    }
+    else
+    {
+        // Falling rain.
+        sedimentation_ss08(
+                fields.st.at("qr")->fld.data(), rr_bot.data(),
+                tmp1->fld.data(), tmp2->fld.data(),
+                tmp3->fld.data(), tmp4->fld.data(),
+                fields.sp.at("qr")->fld.data(),
+                fields.rhoref.data(),
+                gd.dzi.data(), gd.dz.data(),
+                dt,
+                a_r<TF>, b_r<TF>, c_r<TF>, d_r<TF>, N_0r<TF>,
+                qr_min<TF>, lut_r,
+                gd.istart, gd.jstart, gd.kstart,
+                gd.iend, gd.jend, gd.kend,
+                gd.icells, gd.ijcells);
+
+        // Falling snow.
+        sedimentation_ss08(
+                fields.st.at("qs")->fld.data(), rs_bot.data(),
+                tmp1->fld.data(), tmp2->fld.data(),
+                tmp3->fld.data(), tmp4->fld.data(),
+                fields.sp.at("qs")->fld.data(),
+                fields.rhoref.data(),
+                gd.dzi.data(), gd.dz.data(),
+                dt,
+                a_s<TF>, b_s<TF>, c_s<TF>, d_s<TF>, N_0s<TF>,
+                qs_min<TF>, lut_s,
+                gd.istart, gd.jstart, gd.kstart,
+                gd.iend, gd.jend, gd.kend,
+                gd.icells, gd.ijcells);
+
+        // Falling graupel.
+        sedimentation_ss08(
+                fields.st.at("qg")->fld.data(), rg_bot.data(),
+                tmp1->fld.data(), tmp2->fld.data(),
+                tmp3->fld.data(), tmp4->fld.data(),
+                fields.sp.at("qg")->fld.data(),
+                fields.rhoref.data(),
+                gd.dzi.data(), gd.dz.data(),
+                dt,
+                a_g<TF>, b_g<TF>, c_g<TF>, d_g<TF>, N_0g<TF>,
+                qg_min<TF>, lut_g,
+                gd.istart, gd.jstart, gd.kstart,
+                gd.iend, gd.jend, gd.kend,
+                gd.icells, gd.ijcells);
+    }
 
     fields.release_tmp(tmp1);
     fields.release_tmp(tmp2);
@@ -1095,8 +1452,16 @@ void Microphys_nsw6<TF>::exec_cross(Cross<TF>& cross, unsigned long iotime)
 template<typename TF>
 unsigned long Microphys_nsw6<TF>::get_time_limit(unsigned long idt, const double dt)
 {
+    // With sub-stepping, the sedimentation takes as many steps as it needs per column.
+    if (swsedsubstep)
+        return Constants::ulhuge;
+
     auto& gd = grid.get_grid_data();
 
+    const Slope_table<TF>* const lut_r = swlookup ? &lut_rain : nullptr;
+    const Slope_table<TF>* const lut_s = swlookup ? &lut_snow : nullptr;
+    const Slope_table<TF>* const lut_g = swlookup ? &lut_graupel : nullptr;
+
     auto tmp = fields.get_tmp();
 
     double cfl = 0.;
@@ -1109,7 +1474,7 @@ unsigned long Microphys_nsw6<TF>::get_time_limit(unsigned long idt, const double
             gd.dzi.data(), gd.dz.data(),
             dt,
             a_r<TF>, b_r<TF>, c_r<TF>, d_r<TF>, N_0r<TF>,
-            qr_min<TF>,
+            qr_min<TF>, lut_r,
             gd.istart, gd.jstart, gd.kstart,
             gd.iend, gd.jend, gd.kend,
             gd.icells, gd.ijcells);
@@ -1123,7 +1488,7 @@ unsigned long Microphys_nsw6<TF>::get_time_limit(unsigned long idt, const double
             gd.dzi.data(), gd.dz.data(),
             dt,
             a_s<TF>, b_s<TF>, c_s<TF>, d_s<TF>, N_0s<TF>,
-            qs_min<TF>,
+            qs_min<TF>, lut_s,
             gd.istart, gd.jstart, gd.kstart,
             gd.iend, gd.jend, gd.kend,
             gd.icells, gd.ijcells);
@@ -1137,7 +1502,7 @@ unsigned long Microphys_nsw6<TF>::get_time_limit(unsigned long idt, const double
             gd.dzi.data(), gd.dz.data(),
             dt,
             a_g<TF>, b_g<TF>, c_g<TF>, d_g<TF>, N_0g<TF>,
-            qg_min<TF>,
+            qg_min<TF>, lut_g,
             gd.istart, gd.jstart, gd.kstart,
             gd.iend, gd.jend, gd.kend,
             gd.icells, gd.ijcells);
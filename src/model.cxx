@@ -112,7 +112,7 @@ Model<TF>::Model(Master& masterin, int argc, char *argv[]) :
         grid      = std::make_shared<Grid<TF>>(master, *input);
         fields    = std::make_shared<Fields<TF>>(master, *grid, *input);
         timeloop  = std::make_shared<Timeloop<TF>>(master, *grid, *fields, *input, sim_mode);
-        fft       = std::make_shared<FFT<TF>>(master, *grid);
+        fft       = std::make_shared<FFT<TF>>(master, *grid, *input);
 
         boundary  = Boundary<TF> ::factory(master, *grid, *fields, *input);
 
@@ -135,6 +135,27 @@ Model<TF>::Model(Master& masterin, int argc, char *argv[]) :
 
         // Parse the statistics masks
         add_statistics_masks();
+
+        // Fused tendencies, all processes are applied per tile before moving to the next one.
+        swfusedtend = input->get_item<bool>("master", "swfusedtend", "", false);
+        tile_jblock = input->get_item<int> ("master", "tilejblock" , "", 4);
+        tile_kblock = input->get_item<int> ("master", "tilekblock" , "", 8);
+
+        if (swfusedtend)
+        {
+            #ifdef USECUDA
+            throw std::runtime_error("swfusedtend is not available in the GPU version");
+            #endif
+
+            if (grid->get_spatial_order() != Grid_order::Second)
+                throw std::runtime_error("swfusedtend requires a second order grid");
+
+            if (!(advec->has_tile_exec() && diff->has_tile_exec() && thermo->has_tile_exec()))
+                throw std::runtime_error("swfusedtend requires swadvec=2, swdiff=smag2 and swthermo=moist, or disabled schemes");
+
+            if (tile_jblock < 1 || tile_kblock < 1)
+                throw std::runtime_error("tilejblock and tilekblock must be at least 1");
+        }
     }
     catch (std::exception& e)
     {
@@ -167,6 +188,12 @@ void Model<TF>::init()
     grid->init();
     fields->init(*dump, *cross);
 
+    if (swfusedtend)
+    {
+        auto& gd = grid->get_grid_data();
+        tiles = make_tiles(gd.jstart, gd.jend, gd.kstart, gd.kend, tile_jblock, tile_kblock);
+    }
+
     fft->init();
 
     boundary->init(*input, *thermo);
@@ -216,7 +243,12 @@ void Model<TF>::load()
     // First load the grid and time to make their information available.
     grid->load();
     fft->load();
-    timeloop->load(timeloop->get_iotime());
+
+    // A restart file contains the time and the fields, which are then loaded at once.
+    if (fields->get_switch_restart_file())
+        fields->load_restart(*timeloop);
+    else
+        timeloop->load(timeloop->get_iotime());
 
     // Initialize the statistics file to open the possiblity to add profiles in other routines
     stats->create(*timeloop, sim_name);
@@ -224,7 +256,8 @@ void Model<TF>::load()
     dump->create();
 
     // Load the fields, and create the field statistics
-    fields->load(timeloop->get_iotime());
+    if (!fields->get_switch_restart_file())
+        fields->load(timeloop->get_iotime());
     fields->create_stats(*stats);
     fields->create_column(*column);
 
@@ -259,8 +292,15 @@ void Model<TF>::save()
     // Save the initialized data to disk for the run mode.
     grid->save();
     fft->save();
-    fields->save(timeloop->get_iotime());
-    timeloop->save(timeloop->get_iotime());
+
+    if (fields->get_switch_restart_file())
+        fields->save_restart(*timeloop);
+    else
+    {
+        fields->save(timeloop->get_iotime());
+        fields->wait_save();
+        timeloop->save(timeloop->get_iotime());
+    }
 }
 
 template<typename TF>
@@ -303,11 +343,17 @@ void Model<TF>::exec()
         #endif
     #else
         #ifdef _OPENMP
-        omp_set_num_threads(1);
+        // The time loop runs on a single outer thread, such that the tasks for statistics and
+        // saving are executed in order. The kernels open their own parallel regions with nthreads.
+        omp_set_num_threads(master.get_nthreads());
         const int nthreads_out=1;
+        master.print_message("Running with %i OpenMP threads\n", master.get_nthreads());
         #endif
     #endif
 
+    // Time every stage of the time loop, in case profiling is enabled.
+    Profiler& profiler = master.get_profiler();
+
     #pragma omp parallel num_threads(nthreads_out)
     {
         #pragma omp master
@@ -321,36 +367,73 @@ void Model<TF>::exec()
                 // Calculate stat masks and begin tendency calculation, if necessary
                 setup_stats();
 
-                // Calculate the advection tendency.
-                boundary->set_ghost_cells_w(Boundary_w_type::Conservation_type);
-                advec->exec(*stats);
-                boundary->set_ghost_cells_w(Boundary_w_type::Normal_type);
+                // The tendencies per process are needed for the tendency statistics.
+                if (swfusedtend && !stats->is_doing_tendency())
+                {
+                    // Calculate the advection, diffusion and buoyancy tendencies per tile.
+                    Scoped_timer timer(profiler, "fused_tendencies");
+                    exec_fused_tendencies();
+                }
+                else
+                {
+                    // Calculate the advection tendency.
+                    {
+                        Scoped_timer timer(profiler, "advec");
+                        boundary->set_ghost_cells_w(Boundary_w_type::Conservation_type);
+                        advec->exec(*stats);
+                        boundary->set_ghost_cells_w(Boundary_w_type::Normal_type);
+                    }
 
-                // Calculate the diffusion tendency.
-                diff->exec(*stats);
+                    // Calculate the diffusion tendency.
+                    {
+                        Scoped_timer timer(profiler, "diff");
+                        diff->exec(*stats);
+                    }
 
-                // Calculate the thermodynamics and the buoyancy tendency.
-                thermo->exec(timeloop->get_sub_time_step(), *stats);
+                    // Calculate the thermodynamics and the buoyancy tendency.
+                    {
+                        Scoped_timer timer(profiler, "thermo");
+                        thermo->exec(timeloop->get_sub_time_step(), *stats);
+                    }
+                }
 
                 // Calculate the microphysics.
-                microphys->exec(*thermo, timeloop->get_dt(), *stats);
+                {
+                    Scoped_timer timer(profiler, "microphys");
+                    microphys->exec(*thermo, timeloop->get_dt(), *stats);
+                }
 
                 // Calculate the radiation fluxes and the related heating rate.
-                radiation->exec(*thermo, timeloop->get_time(), *timeloop, *stats);
+                {
+                    Scoped_timer timer(profiler, "radiation");
+                    radiation->exec(*thermo, timeloop->get_time(), *timeloop, *stats);
+                }
 
                 // Calculate the tendency due to damping in the buffer layer.
-                buffer->exec(*stats);
+                {
+                    Scoped_timer timer(profiler, "buffer");
+                    buffer->exec(*stats);
+                }
 
                 // Apply the scalar decay.
-                decay->exec(timeloop->get_sub_time_step(), *stats);
+                {
+                    Scoped_timer timer(profiler, "decay");
+                    decay->exec(timeloop->get_sub_time_step(), *stats);
+                }
 
                 // Apply the large scale forcings. Keep this one always right before the pressure.
-                force->exec(timeloop->get_sub_time_step(), *thermo, *stats); //adding thermo and time because of gcssrad
+                {
+                    Scoped_timer timer(profiler, "force");
+                    force->exec(timeloop->get_sub_time_step(), *thermo, *stats); //adding thermo and time because of gcssrad
+                }
 
                 // Solve the poisson equation for pressure.
-                boundary->set_ghost_cells_w(Boundary_w_type::Conservation_type);
-                pres->exec(timeloop->get_sub_time_step(), *stats);
-                boundary->set_ghost_cells_w(Boundary_w_type::Normal_type);
+                {
+                    Scoped_timer timer(profiler, "pres");
+                    boundary->set_ghost_cells_w(Boundary_w_type::Conservation_type);
+                    pres->exec(timeloop->get_sub_time_step(), *stats);
+                    boundary->set_ghost_cells_w(Boundary_w_type::Normal_type);
+                }
 
                 //Calculate the total tendency statistics, if necessary
                 for (auto& it: fields->at)
@@ -396,7 +479,10 @@ void Model<TF>::exec()
                 if (sim_mode == Sim_mode::Run)
                 {
                     // Integrate in time.
-                    timeloop->exec();
+                    {
+                        Scoped_timer timer(profiler, "timeloop");
+                        timeloop->exec();
+                    }
 
                     // Increase the time with the time step.
                     timeloop->step_time();
@@ -420,8 +506,14 @@ void Model<TF>::exec()
                         // Save data to disk.
                         #pragma omp task default(shared)
                         {
-                            timeloop->save(timeloop->get_iotime());
-                            fields  ->save(timeloop->get_iotime());
+                            Scoped_timer timer(profiler, "save");
+                            if (fields->get_switch_restart_file())
+                                fields->save_restart(*timeloop);
+                            else
+                            {
+                                timeloop->save(timeloop->get_iotime());
+                                fields  ->save(timeloop->get_iotime());
+                            }
                         }
                     }
                 }
@@ -437,8 +529,13 @@ void Model<TF>::exec()
                         break;
 
                     // Load the data from disk.
-                    timeloop->load(timeloop->get_iotime());
-                    fields  ->load(timeloop->get_iotime());
+                    if (fields->get_switch_restart_file())
+                        fields->load_restart(*timeloop);
+                    else
+                    {
+                        timeloop->load(timeloop->get_iotime());
+                        fields  ->load(timeloop->get_iotime());
+                    }
                 }
 
                 // Update the time dependent parameters.
@@ -447,13 +544,19 @@ void Model<TF>::exec()
                 force   ->update_time_dependent(*timeloop);
 
                 // Set the boundary conditions.
-                boundary->exec(*thermo);
+                {
+                    Scoped_timer timer(profiler, "boundary");
+                    boundary->exec(*thermo);
+                }
 
                 // Calculate the field means, in case needed.
                 fields->exec();
 
                 // Get the viscosity to be used in diffusion.
-                diff->exec_viscosity(*thermo);
+                {
+                    Scoped_timer timer(profiler, "viscosity");
+                    diff->exec_viscosity(*thermo);
+                }
 
                 // Write status information to disk.
                 print_status();
@@ -462,6 +565,12 @@ void Model<TF>::exec()
         } // End OpenMP master region.
     } // End OpenMP parallel region.
 
+    // Wait for the files that are still being written in the background.
+    fields->wait_save();
+    dump  ->wait_save();
+
+    profiler.write(sim_name);
+
     #ifdef USECUDA
     // At the end of the run, copy the data back from the GPU.
     fields  ->backward_device();
@@ -511,9 +620,13 @@ void Model<TF>::clear_gpu()
 template<typename TF>
 void Model<TF>::calculate_statistics(int iteration, double time, unsigned long itime, int iotime, double dt)
 {
+    Profiler& profiler = master.get_profiler();
+
     // Do the statistics.
     if (stats->do_statistics(itime))
     {
+        Scoped_timer timer(profiler, "stats");
+
         // Calculate statistics
         if (!stats->do_tendency())
             calc_masks();
@@ -530,6 +643,8 @@ void Model<TF>::calculate_statistics(int iteration, double time, unsigned long i
     // Save the selected cross sections to disk, cross sections are handled on CPU.
     if (cross->do_cross(itime))
     {
+        Scoped_timer timer(profiler, "cross");
+
         fields   ->exec_cross(*cross, iotime);
         thermo   ->exec_cross(*cross, iotime);
         microphys->exec_cross(*cross, iotime);
@@ -540,6 +655,8 @@ void Model<TF>::calculate_statistics(int iteration, double time, unsigned long i
     // Save the 3d dumps to disk.
     if (dump->do_dump(itime))
     {
+        Scoped_timer timer(profiler, "dump");
+
         fields   ->exec_dump(*dump, iotime);
         thermo   ->exec_dump(*dump, iotime);
         microphys->exec_dump(*dump, iotime);
@@ -547,13 +664,37 @@ void Model<TF>::calculate_statistics(int iteration, double time, unsigned long i
     }
 
     // Handle the routines that share computations between stats, cross, and dump.
-    radiation->exec_all_stats(
-            *stats, *cross, *dump,
-            *thermo, *timeloop,
-            itime, iotime);
+    {
+        Scoped_timer timer(profiler, "radiation_stats");
+        radiation->exec_all_stats(
+                *stats, *cross, *dump,
+                *thermo, *timeloop,
+                itime, iotime);
+    }
 
     if (stats->do_statistics(itime))
+    {
+        Scoped_timer timer(profiler, "stats");
         stats->exec(iteration, time, itime);
+    }
+}
+
+// Apply advection, diffusion and buoyancy on one tile before moving to the next one, such that
+// the tendencies and the fields they depend on are read from cache instead of from memory.
+// Each point gets its contributions in the same order as in the unfused processes.
+template<typename TF>
+void Model<TF>::exec_fused_tendencies()
+{
+    thermo->prepare_tile_exec(timeloop->get_sub_time_step());
+
+    // The parallel regions inside the kernels are inactive within the loop over the tiles.
+    #pragma omp parallel for schedule(dynamic)
+    for (int n=0; n<static_cast<int>(tiles.size()); ++n)
+    {
+        advec ->exec_tile(tiles[n]);
+        diff  ->exec_tile(tiles[n]);
+        thermo->exec_tile(tiles[n]);
+    }
 }
 
 // Calculate the statistics for all classes that have a statistics function.
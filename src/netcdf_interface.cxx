@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <numeric>
@@ -8,6 +9,24 @@
 #include "netcdf_interface.h"
 #include "master.h"
 
+// Data that is inserted into a buffered file, but not yet written.
+struct Netcdf_write_buffer
+{
+    struct Record
+    {
+        int ncid;
+        int var_id;
+        nc_type type;
+        std::vector<size_t> start;
+        std::vector<size_t> count;
+        std::vector<char> values;
+    };
+
+    bool enabled = false;
+    int ntime_chunk = 1;
+    std::vector<Record> records;
+};
+
 namespace
 {
     void nc_throw(const int return_value)
@@ -113,6 +132,68 @@ namespace
     {
         return nc_put_vara_int(ncid, var_id, start.data(), count.data(), &value);
     }
+
+    template<typename T>
+    void buffer_record(
+            Netcdf_write_buffer& buffer, const int ncid, const int var_id,
+            const std::vector<size_t>& start, const std::vector<size_t>& count, const T* const values)
+    {
+        const size_t n = std::accumulate(count.begin(), count.end(), size_t(1), std::multiplies<>());
+        const char* const bytes = reinterpret_cast<const char*>(values);
+
+        buffer.records.push_back({ncid, var_id, netcdf_dtype<T>(), start, count, std::vector<char>(bytes, bytes + n*sizeof(T))});
+    }
+
+    // Write all buffered records and return the first error, such that it can be checked once.
+    int write_records(Netcdf_write_buffer& buffer)
+    {
+        int return_value = NC_NOERR;
+
+        for (const auto& r : buffer.records)
+        {
+            int record_value = NC_NOERR;
+
+            if (r.type == NC_DOUBLE)
+                record_value = nc_put_vara_double(r.ncid, r.var_id, r.start.data(), r.count.data(),
+                        reinterpret_cast<const double*>(r.values.data()));
+            else if (r.type == NC_FLOAT)
+                record_value = nc_put_vara_float(r.ncid, r.var_id, r.start.data(), r.count.data(),
+                        reinterpret_cast<const float*>(r.values.data()));
+            else if (r.type == NC_INT)
+                record_value = nc_put_vara_int(r.ncid, r.var_id, r.start.data(), r.count.data(),
+                        reinterpret_cast<const int*>(r.values.data()));
+
+            if (return_value == NC_NOERR)
+                return_value = record_value;
+        }
+
+        buffer.records.clear();
+
+        return return_value;
+    }
+
+    // Chunk a variable with an unlimited leftmost dimension by ntime_chunk records, instead of the
+    // single record per chunk that the time series get by default.
+    int def_time_chunking(const int ncid, const int var_id, const std::vector<int>& dim_ids, const int ntime_chunk)
+    {
+        if (dim_ids.empty())
+            return NC_NOERR;
+
+        std::vector<size_t> chunks(dim_ids.size());
+        for (size_t i=0; i<dim_ids.size(); ++i)
+        {
+            const int return_value = nc_inq_dimlen(ncid, dim_ids[i], &chunks[i]);
+            if (return_value != NC_NOERR)
+                return return_value;
+        }
+
+        // Only the unlimited dimension has zero length before the first record is written.
+        if (chunks[0] != 0 || std::find(chunks.begin()+1, chunks.end(), 0) != chunks.end())
+            return NC_NOERR;
+
+        chunks[0] = ntime_chunk;
+        return nc_def_var_chunking(ncid, var_id, NC_CHUNKED, chunks.data());
+    }
 }
 
 Netcdf_file::Netcdf_file(Master& master, const std::string& name, Netcdf_mode mode, const int mpiid_to_write_in) :
@@ -150,16 +231,35 @@ Netcdf_file::~Netcdf_file()
     int nc_check_code = 0;
 
     if (master.get_mpiid() == mpiid_to_write)
-        nc_check_code = nc_close(ncid);
+    {
+        nc_check_code = write_records(*write_buffer);
+        const int close_code = nc_close(ncid);
+        if (nc_check_code == NC_NOERR)
+            nc_check_code = close_code;
+    }
     nc_check(master, nc_check_code, mpiid_to_write);
 }
 
+void Netcdf_file::set_buffered(const int ntime_chunk)
+{
+    if (ntime_chunk < 1)
+        throw std::runtime_error("The number of records per chunk has to be at least 1");
+
+    write_buffer->enabled = true;
+    write_buffer->ntime_chunk = ntime_chunk;
+}
+
 void Netcdf_file::sync()
 {
     int nc_check_code = 0;
 
+    // The errors of the buffered records are only communicated here.
     if (master.get_mpiid() == mpiid_to_write)
-        nc_check_code = nc_sync(ncid);
+    {
+        nc_check_code = write_records(*write_buffer);
+        if (nc_check_code == NC_NOERR)
+            nc_check_code = nc_sync(ncid);
+    }
     nc_check(master, nc_check_code, mpiid_to_write);
 }
 
@@ -202,8 +302,12 @@ void Netcdf_handle::add_dimension(const std::string& dim_name, const int dim_siz
 template<typename T>
 Netcdf_variable<T> Netcdf_handle::add_variable(
         const std::string& var_name,
-        const std::vector<std::string>& dim_names)
+        const std::vector<std::string>& dim_names,
+        const std::vector<int>& chunk_sizes)
 {
+    if (!chunk_sizes.empty() && chunk_sizes.size() != dim_names.size())
+        throw std::runtime_error("The chunk sizes of variable " + var_name + " do not match its dimensions");
+
     int nc_check_code = 0;
 
     int var_id = -1;
@@ -224,7 +328,16 @@ Netcdf_variable<T> Netcdf_handle::add_variable(
     }
 
     if (master.get_mpiid() == mpiid_to_write)
+    {
         nc_check_code = nc_def_var(ncid, var_name.c_str(), netcdf_dtype<T>(), ndims, dim_ids.data(), &var_id);
+        if (nc_check_code == NC_NOERR && !chunk_sizes.empty())
+        {
+            const std::vector<size_t> chunks(chunk_sizes.begin(), chunk_sizes.end());
+            nc_check_code = nc_def_var_chunking(ncid, var_id, NC_CHUNKED, chunks.data());
+        }
+        else if (nc_check_code == NC_NOERR && write_buffer->enabled)
+            nc_check_code = def_time_chunking(ncid, var_id, dim_ids, write_buffer->ntime_chunk);
+    }
     nc_check(master, nc_check_code, mpiid_to_write);
 
     if (master.get_mpiid() == mpiid_to_write)
@@ -263,7 +376,7 @@ Netcdf_variable<T> Netcdf_handle::add_variable(
 }
 
 Netcdf_handle::Netcdf_handle(Master& master) :
-    master(master), record_counter(0)
+    master(master), record_counter(0), write_buffer(std::make_shared<Netcdf_write_buffer>())
 {}
 
 template<typename T>
@@ -276,6 +389,14 @@ void Netcdf_handle::insert(
     const std::vector<size_t> i_start_size_t (i_start.begin(), i_start.end());
     const std::vector<size_t> i_count_size_t (i_count.begin(), i_count.end());
 
+    // Buffered records are written without communication, their errors are checked in sync().
+    if (write_buffer->enabled)
+    {
+        if (master.get_mpiid() == mpiid_to_write)
+            buffer_record(*write_buffer, ncid, var_id, i_start_size_t, i_count_size_t, values.data());
+        return;
+    }
+
     int nc_check_code = 0;
 
     // CvH: Add proper size checking.
@@ -294,6 +415,13 @@ void Netcdf_handle::insert(
     const std::vector<size_t> i_start_size_t (i_start.begin(), i_start.end());
     const std::vector<size_t> i_count_size_t (i_count.begin(), i_count.end());
 
+    if (write_buffer->enabled)
+    {
+        if (master.get_mpiid() == mpiid_to_write)
+            buffer_record(*write_buffer, ncid, var_id, i_start_size_t, i_count_size_t, &value);
+        return;
+    }
+
     int nc_check_code = 0;
 
     // CvH: Add proper size checking.
@@ -385,7 +513,7 @@ Netcdf_group& Netcdf_handle::add_group(const std::string& name)
     groups.emplace(
             std::piecewise_construct,
             std::forward_as_tuple(name),
-            std::forward_as_tuple(master, this, group_ncid, root_ncid, mpiid_to_write));
+            std::forward_as_tuple(master, this, group_ncid, root_ncid, mpiid_to_write, write_buffer));
 
     return groups.at(name);
 }
@@ -405,7 +533,7 @@ Netcdf_group& Netcdf_handle::get_group(const std::string& name)
         groups.emplace(
                 std::piecewise_construct,
                 std::forward_as_tuple(name),
-                std::forward_as_tuple(master, this, group_ncid, root_ncid, mpiid_to_write));
+                std::forward_as_tuple(master, this, group_ncid, root_ncid, mpiid_to_write, write_buffer));
     }
 
     return groups.at(name);
@@ -619,13 +747,15 @@ void Netcdf_handle::get_variable(
 
 Netcdf_group::Netcdf_group(
         Master& master, Netcdf_handle* parent_in,
-        const int ncid_in, const int root_ncid_in, const int mpiid_to_write_in) :
+        const int ncid_in, const int root_ncid_in, const int mpiid_to_write_in,
+        std::shared_ptr<Netcdf_write_buffer> write_buffer_in) :
     Netcdf_handle(master)
 {
     parent = parent_in;
     mpiid_to_write = mpiid_to_write_in;
     ncid = ncid_in;
     root_ncid = root_ncid_in;
+    write_buffer = write_buffer_in;
 }
 
 int Netcdf_group::get_dim_id(const std::string& name)
@@ -708,6 +838,6 @@ template void Netcdf_handle::insert<double>(const double, const int, const std::
 template void Netcdf_handle::insert<float> (const float,  const int, const std::vector<int>&, const std::vector<int>&);
 template void Netcdf_handle::insert<int>   (const int,    const int, const std::vector<int>&, const std::vector<int>&);
 
-template Netcdf_variable<double> Netcdf_handle::add_variable<double> (const std::string&, const std::vector<std::string>&);
-template Netcdf_variable<float>  Netcdf_handle::add_variable<float>  (const std::string&, const std::vector<std::string>&);
-template Netcdf_variable<int>    Netcdf_handle::add_variable<int>    (const std::string&, const std::vector<std::string>&);
+template Netcdf_variable<double> Netcdf_handle::add_variable<double> (const std::string&, const std::vector<std::string>&, const std::vector<int>&);
+template Netcdf_variable<float>  Netcdf_handle::add_variable<float>  (const std::string&, const std::vector<std::string>&, const std::vector<int>&);
+template Netcdf_variable<int>    Netcdf_handle::add_variable<int>    (const std::string&, const std::vector<std::string>&, const std::vector<int>&);
@@ -76,13 +76,10 @@ void Pres_2<TF>::exec(const double dt, Stats<TF>& stats)
 
     // solve the system
     auto tmp1 = fields.get_tmp();
-    auto tmp2 = fields.get_tmp();
 
-    solve(fields.sd.at("p")->fld.data(), tmp1->fld.data(), tmp2->fld.data(),
-          gd.dz.data(), fields.rhoref.data());
+    solve(fields.sd.at("p")->fld.data(), tmp1->fld.data(), gd.dz.data());
 
     fields.release_tmp(tmp1);
-    fields.release_tmp(tmp2);
 
     // get the pressure tendencies from the pressure field
     output(fields.mt.at("u")->fld.data(), fields.mt.at("v")->fld.data(), fields.mt.at("w")->fld.data(),
@@ -115,12 +112,93 @@ void Pres_2<TF>::init()
     a.resize(gd.kmax);
     c.resize(gd.kmax);
 
+    #ifdef USECUDA
     work2d.resize(gd.imax*gd.jmax);
+    #endif
+
+    tdma_invb.resize(gd.iblock*gd.jblock*gd.kmax);
+    tdma_gam .resize(gd.iblock*gd.jblock*gd.kmax);
 
     boundary_cyclic.init();
     fft.init();
 }
 
+namespace
+{
+    // LU decomposition of the tridiagonal matrices, following the solver of Numerical Recipes, Press.
+    // The diagonal b of each column is turned into its inverse pivots, and the upper factors are stored
+    // in gam, such that the solve for each new right-hand side has no divisions left.
+    template<typename TF>
+    void tdma_factor(TF* const restrict invb, TF* const restrict gam,
+                     const TF* const restrict a, const TF* const restrict c,
+                     const int iblock, const int jblock, const int kmax)
+    {
+        const int jj = iblock;
+        const int kk = iblock*jblock;
+
+        for (int j=0; j<jblock; ++j)
+            #pragma ivdep
+            for (int i=0; i<iblock; ++i)
+            {
+                const int ij = i + j*jj;
+                invb[ij] = TF(1.)/invb[ij];
+                gam [ij] = TF(0.);
+            }
+
+        for (int k=1; k<kmax; ++k)
+            for (int j=0; j<jblock; ++j)
+                #pragma ivdep
+                for (int i=0; i<iblock; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    gam [ijk] = c[k-1]*invb[ijk-kk];
+                    invb[ijk] = TF(1.)/(invb[ijk] - a[k]*gam[ijk]);
+                }
+    }
+
+    // Forward and back substitution with the precomputed factors. The right-hand side is scaled
+    // with dz^2 on the fly. Columns are independent, thus the j-rows are spread over the threads.
+    template<typename TF>
+    void tdma_solve(TF* const restrict p,
+                    const TF* const restrict invb, const TF* const restrict gam,
+                    const TF* const restrict a, const TF* const restrict dz,
+                    const int iblock, const int jblock, const int kmax, const int kgc)
+    {
+        const int jj = iblock;
+        const int kk = iblock*jblock;
+
+        #pragma omp parallel for
+        for (int j=0; j<jblock; ++j)
+        {
+            #pragma ivdep
+            for (int i=0; i<iblock; ++i)
+            {
+                const int ij = i + j*jj;
+                p[ij] = dz[kgc]*dz[kgc]*p[ij]*invb[ij];
+            }
+
+            for (int k=1; k<kmax; ++k)
+            {
+                const TF dz2 = dz[k+kgc]*dz[k+kgc];
+                #pragma ivdep
+                for (int i=0; i<iblock; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    p[ijk] = (dz2*p[ijk] - a[k]*p[ijk-kk]) * invb[ijk];
+                }
+            }
+
+            for (int k=kmax-2; k>=0; --k)
+                #pragma ivdep
+                for (int i=0; i<iblock; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    p[ijk] -= gam[ijk+kk]*p[ijk+kk];
+                }
+        }
+    }
+}
+
 template<typename TF>
 void Pres_2<TF>::set_values()
 {
@@ -150,6 +228,55 @@ void Pres_2<TF>::set_values()
         a[k] = gd.dz[k+gd.kgc] * fields.rhorefh[k+gd.kgc  ]*gd.dzhi[k+gd.kgc  ];
         c[k] = gd.dz[k+gd.kgc] * fields.rhorefh[k+gd.kgc+1]*gd.dzhi[k+gd.kgc+1];
     }
+
+    // Create the diagonal of the tridiagonal matrices, which only depends on the wave numbers
+    // and the vertical grid, and factorize the matrices once.
+    auto& md = master.get_MPI_data();
+
+    const int iblock = gd.iblock;
+    const int jblock = gd.jblock;
+    const int kmax   = gd.kmax;
+    const int kgc    = gd.kgc;
+
+    const int jj = iblock;
+    const int kk = iblock*jblock;
+
+    TF* const restrict b = tdma_invb.data();
+
+    for (int k=0; k<kmax; ++k)
+        for (int j=0; j<jblock; ++j)
+            #pragma ivdep
+            for (int i=0; i<iblock; ++i)
+            {
+                // swap the mpicoords, because domain is turned 90 degrees to avoid two mpi transposes
+                const int iindex = md.mpicoordy * iblock + i;
+                const int jindex = md.mpicoordx * jblock + j;
+
+                const int ijk = i + j*jj + k*kk;
+                b[ijk] = gd.dz[k+kgc]*gd.dz[k+kgc] * fields.rhoref[k+kgc]*(bmati[iindex]+bmatj[jindex]) - (a[k]+c[k]);
+            }
+
+    for (int j=0; j<jblock; ++j)
+        #pragma ivdep
+        for (int i=0; i<iblock; ++i)
+        {
+            const int iindex = md.mpicoordy * iblock + i;
+            const int jindex = md.mpicoordx * jblock + j;
+
+            // substitute BC's
+            int ijk = i + j*jj;
+            b[ijk] += a[0];
+
+            // for wave number 0, which contains average, set pressure at top to zero
+            ijk = i + j*jj + (kmax-1)*kk;
+            if (iindex == 0 && jindex == 0)
+                b[ijk] -= c[kmax-1];
+            // set dp/dz at top to zero
+            else
+                b[ijk] += c[kmax-1];
+        }
+
+    tdma_factor(tdma_invb.data(), tdma_gam.data(), a.data(), c.data(), iblock, jblock, kmax);
 }
 
 template<typename TF>
@@ -181,6 +308,7 @@ void Pres_2<TF>::input(TF* const restrict p,
     boundary_cyclic.exec(vt, Edge::North_south_edge);
 
     // write pressure as a 3d array without ghost cells
+    #pragma omp parallel for
     for (int k=0; k<gd.kmax; ++k)
         for (int j=0; j<gd.jmax; ++j)
             #pragma ivdep
@@ -195,139 +323,38 @@ void Pres_2<TF>::input(TF* const restrict p,
             }
 }
 
-namespace
-{
-    // tridiagonal matrix solver, taken from Numerical Recipes, Press
-    template<typename TF>
-    void tdma(TF* const restrict a, TF* const restrict b, TF* const restrict c,
-              TF* const restrict p, TF* const restrict work2d, TF* const restrict work3d,
-              const int iblock, const int jblock, const int kmax)
-
-    {
-        const int jj = iblock;
-        const int kk = iblock*jblock;
-
-        for (int j=0; j<jblock; j++)
-            #pragma ivdep
-            for (int i=0; i<iblock; i++)
-            {
-                const int ij = i + j*jj;
-                work2d[ij] = b[ij];
-            }
-
-        for (int j=0; j<jblock; j++)
-            #pragma ivdep
-            for (int i=0; i<iblock; i++)
-            {
-                const int ij = i + j*jj;
-                p[ij] /= work2d[ij];
-            }
-
-        for (int k=1; k<kmax; k++)
-        {
-            for (int j=0; j<jblock; j++)
-                #pragma ivdep
-                for (int i=0; i<iblock; i++)
-                {
-                    const int ij  = i + j*jj;
-                    const int ijk = i + j*jj + k*kk;
-                    work3d[ijk] = c[k-1] / work2d[ij];
-                }
-            for (int j=0; j<jblock; j++)
-                #pragma ivdep
-                for (int i=0; i<iblock; i++)
-                {
-                    const int ij  = i + j*jj;
-                    const int ijk = i + j*jj + k*kk;
-                    work2d[ij] = b[ijk] - a[k]*work3d[ijk];
-                }
-            for (int j=0; j<jblock; j++)
-                #pragma ivdep
-                for (int i=0; i<iblock; i++)
-                {
-                    const int ij  = i + j*jj;
-                    const int ijk = i + j*jj + k*kk;
-                    p[ijk] -= a[k]*p[ijk-kk];
-                    p[ijk] /= work2d[ij];
-                }
-        }
-
-        for (int k=kmax-2; k>=0; k--)
-            for (int j=0; j<jblock; j++)
-                #pragma ivdep
-                for (int i=0; i<iblock; i++)
-                {
-                    const int ijk = i + j*jj + k*kk;
-                    p[ijk] -= work3d[ijk+kk]*p[ijk+kk];
-                }
-    }
-}
-
 template<typename TF>
-void Pres_2<TF>::solve(TF* const restrict p, TF* const restrict work3d, TF* const restrict b,
-                       const TF* const restrict dz, const TF* const restrict rhoref)
+void Pres_2<TF>::solve(TF* const restrict p, TF* const restrict work3d,
+                       const TF* const restrict dz)
 {
     auto& gd = grid.get_grid_data();
-    auto& md = master.get_MPI_data();
 
     const int imax   = gd.imax;
     const int jmax   = gd.jmax;
-    const int kmax   = gd.kmax;
-    const int iblock = gd.iblock;
-    const int jblock = gd.jblock;
     const int igc    = gd.igc;
     const int jgc    = gd.jgc;
     const int kgc    = gd.kgc;
 
-    int i,j,k,jj,kk,ijk;
-    int iindex,jindex;
-
-    fft.exec_forward(p, work3d);
+    int jj,kk,ijk;
 
-    jj = iblock;
-    kk = iblock*jblock;
+    Profiler& profiler = master.get_profiler();
 
-    // solve the tridiagonal system
-    // create vectors that go into the tridiagonal matrix solver
-    for (k=0; k<kmax; k++)
-        for (j=0; j<jblock; j++)
-            #pragma ivdep
-            for (i=0; i<iblock; i++)
-            {
-                // swap the mpicoords, because domain is turned 90 degrees to avoid two mpi transposes
-                iindex = md.mpicoordy * iblock + i;
-                jindex = md.mpicoordx * jblock + j;
-
-                ijk  = i + j*jj + k*kk;
-                b[ijk] = dz[k+kgc]*dz[k+kgc] * rhoref[k+kgc]*(bmati[iindex]+bmatj[jindex]) - (a[k]+c[k]);
-                p[ijk] = dz[k+kgc]*dz[k+kgc] * p[ijk];
-            }
-
-    for (j=0; j<jblock; j++)
-        #pragma ivdep
-        for (i=0; i<iblock; i++)
-        {
-            iindex = md.mpicoordy * iblock + i;
-            jindex = md.mpicoordx * jblock + j;
-
-            // substitute BC's
-            ijk = i + j*jj;
-            b[ijk] += a[0];
-
-            // for wave number 0, which contains average, set pressure at top to zero
-            ijk  = i + j*jj + (kmax-1)*kk;
-            if (iindex == 0 && jindex == 0)
-                b[ijk] -= c[kmax-1];
-            // set dp/dz at top to zero
-            else
-                b[ijk] += c[kmax-1];
-        }
+    {
+        Scoped_timer timer(profiler, "pres/fft");
+        fft.exec_forward(p, work3d);
+    }
 
-    // call tdma solver
-    tdma(a.data(), b, c.data(), p, work2d.data(), work3d,
-         gd.iblock, gd.jblock, gd.kmax);
+    // Solve the tridiagonal systems with the factors of set_values().
+    {
+        Scoped_timer timer(profiler, "pres/tdma");
+        tdma_solve(p, tdma_invb.data(), tdma_gam.data(), a.data(), dz,
+                   gd.iblock, gd.jblock, gd.kmax, kgc);
+    }
 
-    fft.exec_backward(p, work3d);
+    {
+        Scoped_timer timer(profiler, "pres/fft");
+        fft.exec_backward(p, work3d);
+    }
 
     jj = imax;
     kk = imax*jmax;
@@ -374,6 +401,7 @@ void Pres_2<TF>::output(TF* const restrict ut, TF* const restrict vt, TF* const
     const TF dxi = TF(1.)/gd.dx;
     const TF dyi = TF(1.)/gd.dy;
 
+    #pragma omp parallel for
     for (int k=gd.kstart; k<gd.kend; ++k)
         for (int j=gd.jstart; j<gd.jend; ++j)
             #pragma ivdep
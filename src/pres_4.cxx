@@ -302,6 +302,7 @@ void Pres_4<TF>::input(
             wt[ijk+kk1] = -wt[ijk-kk1];
         }
 
+    #pragma omp parallel for
     for (int k=0; k<gd.kmax; k++)
         for (int j=0; j<gd.jmax; j++)
             #pragma ivdep
@@ -337,7 +338,12 @@ void Pres_4<TF>::solve(
     const int jgc    = gd.jgc;
     const int kgc    = gd.kgc;
 
-    fft.exec_forward(p, work3d);
+    Profiler& profiler = master.get_profiler();
+
+    {
+        Scoped_timer timer(profiler, "pres/fft");
+        fft.exec_forward(p, work3d);
+    }
 
     int jj,kk,ik,ijk;
     int iindex,jindex;
@@ -469,7 +475,10 @@ void Pres_4<TF>::solve(
                 ptemp [ik+kki3] = 0.;
             }
 
-        hdma(m1temp, m2temp, m3temp, m4temp, m5temp, m6temp, m7temp, ptemp, jslice);
+        {
+            Scoped_timer timer(profiler, "pres/hdma");
+            hdma(m1temp, m2temp, m3temp, m4temp, m5temp, m6temp, m7temp, ptemp, jslice);
+        }
 
         // Put back the solution.
         for (int k=0; k<kmax; ++k)
@@ -483,7 +492,10 @@ void Pres_4<TF>::solve(
                 }
     }
 
-    fft.exec_backward(p, work3d);
+    {
+        Scoped_timer timer(profiler, "pres/fft");
+        fft.exec_backward(p, work3d);
+    }
 
     // Put the pressure back onto the original grid including ghost cells.
     jj = imax;
@@ -557,6 +569,7 @@ void Pres_4<TF>::output(TF* restrict ut, TF* restrict vt, TF* restrict wt,
                 vt[ijk] -= (cg0<TF>*p[ijk-jj2] + cg1<TF>*p[ijk-jj1] + cg2<TF>*p[ijk] + cg3<TF>*p[ijk+jj1]) * dyi;
         }
 
+    #pragma omp parallel for
     for (int k=gd.kstart+1; k<gd.kend; k++)
         for (int j=gd.jstart; j<gd.jend; j++)
             #pragma ivdep
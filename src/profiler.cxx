@@ -0,0 +1,153 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2018 Chiel van Heerwaarden
+ * Copyright (c) 2011-2018 Thijs Heus
+ * Copyright (c) 2014-2018 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "master.h"
+#include "input.h"
+#include "profiler.h"
+
+Profiler::Profiler(Master& masterin) :
+    master(masterin),
+    swprofile(false)
+{
+}
+
+Profiler::~Profiler()
+{
+}
+
+void Profiler::init(Input& input)
+{
+    swprofile = input.get_item<bool>("master", "swprofile", "", false);
+}
+
+double Profiler::get_time()
+{
+    return master.get_wall_clock_time();
+}
+
+void Profiler::add_time(const std::string& name, const double dt)
+{
+    // Stages that run in OpenMP tasks (statistics and saving) can finish concurrently.
+    #pragma omp critical (profiler)
+    {
+        Counter& c = counters[name];
+        ++c.ncalls;
+        c.time += dt;
+    }
+}
+
+void Profiler::add_bytes(const std::string& name, const unsigned long nbytes)
+{
+    if (!swprofile)
+        return;
+
+    #pragma omp critical (profiler)
+    counters[name].nbytes += nbytes;
+}
+
+void Profiler::write(const std::string& sim_name)
+{
+    if (!swprofile)
+        return;
+
+    const MPI_data& md = master.get_MPI_data();
+
+    // All processes run the same stages, thus the list of the first process is used.
+    std::string names;
+    for (auto& c : counters)
+        names += c.first + '\n';
+
+    int nchars = names.size();
+    master.broadcast(&nchars, 1);
+    names.resize(nchars);
+    if (nchars > 0)
+        master.broadcast(&names[0], nchars);
+
+    std::vector<std::string> stages;
+    std::istringstream names_stream(names);
+    for (std::string name; std::getline(names_stream, name);)
+        stages.push_back(name);
+
+    const int n = stages.size();
+    if (n == 0)
+        return;
+
+    std::vector<double> time_min(n), time_max(n), time_mean(n);
+    std::vector<double> bytes_min(n), bytes_max(n), bytes_mean(n);
+    std::vector<unsigned long> ncalls(n);
+
+    for (int i=0; i<n; ++i)
+    {
+        auto it = counters.find(stages[i]);
+        const Counter c = (it != counters.end()) ? it->second : Counter();
+
+        ncalls[i] = c.ncalls;
+        time_min[i] = time_max[i] = time_mean[i] = c.time;
+        bytes_min[i] = bytes_max[i] = bytes_mean[i] = static_cast<double>(c.nbytes);
+    }
+
+    // The spread between the minimum and maximum over the processes shows the load imbalance.
+    master.min(time_min.data(), n);
+    master.max(time_max.data(), n);
+    master.sum(time_mean.data(), n);
+    master.min(bytes_min.data(), n);
+    master.max(bytes_max.data(), n);
+    master.sum(bytes_mean.data(), n);
+
+    if (md.mpiid != 0)
+        return;
+
+    const std::string file_name = sim_name + ".profile.json";
+    master.print_message("Saving \"%s\" ... ", file_name.c_str());
+
+    std::FILE* f = std::fopen(file_name.c_str(), "w");
+    if (f == nullptr)
+    {
+        master.print_message("FAILED\n");
+        throw std::runtime_error("Cannot write profile " + file_name);
+    }
+
+    std::fprintf(f, "{\n");
+    std::fprintf(f, "    \"nprocs\": %d,\n", md.nprocs);
+    std::fprintf(f, "    \"nthreads\": %d,\n", master.get_nthreads());
+    std::fprintf(f, "    \"stages\": {\n");
+    for (int i=0; i<n; ++i)
+    {
+        std::fprintf(f, "        \"%s\": {\"calls\": %lu, ", stages[i].c_str(), ncalls[i]);
+        std::fprintf(f, "\"time_min\": %.6f, \"time_mean\": %.6f, \"time_max\": %.6f",
+                time_min[i], time_mean[i]/md.nprocs, time_max[i]);
+        if (bytes_max[i] > 0.)
+            std::fprintf(f, ", \"bytes_min\": %.0f, \"bytes_mean\": %.0f, \"bytes_max\": %.0f",
+                    bytes_min[i], bytes_mean[i]/md.nprocs, bytes_max[i]);
+        std::fprintf(f, "}%s\n", (i < n-1) ? "," : "");
+    }
+    std::fprintf(f, "    }\n");
+    std::fprintf(f, "}\n");
+    std::fclose(f);
+
+    master.print_message("OK\n");
+}
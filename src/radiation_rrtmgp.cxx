@@ -22,6 +22,11 @@
 #include <numeric>
 #include <string>
 #include <cmath>
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "radiation_rrtmgp.h"
 #include "master.h"
@@ -48,6 +53,15 @@
 
 namespace
 {
+    inline int get_thread_num()
+    {
+        #ifdef _OPENMP
+        return omp_get_thread_num();
+        #else
+        return 0;
+        #endif
+    }
+
     std::vector<std::string> get_variable_string(
             const std::string& var_name,
             std::vector<int> i_count,
@@ -103,6 +117,17 @@ namespace
         };
     }
 
+    // Move the largest coefficient tables to memory that is shared by the processes on a node,
+    // such that a node holds a single copy.
+    void share_gas_optics_tables(Master& master, Gas_optics<double>& kdist)
+    {
+        kdist.move_tables(
+                [&](const int n) { return static_cast<double*>(master.allocate_node_shared(n*sizeof(double))); },
+                master.is_node_leader());
+
+        master.node_barrier();
+    }
+
     Gas_optics<double> load_and_init_gas_optics(
             Master& master,
             const Gas_concs<double>& gas_concs,
@@ -381,6 +406,93 @@ namespace
         }
     }
 
+    // Average the grid columns of a field without ghost cells over blocks of n_coarse_x by
+    // n_coarse_y columns, for the radiation columns in cols. The output has the layout of
+    // the RRTMGP arrays, with the column index running fastest.
+    template<typename TF>
+    void average_columns(
+            double* restrict out, const TF* restrict in,
+            const std::vector<int>& cols,
+            const int n_coarse_x, const int n_coarse_y,
+            const int n_levels,
+            const int jj_nogc, const int kk_nogc)
+    {
+        const int n_col = cols.size();
+        const int n_col_coarse_x = jj_nogc / n_coarse_x;
+        const double fac = 1. / (n_coarse_x*n_coarse_y);
+
+        for (int k=0; k<n_levels; ++k)
+            for (int n=0; n<n_col; ++n)
+            {
+                const int i0 = (cols[n] % n_col_coarse_x) * n_coarse_x;
+                const int j0 = (cols[n] / n_col_coarse_x) * n_coarse_y;
+
+                double sum = 0.;
+                for (int j=j0; j<j0+n_coarse_y; ++j)
+                    for (int i=i0; i<i0+n_coarse_x; ++i)
+                        sum += in[i + j*jj_nogc + k*kk_nogc];
+
+                out[n + k*n_col] = fac*sum;
+            }
+    }
+
+    // Variant of calc_tendency for the radiation columns in cols, which maps the tendency of
+    // every radiation column to all grid columns of its block.
+    template<typename TF>
+    void calc_tendency_columns(
+            TF* restrict thlt_rad,
+            const double* restrict flux_up, const double* restrict flux_dn, // Fluxes are double precision.
+            const TF* restrict rho, const TF* exner, const TF* dz,
+            const std::vector<int>& cols,
+            const int n_coarse_x, const int n_coarse_y,
+            const int istart, const int jstart, const int kstart, const int kend,
+            const int jj, const int kk, const int n_col_coarse_x)
+    {
+        const int n_col = cols.size();
+
+        for (int k=kstart; k<kend; ++k)
+        {
+            // Conversion from energy to temperature.
+            const TF fac = TF(1.) / (rho[k]*Constants::cp<TF>*exner[k]*dz[k]);
+
+            const int ilev = (k-kstart)*n_col;
+
+            for (int n=0; n<n_col; ++n)
+            {
+                const TF tend = -fac *
+                    ( flux_up[n+ilev+n_col] - flux_up[n+ilev]
+                    - flux_dn[n+ilev+n_col] + flux_dn[n+ilev] );
+
+                const int i0 = istart + (cols[n] % n_col_coarse_x) * n_coarse_x;
+                const int j0 = jstart + (cols[n] / n_col_coarse_x) * n_coarse_y;
+
+                for (int j=j0; j<j0+n_coarse_y; ++j)
+                    for (int i=i0; i<i0+n_coarse_x; ++i)
+                        thlt_rad[i + j*jj + k*kk] += tend;
+            }
+        }
+    }
+
+    template<typename TF>
+    void reset_tendency_columns(
+            TF* restrict thlt_rad,
+            const std::vector<int>& cols,
+            const int n_coarse_x, const int n_coarse_y,
+            const int istart, const int jstart, const int kstart, const int kend,
+            const int jj, const int kk, const int n_col_coarse_x)
+    {
+        for (int k=kstart; k<kend; ++k)
+            for (const int c : cols)
+            {
+                const int i0 = istart + (c % n_col_coarse_x) * n_coarse_x;
+                const int j0 = jstart + (c / n_col_coarse_x) * n_coarse_y;
+
+                for (int j=j0; j<j0+n_coarse_y; ++j)
+                    for (int i=i0; i<i0+n_coarse_x; ++i)
+                        thlt_rad[i + j*jj + k*kk] = TF(0.);
+            }
+    }
+
     template<typename TF>
     void add_tendency(
             TF* restrict thlt, const TF* restrict thlt_rad,
@@ -588,6 +700,8 @@ Radiation_rrtmgp<TF>::Radiation_rrtmgp(
 
     dt_rad = inputin.get_item<double>("radiation", "dt_rad", "");
 
+    sw_shared_tables = inputin.get_item<bool>("radiation", "swsharedtables", "", false);
+
 	t_sfc       = inputin.get_item<double>("radiation", "t_sfc"      , "");
     emis_sfc    = inputin.get_item<double>("radiation", "emis_sfc"   , "");
     sfc_alb_dir = inputin.get_item<double>("radiation", "sfc_alb_dir", "");
@@ -597,6 +711,19 @@ Radiation_rrtmgp<TF>::Radiation_rrtmgp(
     const double sza = inputin.get_item<double>("radiation", "sza", "");
     mu0 = std::cos(sza);
 
+    // The RRTMGP kernels keep automatic arrays of n_col_block columns on the stack of each thread,
+    // so large blocks overflow the default OMP_STACKSIZE.
+    n_col_block = inputin.get_item<int>("radiation", "n_col_block", "", 16);
+    if (n_col_block < 1)
+        throw std::runtime_error("n_col_block has to be at least 1");
+
+    n_subsample = inputin.get_item<int>("radiation", "n_subsample", "", 1);
+    n_coarse_x  = inputin.get_item<int>("radiation", "n_coarse_x" , "", 1);
+    n_coarse_y  = inputin.get_item<int>("radiation", "n_coarse_y" , "", 1);
+
+    if (n_subsample < 1 || n_coarse_x < 1 || n_coarse_y < 1)
+        throw std::runtime_error("n_subsample, n_coarse_x and n_coarse_y have to be at least 1");
+
     // Nc0 = inputin.get_item<double>("microphysics", "Nc0", "", 70e6);
 
     auto& gd = grid.get_grid_data();
@@ -607,6 +734,12 @@ template<typename TF>
 void Radiation_rrtmgp<TF>::init(const double ifactor)
 {
     idt_rad = static_cast<unsigned long>(ifactor * dt_rad + 0.5);
+
+    // One subset of the columns is solved every idt_rad_subset, such that all are updated every idt_rad.
+    if (idt_rad % n_subsample != 0)
+        throw std::runtime_error("dt_rad cannot be divided into n_subsample equal intervals");
+    idt_rad_subset = idt_rad / n_subsample;
+    rad_subsets_initialized = false;
 }
 
 template<typename TF>
@@ -879,7 +1012,33 @@ void Radiation_rrtmgp<TF>::create_solver(
     Netcdf_handle& rad_input_nc = input_nc.get_group("init");
     load_gas_concs<double>(gas_concs, rad_input_nc, "z");
 
-    // 2. Pass the gas concentrations to the solver initializers.
+    // 2. Set up the radiation columns. Each averages a block of n_coarse_x by n_coarse_y grid
+    // columns. The radiation columns are interleaved over n_subsample subsets along diagonals,
+    // which is a checkerboard for two subsets.
+    auto& gd = grid.get_grid_data();
+
+    if (gd.imax % n_coarse_x != 0 || gd.jmax % n_coarse_y != 0)
+        throw std::runtime_error("n_coarse_x and n_coarse_y have to divide imax and jmax");
+
+    const int n_col_coarse_x = gd.imax / n_coarse_x;
+    const int n_col_coarse_y = gd.jmax / n_coarse_y;
+
+    rad_col_subsets.assign(n_subsample, std::vector<int>());
+    for (int j=0; j<n_col_coarse_y; ++j)
+        for (int i=0; i<n_col_coarse_x; ++i)
+            rad_col_subsets[(i+j) % n_subsample].push_back(i + j*n_col_coarse_x);
+
+    // 3. The blocks cannot be larger than the number of columns of the smallest subset.
+    int n_col_min = gd.imax*gd.jmax;
+    for (auto& cols : rad_col_subsets)
+        n_col_min = std::min(n_col_min, static_cast<int>(cols.size()));
+
+    if (n_col_min == 0)
+        throw std::runtime_error("n_subsample is too large for the number of radiation columns");
+
+    n_col_block = std::min(n_col_block, n_col_min);
+
+    // 4. Pass the gas concentrations to the solver initializers.
     if (sw_longwave)
         create_solver_longwave(input, input_nc, thermo, stats, gas_concs);
     if (sw_shortwave)
@@ -897,9 +1056,22 @@ void Radiation_rrtmgp<TF>::create_solver_longwave(
     kdist_lw = std::make_unique<Gas_optics<double>>(
             load_and_init_gas_optics(master, gas_concs, "coefficients_lw.nc"));
 
+    if (sw_shared_tables)
+        share_gas_optics_tables(master, *kdist_lw);
+
     cloud_lw = std::make_unique<Cloud_optics<double>>(
             load_and_init_cloud_optics(master, "cloud_coefficients_lw.nc"));
 
+    // Allocate the work arrays for the column blocks of each thread. The work arrays of the
+    // remainder block are allocated when the solver is called.
+    auto& gd = grid.get_grid_data();
+    const int n_col = gd.imax*gd.jmax;
+
+    const int n_threads = std::min(master.get_nthreads(), n_col / n_col_block);
+    lw_workspace.resize(n_threads);
+    for (auto& ws : lw_workspace)
+        init_longwave_workspace(ws, n_col_block);
+
     // Set up the statistics.
     if (stats.get_switch())
     {
@@ -925,9 +1097,22 @@ void Radiation_rrtmgp<TF>::create_solver_shortwave(
     kdist_sw = std::make_unique<Gas_optics<double>>(
             load_and_init_gas_optics(master, gas_concs, "coefficients_sw.nc"));
 
+    if (sw_shared_tables)
+        share_gas_optics_tables(master, *kdist_sw);
+
     cloud_sw = std::make_unique<Cloud_optics<double>>(
             load_and_init_cloud_optics(master, "cloud_coefficients_sw.nc"));
 
+    // Allocate the work arrays for the column blocks of each thread. The work arrays of the
+    // remainder block are allocated when the solver is called.
+    auto& gd = grid.get_grid_data();
+    const int n_col = gd.imax*gd.jmax;
+
+    const int n_threads = std::min(master.get_nthreads(), n_col / n_col_block);
+    sw_workspace.resize(n_threads);
+    for (auto& ws : sw_workspace)
+        init_shortwave_workspace(ws, n_col_block);
+
     // Set up the statistics.
     if (stats.get_switch())
     {
@@ -951,9 +1136,24 @@ void Radiation_rrtmgp<TF>::exec(
 {
     auto& gd = grid.get_grid_data();
 
-    const bool do_radiation = (timeloop.get_itime() % idt_rad == 0);
+    const bool is_subsampled = (n_subsample > 1 || n_coarse_x > 1 || n_coarse_y > 1);
 
-    if (do_radiation)
+    if (is_subsampled)
+    {
+        // Solve all subsets in the first call, as the tendencies are not stored in the restart files.
+        if (!rad_subsets_initialized)
+        {
+            for (auto& cols : rad_col_subsets)
+                exec_subset(thermo, timeloop, stats, cols);
+            rad_subsets_initialized = true;
+        }
+        else if (timeloop.get_itime() % idt_rad_subset == 0)
+        {
+            const int subset = (timeloop.get_itime() / idt_rad_subset) % n_subsample;
+            exec_subset(thermo, timeloop, stats, rad_col_subsets[subset]);
+        }
+    }
+    else if (timeloop.get_itime() % idt_rad == 0)
     {
         // Set the tendency to zero.
         std::fill(fields.sd.at("thlt_rad")->fld.begin(), fields.sd.at("thlt_rad")->fld.end(), TF(0.));
@@ -1043,6 +1243,95 @@ void Radiation_rrtmgp<TF>::exec(
 
     stats.calc_tend(*fields.st.at("thl"), tend_name);
 }
+
+template<typename TF>
+void Radiation_rrtmgp<TF>::exec_subset(
+        Thermo<TF>& thermo, Timeloop<TF>& timeloop, Stats<TF>& stats, const std::vector<int>& cols)
+{
+    auto& gd = grid.get_grid_data();
+
+    const int n_col = cols.size();
+    const int n_col_coarse_x = gd.imax / n_coarse_x;
+    const int ijmax = gd.imax*gd.jmax;
+
+    auto t_lay = fields.get_tmp();
+    auto t_lev = fields.get_tmp();
+    auto h2o   = fields.get_tmp(); // This is the volume mixing ratio, not the specific humidity of vapor.
+    auto clwp  = fields.get_tmp();
+    auto ciwp  = fields.get_tmp();
+
+    // Set the input to the radiation on a 3D grid without ghost cells.
+    thermo.get_radiation_fields(*t_lay, *t_lev, *h2o, *clwp, *ciwp);
+
+    // Average the input over the blocks of the radiation columns of this subset.
+    Array<double,2> t_lay_a({n_col, gd.ktot});
+    Array<double,2> t_lev_a({n_col, gd.ktot+1});
+    Array<double,2> h2o_a  ({n_col, gd.ktot});
+    Array<double,2> clwp_a ({n_col, gd.ktot});
+    Array<double,2> ciwp_a ({n_col, gd.ktot});
+
+    average_columns(t_lay_a.ptr(), t_lay->fld.data(), cols, n_coarse_x, n_coarse_y, gd.ktot  , gd.imax, ijmax);
+    average_columns(t_lev_a.ptr(), t_lev->fld.data(), cols, n_coarse_x, n_coarse_y, gd.ktot+1, gd.imax, ijmax);
+    average_columns(h2o_a  .ptr(), h2o  ->fld.data(), cols, n_coarse_x, n_coarse_y, gd.ktot  , gd.imax, ijmax);
+    average_columns(clwp_a .ptr(), clwp ->fld.data(), cols, n_coarse_x, n_coarse_y, gd.ktot  , gd.imax, ijmax);
+    average_columns(ciwp_a .ptr(), ciwp ->fld.data(), cols, n_coarse_x, n_coarse_y, gd.ktot  , gd.imax, ijmax);
+
+    fields.release_tmp(t_lay);
+    fields.release_tmp(t_lev);
+    fields.release_tmp(h2o);
+    fields.release_tmp(clwp);
+    fields.release_tmp(ciwp);
+
+    Array<double,2> flux_up ({n_col, gd.ktot+1});
+    Array<double,2> flux_dn ({n_col, gd.ktot+1});
+    Array<double,2> flux_net({n_col, gd.ktot+1});
+
+    const bool compute_clouds = true;
+
+    // Only the tendency of the grid columns of this subset is renewed.
+    reset_tendency_columns(
+            fields.sd.at("thlt_rad")->fld.data(), cols, n_coarse_x, n_coarse_y,
+            gd.istart, gd.jstart, gd.kstart, gd.kend,
+            gd.icells, gd.ijcells, n_col_coarse_x);
+
+    if (sw_longwave)
+    {
+        exec_longwave(
+                thermo, timeloop, stats,
+                flux_up, flux_dn, flux_net,
+                t_lay_a, t_lev_a, h2o_a, clwp_a, ciwp_a,
+                compute_clouds);
+
+        calc_tendency_columns(
+                fields.sd.at("thlt_rad")->fld.data(),
+                flux_up.ptr(), flux_dn.ptr(),
+                fields.rhoref.data(), thermo.get_exner_vector().data(),
+                gd.dz.data(),
+                cols, n_coarse_x, n_coarse_y,
+                gd.istart, gd.jstart, gd.kstart, gd.kend,
+                gd.icells, gd.ijcells, n_col_coarse_x);
+    }
+
+    if (sw_shortwave)
+    {
+        Array<double,2> flux_dn_dir({n_col, gd.ktot+1});
+
+        exec_shortwave(
+                thermo, timeloop, stats,
+                flux_up, flux_dn, flux_dn_dir, flux_net,
+                t_lay_a, t_lev_a, h2o_a, clwp_a, ciwp_a,
+                compute_clouds);
+
+        calc_tendency_columns(
+                fields.sd.at("thlt_rad")->fld.data(),
+                flux_up.ptr(), flux_dn.ptr(),
+                fields.rhoref.data(), thermo.get_exner_vector().data(),
+                gd.dz.data(),
+                cols, n_coarse_x, n_coarse_y,
+                gd.istart, gd.jstart, gd.kstart, gd.kend,
+                gd.icells, gd.ijcells, n_col_coarse_x);
+    }
+}
 #endif
 
 namespace
@@ -1205,6 +1494,40 @@ void Radiation_rrtmgp<TF>::exec_all_stats(
     fields.release_tmp(tmp);
 }
 
+template<typename TF>
+void Radiation_rrtmgp<TF>::init_longwave_workspace(Longwave_workspace& ws, const int n_col)
+{
+    auto& gd = grid.get_grid_data();
+
+    const int n_lay = gd.ktot;
+    const int n_lev = gd.ktot+1;
+    const int n_gpt = kdist_lw->get_ngpt();
+
+    ws.optical_props = std::make_unique<Optical_props_1scl<double>>(n_col, n_lay, *kdist_lw);
+    ws.cloud_optical_props = std::make_unique<Optical_props_1scl<double>>(n_col, n_lay, *cloud_lw);
+    ws.sources = std::make_unique<Source_func_lw<double>>(n_col, n_lay, *kdist_lw);
+    ws.fluxes = std::make_unique<Fluxes_broadband<double>>(n_col, n_lev);
+    ws.gpt_flux_up.set_dims({n_col, n_lev, n_gpt});
+    ws.gpt_flux_dn.set_dims({n_col, n_lev, n_gpt});
+}
+
+template<typename TF>
+void Radiation_rrtmgp<TF>::init_shortwave_workspace(Shortwave_workspace& ws, const int n_col)
+{
+    auto& gd = grid.get_grid_data();
+
+    const int n_lay = gd.ktot;
+    const int n_lev = gd.ktot+1;
+    const int n_gpt = kdist_sw->get_ngpt();
+
+    ws.optical_props = std::make_unique<Optical_props_2str<double>>(n_col, n_lay, *kdist_sw);
+    ws.cloud_optical_props = std::make_unique<Optical_props_2str<double>>(n_col, n_lay, *cloud_sw);
+    ws.fluxes = std::make_unique<Fluxes_broadband<double>>(n_col, n_lev);
+    ws.gpt_flux_up.set_dims({n_col, n_lev, n_gpt});
+    ws.gpt_flux_dn.set_dims({n_col, n_lev, n_gpt});
+    ws.gpt_flux_dn_dir.set_dims({n_col, n_lev, n_gpt});
+}
+
 template<typename TF>
 void Radiation_rrtmgp<TF>::exec_longwave(
         Thermo<TF>& thermo, Timeloop<TF>& timeloop, Stats<TF>& stats,
@@ -1213,17 +1536,19 @@ void Radiation_rrtmgp<TF>::exec_longwave(
         const Array<double,2>& h2o, const Array<double,2>& clwp, const Array<double,2>& ciwp,
         const bool compute_clouds)
 {
-    // How many profiles are solved simultaneously?
-    constexpr int n_col_block = 4;
-
     auto& gd = grid.get_grid_data();
 
     const int n_lay = gd.ktot;
     const int n_lev = gd.ktot+1;
-    const int n_col = gd.imax*gd.jmax;
+    const int n_col = t_lay.dim(1);
 
     const int n_blocks = n_col / n_col_block;
     const int n_col_block_left = n_col % n_col_block;
+    const int n_blocks_tot = n_blocks + (n_col_block_left > 0);
+
+    // Allocate the work arrays for the remainder block on first use.
+    if (n_col_block_left > 0 && lw_workspace_left.find(n_col_block_left) == lw_workspace_left.end())
+        init_longwave_workspace(lw_workspace_left[n_col_block_left], n_col_block_left);
 
     // Store the number of bands and gpt in a variable.
     const int n_bnd = kdist_lw->get_nband();
@@ -1235,21 +1560,6 @@ void Radiation_rrtmgp<TF>::exec_longwave(
     // Check the dimension ordering. The top is not at 1 in MicroHH, but the surface is.
     const int top_at_1 = 0;
 
-    // Define the pointers for the subsetting.
-    std::unique_ptr<Optical_props_arry<double>> optical_props_subset =
-            std::make_unique<Optical_props_1scl<double>>(n_col_block, n_lay, *kdist_lw);
-    std::unique_ptr<Source_func_lw<double>> sources_subset =
-            std::make_unique<Source_func_lw<double>>(n_col_block, n_lay, *kdist_lw);
-    std::unique_ptr<Optical_props_1scl<double>> cloud_optical_props_subset =
-            std::make_unique<Optical_props_1scl<double>>(n_col_block, n_lay, *cloud_lw);
-
-    std::unique_ptr<Optical_props_arry<double>> optical_props_left =
-            std::make_unique<Optical_props_1scl<double>>(n_col_block_left, n_lay, *kdist_lw);
-    std::unique_ptr<Source_func_lw<double>> sources_left =
-            std::make_unique<Source_func_lw<double>>(n_col_block_left, n_lay, *kdist_lw);
-    std::unique_ptr<Optical_props_1scl<double>> cloud_optical_props_left =
-            std::make_unique<Optical_props_1scl<double>>(n_col_block_left, n_lay, *cloud_lw);
-
     // Define the arrays that contain the subsets.
     Array<double,2> p_lay(std::vector<double>(thermo.get_p_vector ().begin() + gd.kstart, thermo.get_p_vector ().begin() + gd.kend    ), {1, n_lay});
     Array<double,2> p_lev(std::vector<double>(thermo.get_ph_vector().begin() + gd.kstart, thermo.get_ph_vector().begin() + gd.kend + 1), {1, n_lev});
@@ -1264,13 +1574,15 @@ void Radiation_rrtmgp<TF>::exec_longwave(
     // Lambda function for solving optical properties subset.
     auto call_kernels = [&](
             const int col_s_in, const int col_e_in,
-            std::unique_ptr<Optical_props_arry<double>>& optical_props_subset_in,
-            std::unique_ptr<Optical_props_1scl<double>>& cloud_optical_props_in,
-            Source_func_lw<double>& sources_subset_in,
+            Longwave_workspace& ws,
             const Array<double,2>& emis_sfc_subset_in,
-            const Array<double,2>& lw_flux_dn_inc_subset_in,
-            std::unique_ptr<Fluxes_broadband<double>>& fluxes)
+            const Array<double,2>& lw_flux_dn_inc_subset_in)
     {
+        std::unique_ptr<Optical_props_arry<double>>& optical_props_subset_in = ws.optical_props;
+        std::unique_ptr<Optical_props_1scl<double>>& cloud_optical_props_in = ws.cloud_optical_props;
+        Source_func_lw<double>& sources_subset_in = *ws.sources;
+        std::unique_ptr<Fluxes_broadband<double>>& fluxes = ws.fluxes;
+
         const int n_col_in = col_e_in - col_s_in + 1;
         Gas_concs<double> gas_concs_subset(gas_concs, col_s_in, n_col_in);
 
@@ -1359,8 +1671,8 @@ void Radiation_rrtmgp<TF>::exec_longwave(
                     dynamic_cast<Optical_props_1scl<double>&>(*cloud_optical_props_in));
         }
 
-        Array<double,3> gpt_flux_up({n_col_in, n_lev, n_gpt});
-        Array<double,3> gpt_flux_dn({n_col_in, n_lev, n_gpt});
+        Array<double,3>& gpt_flux_up = ws.gpt_flux_up;
+        Array<double,3>& gpt_flux_dn = ws.gpt_flux_dn;
 
         Rte_lw<double>::rte_lw(
                 optical_props_subset_in,
@@ -1383,45 +1695,40 @@ void Radiation_rrtmgp<TF>::exec_longwave(
             }
     };
 
-    for (int b=1; b<=n_blocks; ++b)
-    {
-        const int col_s = (b-1) * n_col_block + 1;
-        const int col_e =  b    * n_col_block;
-
-        Array<double,2> emis_sfc_subset = emis_sfc.subset({{ {1, n_bnd}, {col_s, col_e} }});
-        Array<double,2> lw_flux_dn_inc_subset = lw_flux_dn_inc.subset({{ {col_s, col_e}, {1, n_gpt} }});
-        std::unique_ptr<Fluxes_broadband<double>> fluxes_subset =
-                std::make_unique<Fluxes_broadband<double>>(n_col_block, n_lev);
-
-        call_kernels(
-                col_s, col_e,
-                optical_props_subset,
-                cloud_optical_props_subset,
-                *sources_subset,
-                emis_sfc_subset,
-                lw_flux_dn_inc_subset,
-                fluxes_subset);
-    }
+    // Solve the blocks concurrently, each thread with its own work arrays. The last block
+    // contains the remainder of the columns and has its own work arrays.
+    std::exception_ptr exception;
 
-    if (n_col_block_left > 0)
+    #pragma omp parallel for schedule(dynamic) num_threads(lw_workspace.size())
+    for (int b=0; b<n_blocks_tot; ++b)
     {
-        const int col_s = n_col - n_col_block_left + 1;
-        const int col_e = n_col;
-
-        Array<double,2> emis_sfc_left = emis_sfc.subset({{ {1, n_bnd}, {col_s, col_e} }});
-        Array<double,2> lw_flux_dn_inc_left = lw_flux_dn_inc.subset({{ {col_s, col_e}, {1, n_gpt} }});
-        std::unique_ptr<Fluxes_broadband<double>> fluxes_left =
-                std::make_unique<Fluxes_broadband<double>>(n_col_block_left, n_lev);
-
-        call_kernels(
-                col_s, col_e,
-                optical_props_left,
-                cloud_optical_props_left,
-                *sources_left,
-                emis_sfc_left,
-                lw_flux_dn_inc_left,
-                fluxes_left);
+        const bool is_left = (b == n_blocks);
+        const int col_s = b*n_col_block + 1;
+        const int col_e = is_left ? n_col : (b+1)*n_col_block;
+
+        Longwave_workspace& ws = is_left ? lw_workspace_left.at(n_col_block_left) : lw_workspace[get_thread_num()];
+
+        try
+        {
+            Array<double,2> emis_sfc_subset = emis_sfc.subset({{ {1, n_bnd}, {col_s, col_e} }});
+            Array<double,2> lw_flux_dn_inc_subset = lw_flux_dn_inc.subset({{ {col_s, col_e}, {1, n_gpt} }});
+
+            call_kernels(
+                    col_s, col_e,
+                    ws,
+                    emis_sfc_subset,
+                    lw_flux_dn_inc_subset);
+        }
+        catch (...)
+        {
+            #pragma omp critical
+            if (!exception)
+                exception = std::current_exception();
+        }
     }
+
+    if (exception)
+        std::rethrow_exception(exception);
 }
 
 template<typename TF>
@@ -1432,17 +1739,19 @@ void Radiation_rrtmgp<TF>::exec_shortwave(
         const Array<double,2>& h2o, const Array<double,2>& clwp, const Array<double,2>& ciwp,
         const bool compute_clouds)
 {
-    // How many profiles are solved simultaneously?
-    constexpr int n_col_block = 4;
-
     auto& gd = grid.get_grid_data();
 
     const int n_lay = gd.ktot;
     const int n_lev = gd.ktot+1;
-    const int n_col = gd.imax*gd.jmax;
+    const int n_col = t_lay.dim(1);
 
     const int n_blocks = n_col / n_col_block;
     const int n_col_block_left = n_col % n_col_block;
+    const int n_blocks_tot = n_blocks + (n_col_block_left > 0);
+
+    // Allocate the work arrays for the remainder block on first use.
+    if (n_col_block_left > 0 && sw_workspace_left.find(n_col_block_left) == sw_workspace_left.end())
+        init_shortwave_workspace(sw_workspace_left[n_col_block_left], n_col_block_left);
 
     // Store the number of bands and gpt in a variable.
     const int n_bnd = kdist_sw->get_nband();
@@ -1451,17 +1760,6 @@ void Radiation_rrtmgp<TF>::exec_shortwave(
     // Check the dimension ordering. The top is not at 1 in MicroHH, but the surface is.
     const int top_at_1 = 0;
 
-    // Define the pointers for the subsetting.
-    std::unique_ptr<Optical_props_arry<double>> optical_props_subset =
-            std::make_unique<Optical_props_2str<double>>(n_col_block, n_lay, *kdist_sw);
-    std::unique_ptr<Optical_props_2str<double>> cloud_optical_props_subset =
-            std::make_unique<Optical_props_2str<double>>(n_col_block, n_lay, *cloud_sw);
-
-    std::unique_ptr<Optical_props_arry<double>> optical_props_left =
-            std::make_unique<Optical_props_2str<double>>(n_col_block_left, n_lay, *kdist_sw);
-    std::unique_ptr<Optical_props_2str<double>> cloud_optical_props_left =
-            std::make_unique<Optical_props_2str<double>>(n_col_block_left, n_lay, *cloud_sw);
-
     // Define the arrays that contain the subsets.
     Array<double,2> p_lay(std::vector<double>(thermo.get_p_vector ().begin() + gd.kstart, thermo.get_p_vector ().begin() + gd.kend    ), {1, n_lay});
     Array<double,2> p_lev(std::vector<double>(thermo.get_ph_vector().begin() + gd.kstart, thermo.get_ph_vector().begin() + gd.kend + 1), {1, n_lev});
@@ -1481,15 +1779,17 @@ void Radiation_rrtmgp<TF>::exec_shortwave(
     // Lambda function for solving optical properties subset.
     auto call_kernels = [&](
             const int col_s_in, const int col_e_in,
-            std::unique_ptr<Optical_props_arry<double>>& optical_props_subset_in,
-            std::unique_ptr<Optical_props_2str<double>>& cloud_optical_props_in,
+            Shortwave_workspace& ws,
             const Array<double,1>& mu0_subset_in,
             const Array<double,2>& toa_src_subset_in,
             const Array<double,2>& sfc_alb_dir_subset_in,
             const Array<double,2>& sfc_alb_dif_subset_in,
-            const Array<double,2>& sw_flux_dn_dif_inc_subset_in,
-            std::unique_ptr<Fluxes_broadband<double>>& fluxes)
+            const Array<double,2>& sw_flux_dn_dif_inc_subset_in)
     {
+        std::unique_ptr<Optical_props_arry<double>>& optical_props_subset_in = ws.optical_props;
+        std::unique_ptr<Optical_props_2str<double>>& cloud_optical_props_in = ws.cloud_optical_props;
+        std::unique_ptr<Fluxes_broadband<double>>& fluxes = ws.fluxes;
+
         const int n_col_in = col_e_in - col_s_in + 1;
 
         Gas_concs<double> gas_concs_subset(gas_concs, col_s_in, n_col_in);
@@ -1580,9 +1880,9 @@ void Radiation_rrtmgp<TF>::exec_shortwave(
         }
 
         // 3. Solve the fluxes.
-        Array<double,3> gpt_flux_up    ({n_col_in, n_lev, n_gpt});
-        Array<double,3> gpt_flux_dn    ({n_col_in, n_lev, n_gpt});
-        Array<double,3> gpt_flux_dn_dir({n_col_in, n_lev, n_gpt});
+        Array<double,3>& gpt_flux_up     = ws.gpt_flux_up;
+        Array<double,3>& gpt_flux_dn     = ws.gpt_flux_dn;
+        Array<double,3>& gpt_flux_dn_dir = ws.gpt_flux_dn_dir;
 
         Rte_sw<double>::rte_sw(
                 optical_props_subset_in,
@@ -1612,57 +1912,47 @@ void Radiation_rrtmgp<TF>::exec_shortwave(
             }
     };
 
-    for (int b=1; b<=n_blocks; ++b)
-    {
-        const int col_s = (b-1) * n_col_block + 1;
-        const int col_e =  b    * n_col_block;
-
-        Array<double,1> mu0_subset = mu0.subset({{ {col_s, col_e} }});
-        Array<double,2> toa_src_subset = sw_flux_dn_dir_inc.subset({{ {col_s, col_e}, {1, n_gpt} }});
-        Array<double,2> sfc_alb_dir_subset = sfc_alb_dir.subset({{ {1, n_bnd}, {col_s, col_e} }});
-        Array<double,2> sfc_alb_dif_subset = sfc_alb_dif.subset({{ {1, n_bnd}, {col_s, col_e} }});
-        Array<double,2> sw_flux_dn_dif_inc_subset = sw_flux_dn_dif_inc.subset({{ {col_s, col_e}, {1, n_gpt} }});
-
-        std::unique_ptr<Fluxes_broadband<double>> fluxes_subset =
-                std::make_unique<Fluxes_broadband<double>>(n_col_block, n_lev);
-
-        call_kernels(
-                col_s, col_e,
-                optical_props_subset,
-                cloud_optical_props_subset,
-                mu0_subset,
-                toa_src_subset,
-                sfc_alb_dir_subset,
-                sfc_alb_dif_subset,
-                sw_flux_dn_dif_inc_subset,
-                fluxes_subset);
-    }
+    // Solve the blocks concurrently, each thread with its own work arrays. The last block
+    // contains the remainder of the columns and has its own work arrays.
+    std::exception_ptr exception;
 
-    if (n_col_block_left > 0)
+    #pragma omp parallel for schedule(dynamic) num_threads(sw_workspace.size())
+    for (int b=0; b<n_blocks_tot; ++b)
     {
-        const int col_s = n_col - n_col_block_left + 1;
-        const int col_e = n_col;
-
-        Array<double,1> mu0_left = mu0.subset({{ {col_s, col_e} }});
-        Array<double,2> toa_src_left = sw_flux_dn_dir_inc.subset({{ {col_s, col_e}, {1, n_gpt} }});
-        Array<double,2> sfc_alb_dir_left = sfc_alb_dir.subset({{ {1, n_bnd}, {col_s, col_e} }});
-        Array<double,2> sfc_alb_dif_left = sfc_alb_dif.subset({{ {1, n_bnd}, {col_s, col_e} }});
-        Array<double,2> sw_flux_dn_dif_inc_left = sw_flux_dn_dif_inc.subset({{ {col_s, col_e}, {1, n_gpt} }});
-
-        std::unique_ptr<Fluxes_broadband<double>> fluxes_left =
-                std::make_unique<Fluxes_broadband<double>>(n_col_block_left, n_lev);
-
-        call_kernels(
-                col_s, col_e,
-                optical_props_left,
-                cloud_optical_props_left,
-                mu0_left,
-                toa_src_left,
-                sfc_alb_dir_left,
-                sfc_alb_dif_left,
-                sw_flux_dn_dif_inc_left,
-                fluxes_left);
+        const bool is_left = (b == n_blocks);
+        const int col_s = b*n_col_block + 1;
+        const int col_e = is_left ? n_col : (b+1)*n_col_block;
+
+        Shortwave_workspace& ws = is_left ? sw_workspace_left.at(n_col_block_left) : sw_workspace[get_thread_num()];
+
+        try
+        {
+            Array<double,1> mu0_subset = mu0.subset({{ {col_s, col_e} }});
+            Array<double,2> toa_src_subset = sw_flux_dn_dir_inc.subset({{ {col_s, col_e}, {1, n_gpt} }});
+            Array<double,2> sfc_alb_dir_subset = sfc_alb_dir.subset({{ {1, n_bnd}, {col_s, col_e} }});
+            Array<double,2> sfc_alb_dif_subset = sfc_alb_dif.subset({{ {1, n_bnd}, {col_s, col_e} }});
+            Array<double,2> sw_flux_dn_dif_inc_subset = sw_flux_dn_dif_inc.subset({{ {col_s, col_e}, {1, n_gpt} }});
+
+            call_kernels(
+                    col_s, col_e,
+                    ws,
+                    mu0_subset,
+                    toa_src_subset,
+                    sfc_alb_dir_subset,
+                    sfc_alb_dif_subset,
+                    sw_flux_dn_dif_inc_subset);
+        }
+        catch (...)
+        {
+            #pragma omp critical
+            if (!exception)
+                exception = std::current_exception();
+        }
     }
+
+    if (exception)
+        std::rethrow_exception(exception);
 }
+
 template class Radiation_rrtmgp<double>;
 template class Radiation_rrtmgp<float>;
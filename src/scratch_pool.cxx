@@ -0,0 +1,138 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2018 Chiel van Heerwaarden
+ * Copyright (c) 2011-2018 Thijs Heus
+ * Copyright (c) 2014-2018 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include "master.h"
+#include "scratch_pool.h"
+
+template<typename TF>
+Scratch_buffer<TF>::Scratch_buffer(Scratch_pool<TF>& pool_in, std::vector<TF>&& buffer_in) :
+    pool(&pool_in), buffer(std::move(buffer_in))
+{
+}
+
+template<typename TF>
+Scratch_buffer<TF>::Scratch_buffer(Scratch_buffer&& other) noexcept :
+    pool(other.pool), buffer(std::move(other.buffer))
+{
+    other.pool = nullptr;
+}
+
+template<typename TF>
+Scratch_buffer<TF>::~Scratch_buffer()
+{
+    if (pool != nullptr)
+        pool->release(std::move(buffer));
+}
+
+template<typename TF>
+Scratch_pool<TF>::Scratch_pool(Master& masterin) : master(masterin)
+{
+}
+
+template<typename TF>
+Scratch_pool<TF>::~Scratch_pool()
+{
+}
+
+template<typename TF>
+void Scratch_pool<TF>::add_size_class(const std::string& name, const int size)
+{
+    // Classes of equal size share their buffers.
+    if (size_classes.find(size) != size_classes.end())
+        return;
+
+    auto size_class = std::make_unique<Size_class>();
+    size_class->name = name;
+    size_class->in_use = 0;
+    size_class->peak = 0;
+
+    size_classes.emplace(size, std::move(size_class));
+}
+
+template<typename TF>
+typename Scratch_pool<TF>::Size_class& Scratch_pool<TF>::get_size_class(const int size)
+{
+    auto it = size_classes.find(size);
+    if (it == size_classes.end())
+    {
+        std::string msg = "No scratch size class of size " + std::to_string(size);
+        throw std::runtime_error(msg);
+    }
+
+    return *(it->second);
+}
+
+template<typename TF>
+Scratch_buffer<TF> Scratch_pool<TF>::get(const int size)
+{
+    Size_class& size_class = get_size_class(size);
+
+    std::vector<TF> buffer;
+    {
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (!size_class.free.empty())
+        {
+            buffer = std::move(size_class.free.back());
+            size_class.free.pop_back();
+        }
+        ++size_class.in_use;
+        size_class.peak = std::max(size_class.peak, size_class.in_use);
+    }
+
+    // Allocate outside of the lock in case the pool is empty.
+    if (buffer.empty())
+        buffer.resize(size);
+
+    return Scratch_buffer<TF>(*this, std::move(buffer));
+}
+
+template<typename TF>
+void Scratch_pool<TF>::release(std::vector<TF>&& buffer)
+{
+    Size_class& size_class = get_size_class(buffer.size());
+
+    std::lock_guard<std::mutex> lock(size_class.mutex);
+    size_class.free.push_back(std::move(buffer));
+    --size_class.in_use;
+}
+
+template<typename TF>
+void Scratch_pool<TF>::print_usage()
+{
+    for (auto& it : size_classes)
+    {
+        const Size_class& size_class = *(it.second);
+        if (size_class.peak == 0)
+            continue;
+
+        const double mbytes = double(size_class.peak) * it.first * sizeof(TF) / (1024.*1024.);
+        master.print_message("Scratch buffers %-8s: peak %3d of %9d elements (%.1f MB)\n",
+                size_class.name.c_str(), size_class.peak, it.first, mbytes);
+    }
+}
+
+template class Scratch_buffer<double>;
+template class Scratch_buffer<float>;
+template class Scratch_pool<double>;
+template class Scratch_pool<float>;
@@ -261,32 +261,6 @@ namespace
         out = tmp / (itot*jtot);
     }
 
-    template<typename TF>
-    void calc_moment(
-            TF* const restrict prof, const TF* const restrict fld, const TF* const restrict fld_mean, const TF offset,
-            const unsigned int* const mask, const unsigned int flag, const int* const nmask, const int power,
-            const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
-            const int icells, const int ijcells)
-    {
-        #pragma omp parallel for
-        for (int k=kstart; k<kend+1; ++k)
-        {
-            if (nmask[k])
-            {
-                double tmp = 0.;
-                for (int j=jstart; j<jend; ++j)
-                    #pragma ivdep
-                    for (int i=istart; i<iend; ++i)
-                    {
-                        const int ijk  = i + j*icells + k*ijcells;
-                        tmp += in_mask<double>(mask[ijk], flag)*std::pow(fld[ijk] - fld_mean[k] + offset, power);
-                    }
-
-                prof[k] = tmp / nmask[k];
-            }
-        }
-    }
-
     template<typename TF>
     void calc_cov(
             TF* const restrict prof, const TF* const restrict fld1, const TF* const restrict fld1_mean, const TF offset1, const int pow1,
@@ -327,28 +301,117 @@ namespace
     }
 
 
+    // Calculate the mean profiles of a field for all masks in one sweep. The rows of the field
+    // stay in cache while the masks are processed, and the profiles of the masks are stored
+    // consecutively in prof, with stride kcells.
     template<typename TF>
-    void calc_frac(
-            TF* const restrict prof, const TF* const restrict fld, const TF offset, const TF threshold,
-            const unsigned int* const mask, const unsigned int flag, const int* const nmask,
+    void calc_mean_masks(
+            TF* const restrict prof, const TF* const restrict fld,
+            const unsigned int* const mask, const std::vector<unsigned int>& flags, const std::vector<const int*>& nmasks,
             const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
-            const int icells, const int ijcells)
+            const int icells, const int ijcells, const int kcells)
     {
+        const int nm = flags.size();
+
         #pragma omp parallel for
         for (int k=kstart; k<kend+1; ++k)
         {
-            if (nmask[k])
-            {
-                double tmp = 0.;
-                for (int j=jstart; j<jend; ++j)
+            std::vector<double> tmp(nm, 0.);
+
+            for (int j=jstart; j<jend; ++j)
+                for (int n=0; n<nm; ++n)
+                {
+                    if (!nmasks[n][k])
+                        continue;
+
+                    const unsigned int flag = flags[n];
+                    double sum = tmp[n];
+
                     #pragma ivdep
                     for (int i=istart; i<iend; ++i)
                     {
                         const int ijk  = i + j*icells + k*ijcells;
-                        tmp += in_mask<double>(mask[ijk], flag)*((fld[ijk] + offset) > threshold);
+                        sum += in_mask<double>(mask[ijk], flag) * fld[ijk];
                     }
-                prof[k] = tmp / nmask[k];
-            }
+
+                    tmp[n] = sum;
+                }
+
+            for (int n=0; n<nm; ++n)
+                if (nmasks[n][k])
+                    prof[n*kcells + k] = tmp[n] / nmasks[n][k];
+        }
+    }
+
+    // Calculate the 2nd, 3rd and 4th order moments and the fraction above threshold of a field
+    // for all masks in one sweep, using the mean profiles of the masks in fld_means. The four
+    // profiles of each mask are stored consecutively in prof, with stride kcells.
+    template<typename TF>
+    void calc_moments_masks(
+            TF* const restrict prof, const TF* const restrict fld, const std::vector<const TF*>& fld_means,
+            const TF offset, const TF threshold, const bool do_moments, const bool do_frac,
+            const unsigned int* const mask, const std::vector<unsigned int>& flags, const std::vector<const int*>& nmasks,
+            const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
+            const int icells, const int ijcells, const int kcells)
+    {
+        const int nm = flags.size();
+
+        #pragma omp parallel for
+        for (int k=kstart; k<kend+1; ++k)
+        {
+            std::vector<double> tmp(4*nm, 0.);
+
+            for (int j=jstart; j<jend; ++j)
+                for (int n=0; n<nm; ++n)
+                {
+                    if (!nmasks[n][k])
+                        continue;
+
+                    const unsigned int flag = flags[n];
+
+                    if (do_moments)
+                    {
+                        const TF fld_mean = fld_means[n][k];
+                        double sum2 = tmp[4*n  ];
+                        double sum3 = tmp[4*n+1];
+                        double sum4 = tmp[4*n+2];
+
+                        #pragma ivdep
+                        for (int i=istart; i<iend; ++i)
+                        {
+                            const int ijk  = i + j*icells + k*ijcells;
+                            const double m  = in_mask<double>(mask[ijk], flag);
+                            const double d  = fld[ijk] - fld_mean + offset;
+                            const double d2 = d*d;
+                            sum2 += m*d2;
+                            sum3 += m*d2*d;
+                            sum4 += m*d2*d2;
+                        }
+
+                        tmp[4*n  ] = sum2;
+                        tmp[4*n+1] = sum3;
+                        tmp[4*n+2] = sum4;
+                    }
+
+                    if (do_frac)
+                    {
+                        double sumf = tmp[4*n+3];
+
+                        #pragma ivdep
+                        for (int i=istart; i<iend; ++i)
+                        {
+                            const int ijk  = i + j*icells + k*ijcells;
+                            sumf += in_mask<double>(mask[ijk], flag)*((fld[ijk] + offset) > threshold);
+                        }
+
+                        tmp[4*n+3] = sumf;
+                    }
+                }
+
+            for (int n=0; n<nm; ++n)
+                if (nmasks[n][k])
+                    for (int p=0; p<4; ++p)
+                        prof[(4*n+p)*kcells + k] = tmp[4*n+p] / nmasks[n][k];
         }
     }
 
@@ -448,6 +511,7 @@ Stats<TF>::Stats(
         masklist   = inputin.get_list<std::string>("stats", "masklist", "", std::vector<std::string>());
         masklist.push_back("default"); // Add the default mask, which calculates the domain mean without sampling.
         swtendency = inputin.get_item<bool>("stats", "swtendency", "", false);
+        swbufferedoutput = inputin.get_item<bool>("stats", "swbufferedoutput", "", false);
 
         std::vector<std::string> whitelistin = inputin.get_list<std::string>("stats", "whitelist", "", std::vector<std::string>());
 
@@ -515,6 +579,8 @@ void Stats<TF>::create(const Timeloop<TF>& timeloop, std::string sim_name)
 
         // Create new NetCDF file
         m.data_file = std::make_unique<Netcdf_file>(master, filename.str(), Netcdf_mode::Create);
+        if (swbufferedoutput)
+            m.data_file->set_buffered();
 
         // Create dimensions.
         m.data_file->add_dimension("z",  gd.kmax);
@@ -605,6 +671,9 @@ void Stats<TF>::exec(const int iteration, const double time, const unsigned long
     // Write message in case stats is triggered.
     master.print_message("Saving statistics for time %f\n", time);
 
+    // Complete all reductions of this statistics step.
+    exec_sums();
+
     // Finalize the total tendencies
     if (do_tendency())
     {
@@ -1077,9 +1146,27 @@ void Stats<TF>::finalize_masks()
                 mfield.data(), mfield_bot.data(), it.second.flag, it.second.flagh,
                 gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
                 gd.icells, gd.ijcells, gd.kcells);
+    }
+
+    // Sum the number of points of all masks in one reduction.
+    std::vector<int> nmask_buf;
+    nmask_buf.reserve(2*masks.size()*gd.kcells);
+    for (auto& it : masks)
+    {
+        nmask_buf.insert(nmask_buf.end(), it.second.nmask .begin(), it.second.nmask .end());
+        nmask_buf.insert(nmask_buf.end(), it.second.nmaskh.begin(), it.second.nmaskh.end());
+    }
+
+    master.sum(nmask_buf.data(), nmask_buf.size());
+
+    auto it_buf = nmask_buf.begin();
+    for (auto& it : masks)
+    {
+        std::copy(it_buf, it_buf + gd.kcells, it.second.nmask .begin());
+        it_buf += gd.kcells;
+        std::copy(it_buf, it_buf + gd.kcells, it.second.nmaskh.begin());
+        it_buf += gd.kcells;
 
-        master.sum(it.second.nmask.data() , gd.kcells);
-        master.sum(it.second.nmaskh.data(), gd.kcells);
         it.second.nmask_bot = it.second.nmaskh[gd.kstart];
         auto it1 = std::find(varlist.begin(), varlist.end(), "area");
         if (it1 != varlist.end())
@@ -1157,6 +1244,66 @@ void Stats<TF>::set_timeseries(const std::string varname, const TF val)
     }
 }
 
+template<typename TF>
+void Stats<TF>::add_sum(TF* const data, const int n, const int* const nmask, const TF offset)
+{
+    // Clear the data, such that levels that the kernels skip do not contribute to the sum.
+    std::fill(data, data+n, TF(0.));
+    sum_requests.push_back({data, n, nmask, offset});
+}
+
+template<typename TF>
+void Stats<TF>::add_ratio(TF* const data, const double num, const double den, const bool zero_if_empty)
+{
+    ratio_requests.push_back({data, num, den, zero_if_empty});
+}
+
+template<typename TF>
+void Stats<TF>::exec_sums()
+{
+    auto& gd = grid.get_grid_data();
+
+    // Pack all local contributions into one buffer, in double precision to keep the counts exact.
+    int nsum = 0;
+    for (auto& r : sum_requests)
+        nsum += r.n;
+
+    std::vector<double> buf(nsum + 2*ratio_requests.size());
+
+    auto it = buf.begin();
+    for (auto& r : sum_requests)
+        it = std::copy(r.data, r.data + r.n, it);
+
+    for (auto& r : ratio_requests)
+    {
+        *it++ = r.num;
+        *it++ = r.den;
+    }
+
+    if (!buf.empty())
+        master.sum(buf.data(), buf.size());
+
+    it = buf.begin();
+    for (auto& r : sum_requests)
+    {
+        for (int n=0; n<r.n; ++n)
+            r.data[n] = *it++ + r.offset;
+
+        if (r.nmask != nullptr)
+            set_fillvalue_prof(r.data, r.nmask, gd.kstart, r.n);
+    }
+
+    for (auto& r : ratio_requests)
+    {
+        const double num = *it++;
+        const double den = *it++;
+        *r.data = (r.zero_if_empty && den <= 0.) ? TF(0.) : TF(num / den);
+    }
+
+    sum_requests.clear();
+    ratio_requests.clear();
+}
+
 template<typename TF>
 void Stats<TF>::calc_stats(
         const std::string varname, const Field3d<TF>& fld, const TF offset, const TF threshold)
@@ -1167,109 +1314,156 @@ void Stats<TF>::calc_stats(
     const int* nmask;
     std::string name;
 
-    // Calc mean
-    if (std::find(varlist.begin(), varlist.end(), varname) != varlist.end())
+    // Collect the flags of all masks, such that the kernels below process all masks in a single
+    // sweep over the field, followed by a single reduction of all profiles.
+    const int nm = masks.size();
+    std::vector<unsigned int> flags, flags_flux;
+    std::vector<const int*> nmasks, nmasks_flux;
+    for (auto& m : masks)
+    {
+        set_flag(flag, nmask, m.second, fld.loc[2]);
+        flags.push_back(flag);
+        nmasks.push_back(nmask);
+
+        set_flag(flag, nmask, m.second, !fld.loc[2]);
+        flags_flux.push_back(flag);
+        nmasks_flux.push_back(nmask);
+    }
+
+    // Copy profile iprof of each mask out of a reduced buffer with nprof profiles per mask.
+    auto store_profs = [&](
+            const std::string& prof_name, const std::vector<TF>& prof_buf, const int nprof, const int iprof,
+            const std::vector<const int*>& prof_nmasks, const TF prof_offset)
     {
+        int n = 0;
         for (auto& m : masks)
         {
-            set_flag(flag, nmask, m.second, fld.loc[2]);
-            calc_mean(m.second.profs.at(varname).data.data(), fld.fld.data(), mfield.data(), flag, nmask,
-                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend, gd.icells, gd.ijcells);
-            master.sum(m.second.profs.at(varname).data.data(), gd.kcells);
+            TF* const prof = m.second.profs.at(prof_name).data.data();
+            const TF* const buf = &prof_buf[(n*nprof + iprof)*gd.kcells];
+            for (int k=0; k<gd.kcells; ++k)
+                prof[k] = buf[k] + prof_offset;
 
-            // Add the offset.
-            for (auto& value : m.second.profs.at(varname).data)
-                value += offset;
-
-            set_fillvalue_prof(m.second.profs.at(varname).data.data(), nmask, gd.kstart, gd.kcells);
+            set_fillvalue_prof(prof, prof_nmasks[n], gd.kstart, gd.kcells);
+            ++n;
         }
-    }
+    };
 
-    // Calc moments
-    for (int power=2; power<=4; power++)
+    // Copy the local contribution to profile iprof of each mask out of a buffer with nprof
+    // profiles per mask, and postpone their reduction to the end of the statistics step.
+    auto defer_profs = [&](
+            const std::string& prof_name, const std::vector<TF>& prof_buf, const int nprof, const int iprof,
+            const std::vector<const int*>& prof_nmasks)
     {
-        name = varname + "_" + std::to_string(power);
-        if (std::find(varlist.begin(), varlist.end(), name) != varlist.end())
+        int n = 0;
+        for (auto& m : masks)
         {
-            for (auto& m : masks)
-            {
-                set_flag(flag, nmask, m.second, fld.loc[2]);
-                calc_moment(
-                        m.second.profs.at(name).data.data(), fld.fld.data(), m.second.profs.at(varname).data.data(), offset, mfield.data(), flag, nmask,
-                        power, gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
-                        gd.icells, gd.ijcells);
+            TF* const prof = m.second.profs.at(prof_name).data.data();
+            add_sum(prof, gd.kcells, prof_nmasks[n]);
 
-                master.sum(m.second.profs.at(name).data.data(), gd.kcells);
-                set_fillvalue_prof(m.second.profs.at(name).data.data(), nmask, gd.kstart, gd.kcells);
-            }
+            const TF* const buf = &prof_buf[(n*nprof + iprof)*gd.kcells];
+            for (int k=0; k<gd.kcells; ++k)
+                prof[k] = buf[k];
+            ++n;
         }
+    };
+
+    auto has_var = [&](const std::string& prof_name)
+    {
+        return std::find(varlist.begin(), varlist.end(), prof_name) != varlist.end();
+    };
+
+    // Calc mean
+    if (has_var(varname))
+    {
+        std::vector<TF> prof_buf(nm*gd.kcells, TF(0.));
+        calc_mean_masks(prof_buf.data(), fld.fld.data(), mfield.data(), flags, nmasks,
+                gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend, gd.icells, gd.ijcells, gd.kcells);
+        master.sum(prof_buf.data(), nm*gd.kcells);
+
+        // Add the offset.
+        store_profs(varname, prof_buf, 1, 0, nmasks, offset);
+    }
+
+    // Calc moments and fraction
+    const bool do_moment[3] = {
+            has_var(varname + "_2"), has_var(varname + "_3"), has_var(varname + "_4")};
+    const bool do_moments = do_moment[0] || do_moment[1] || do_moment[2];
+    const bool do_frac = has_var(varname + "_frac");
+
+    if (do_moments || do_frac)
+    {
+        std::vector<const TF*> fld_means;
+        for (auto& m : masks)
+            fld_means.push_back(do_moments ? m.second.profs.at(varname).data.data() : nullptr);
+
+        std::vector<TF> prof_buf(4*nm*gd.kcells, TF(0.));
+        calc_moments_masks(
+                prof_buf.data(), fld.fld.data(), fld_means, offset, threshold, do_moments, do_frac,
+                mfield.data(), flags, nmasks,
+                gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+                gd.icells, gd.ijcells, gd.kcells);
+
+        for (int power=2; power<=4; ++power)
+            if (do_moment[power-2])
+                defer_profs(varname + "_" + std::to_string(power), prof_buf, 4, power-2, nmasks);
+
+        if (do_frac)
+            defer_profs(varname + "_frac", prof_buf, 4, 3, nmasks);
     }
 
     // Calc Resolved Flux
     name = varname + "_w";
-    if (std::find(varlist.begin(), varlist.end(), name) != varlist.end())
+    if (has_var(name))
     {
         auto advec_flux = fields.get_tmp();
         advec.get_advec_flux(*advec_flux, fld);
 
-        for (auto& m : masks)
-        {
-            set_flag(flag, nmask, m.second, !fld.loc[2]);
-            calc_mean(
-                    m.second.profs.at(name).data.data(), advec_flux->fld.data(), mfield.data(), flag, nmask,
-                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
-                    gd.icells, gd.ijcells);
+        std::vector<TF> prof_buf(nm*gd.kcells, TF(0.));
+        calc_mean_masks(prof_buf.data(), advec_flux->fld.data(), mfield.data(), flags_flux, nmasks_flux,
+                gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend, gd.icells, gd.ijcells, gd.kcells);
+        defer_profs(name, prof_buf, 1, 0, nmasks_flux);
 
-            master.sum(m.second.profs.at(name).data.data(), gd.kcells);
-            set_fillvalue_prof(m.second.profs.at(name).data.data(), nmask, gd.kstart, gd.kcells);
-        }
         fields.release_tmp(advec_flux);
     }
 
     // Calc Diffusive Flux
     name = varname + "_diff";
-    if (std::find(varlist.begin(), varlist.end(), name) != varlist.end())
+    if (has_var(name))
     {
         auto diff_flux = fields.get_tmp();
         diff.diff_flux(*diff_flux, fld);
 
-        for (auto& m : masks)
-        {
-            set_flag(flag, nmask, m.second, !fld.loc[2]);
-            calc_mean(
-                    m.second.profs.at(name).data.data(), diff_flux->fld.data(), mfield.data(), flag, nmask,
-                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
-                    gd.icells, gd.ijcells);
-
-            master.sum(m.second.profs.at(name).data.data(), gd.kcells);
-            set_fillvalue_prof(m.second.profs.at(name).data.data(), nmask, gd.kstart, gd.kcells);
-        }
+        std::vector<TF> prof_buf(nm*gd.kcells, TF(0.));
+        calc_mean_masks(prof_buf.data(), diff_flux->fld.data(), mfield.data(), flags_flux, nmasks_flux,
+                gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend, gd.icells, gd.ijcells, gd.kcells);
+        defer_profs(name, prof_buf, 1, 0, nmasks_flux);
 
         fields.release_tmp(diff_flux);
     }
 
     // Calc Total Flux
     name = varname + "_flux";
-    if (std::find(varlist.begin(), varlist.end(), name) != varlist.end())
+    if (has_var(name))
     {
         for (auto& m : masks)
         {
-            // No sum is required in this routine as values all.
+            // The sum of the local contributions of both fluxes is reduced with the others.
             set_flag(flag, nmask, m.second, !fld.loc[2]);
+            add_sum(m.second.profs.at(name).data.data(), gd.kcells, nmask);
             add_fluxes(
                     m.second.profs.at(name).data.data(), m.second.profs.at(varname+"_w").data.data(), m.second.profs.at(varname+"_diff").data.data(),
                     gd.kstart, gd.kend);
-            set_fillvalue_prof(m.second.profs.at(name).data.data(), nmask, gd.kstart, gd.kcells);
         }
     }
 
     // Calc Gradient
     name = varname + "_grad";
-    if (std::find(varlist.begin(), varlist.end(), name) != varlist.end())
+    if (has_var(name))
     {
         for (auto& m : masks)
         {
             set_flag(flag, nmask, m.second, !fld.loc[2]);
+            add_sum(m.second.profs.at(name).data.data(), gd.kcells, nmask);
 
             if (grid.get_spatial_order() == Grid_order::Second)
             {
@@ -1285,15 +1479,12 @@ void Stats<TF>::calc_stats(
                         gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
                         gd.icells, gd.ijcells);
             }
-
-            master.sum(m.second.profs.at(name).data.data(), gd.kcells);
-            set_fillvalue_prof(m.second.profs.at(name).data.data(), nmask, gd.kstart, gd.kcells);
         }
     }
 
     // Calc Integrated Path
     name = varname + "_path";
-    if (std::find(varlist.begin(), varlist.end(), name) != varlist.end())
+    if (has_var(name))
     {
         for (auto& m : masks)
         {
@@ -1305,16 +1496,13 @@ void Stats<TF>::calc_stats(
                     gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
                     gd.icells, gd.ijcells);
 
-            master.sum(&path.first, 1);
-            master.sum(&path.second, 1);
-
-            m.second.tseries.at(name).data = path.first / path.second;
+            add_ratio(&m.second.tseries.at(name).data, path.first, path.second, false);
         }
     }
 
     // Calc Cover
     name = varname + "_cover";
-    if (std::find(varlist.begin(), varlist.end(), name) != varlist.end())
+    if (has_var(name))
     {
         for (auto& m : masks)
         {
@@ -1326,30 +1514,8 @@ void Stats<TF>::calc_stats(
                     gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
                     gd.icells, gd.ijcells);
 
-            master.sum(&cover.first, 1);
-            master.sum(&cover.second, 1);
-
             // Only assign if number of points in mask is positive.
-            m.second.tseries.at(name).data = (cover.second > 0) ? TF(cover.first)/TF(cover.second) : 0.;
-        }
-    }
-
-    // Calc Fraction
-    name = varname + "_frac";
-    auto it1 = std::find(varlist.begin(), varlist.end(), name);
-    if (it1 != varlist.end())
-    {
-        for (auto& m : masks)
-        {
-            set_flag(flag, nmask, m.second, fld.loc[2]);
-
-            calc_frac(
-                    m.second.profs.at(name).data.data(), fld.fld.data(), offset, threshold, mfield.data(), flag, nmask,
-                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
-                    gd.icells, gd.ijcells);
-
-            master.sum(m.second.profs.at(name).data.data(), gd.kcells);
-            set_fillvalue_prof(m.second.profs.at(name).data.data(), nmask, gd.kstart, gd.kcells);
+            add_ratio(&m.second.tseries.at(name).data, cover.first, cover.second, true);
         }
     }
 }
@@ -1373,11 +1539,9 @@ void Stats<TF>::calc_tend(Field3d<TF>& fld, const std::string tend_name)
         for (auto& m : masks)
         {
             set_flag(flag, nmask, m.second, fld.loc[2]);
+            add_sum(m.second.profs.at(name).data.data(), gd.kcells, nmask);
             calc_mean(m.second.profs.at(name).data.data(), fld.fld.data(), mfield.data(), flag, nmask,
                     gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend, gd.icells, gd.ijcells);
-            master.sum(m.second.profs.at(name).data.data(), gd.kcells);
-
-            set_fillvalue_prof(m.second.profs.at(name).data.data(), nmask, gd.kstart, gd.kcells);
         }
     }
 }
@@ -1392,10 +1556,9 @@ void Stats<TF>::calc_stats_2d(
     {
         for (auto& m : masks)
         {
+            add_sum(&m.second.tseries.at(varname).data, 1, nullptr, offset);
             calc_mean_2d(m.second.tseries.at(varname).data, fld.data(),
                     gd.istart, gd.iend, gd.jstart, gd.jend, gd.icells, gd.itot, gd.jtot);
-            master.sum(&m.second.tseries.at(varname).data, 1);
-            m.second.tseries.at(varname).data += offset;
         }
     }
 }
@@ -1441,15 +1604,13 @@ void Stats<TF>::calc_covariance(
                     }
                     nmask = m.second.nmaskh.data();
                 }
+                add_sum(m.second.profs.at(name).data.data(), gd.kcells, nmask);
                 calc_cov(
                         m.second.profs.at(name).data.data(), fld1.fld.data(), fld1_mean, offset1, power1,
                         fld2.fld.data(), m.second.profs.at(varname2).data.data(), offset2, power2,
                         mfield.data(), flag, nmask,
                         gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
                         gd.icells, gd.ijcells);
-                master.sum(m.second.profs.at(name).data.data(), gd.kcells);
-                set_fillvalue_prof(m.second.profs.at(name).data.data(), nmask, gd.kstart, gd.kcells);
-
             }
         }
         else
@@ -1473,15 +1634,13 @@ void Stats<TF>::calc_covariance(
                     nmask = m.second.nmaskh.data();
                 }
 
+                add_sum(m.second.profs.at(name).data.data(), gd.kcells);
                 calc_cov(
                         m.second.profs.at(name).data.data(), tmp->fld.data(), m.second.profs.at(varname1).data.data(), offset1, power1,
                         fld2.fld.data(), m.second.profs.at(varname2).data.data(), offset2, power2,
                         mfield.data(), flag, nmask,
                         gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
                         gd.icells, gd.ijcells);
-
-                master.sum(m.second.profs.at(name).data.data(), gd.kcells);
-
             }
 
             fields.release_tmp(tmp);
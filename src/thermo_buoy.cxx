@@ -50,6 +50,7 @@ namespace
                  const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
                  const int icells, const int ijcells, const int kcells)
     {
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -97,6 +98,7 @@ namespace
             const int icells, const int ijcells)
     {
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -115,6 +117,7 @@ namespace
     {
         const TF sinalpha = std::sin(alpha);
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -133,6 +136,7 @@ namespace
     {
         const TF cosalpha = std::cos(alpha);
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -152,6 +156,7 @@ namespace
         const TF sinalpha = std::sin(alpha);
         const TF cosalpha = std::cos(alpha);
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -172,6 +177,7 @@ namespace
         const int kk1 = 1*ijcells;
         const int kk2 = 2*ijcells;
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -190,6 +196,7 @@ namespace
     {
         const TF sinalpha = std::sin(alpha);
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -212,6 +219,7 @@ namespace
 
         const TF cosalpha = std::cos(alpha);
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -236,6 +244,7 @@ namespace
         const TF sinalpha = std::sin(alpha);
         const TF cosalpha = std::cos(alpha);
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -254,6 +263,7 @@ namespace
             const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
             const int jj, const int kk)
     {
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -274,6 +284,7 @@ namespace
         const int jj1 = 1*jj;
         const int jj2 = 2*jj;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
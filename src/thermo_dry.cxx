@@ -52,6 +52,7 @@ namespace
                        const int istart, const int iend, const int jstart, const int jend,
                        const int icells, const int ijcells, const int kcells )
     {
+        #pragma omp parallel for
         for (int k=0; k<kcells; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -67,6 +68,7 @@ namespace
                  const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
                  const int icells, const int ijcells, const int kcells)
     {
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -83,6 +85,7 @@ namespace
                 const int istart, const int iend, const int jstart, const int jend,
                 const int jj, const int kk, const int kcells)
     {
+        #pragma omp parallel for
         for (int k=0; k<kcells; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -101,6 +104,7 @@ namespace
     {
         using Finite_difference::O2::interp2;
 
+        #pragma omp parallel for
         for (int k=0; k<kcells; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -168,6 +172,7 @@ namespace
     {
         using Finite_difference::O2::interp2;
 
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -186,6 +191,7 @@ namespace
         using Finite_difference::O4::interp4c;
 
         const int ijcells2 = 2*ijcells;
+        #pragma omp parallel for
         for (int k=kstart+1; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -205,6 +211,7 @@ namespace
     {
         using Finite_difference::O2::interp2;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -227,6 +234,7 @@ namespace
         const int jj1 = 1*jj;
         const int jj2 = 2*jj;
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -109,6 +109,7 @@ namespace
                        const int kstart, const int kend,
                        const int kcells, const int jj, const int kk)
     {
+        #pragma omp parallel for
         for (int k=0; k<kcells; k++)
         {
             for (int j=jstart; j<jend; j++)
@@ -160,6 +161,7 @@ namespace
                  const int kstart, const int kend,
                  const int jj, const int kk)
     {
+        #pragma omp parallel for
         for (int k=kstart; k<kend; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -177,6 +179,7 @@ namespace
                 const int jstart, const int jend,
                 const int jj, const int kk, const int kcells)
     {
+        #pragma omp parallel for
         for (int k=0; k<kcells; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
@@ -194,6 +197,7 @@ namespace
                 const int jstart, const int jend,
                 const int jj, const int kk, const int kcells)
     {
+        #pragma omp parallel for
         for (int k=0; k<kcells; ++k)
             for (int j=jstart; j<jend; ++j)
                 #pragma ivdep
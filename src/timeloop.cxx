@@ -24,6 +24,7 @@
 #include <iomanip>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 #include <ctime>
 #include <sys/time.h>
 
@@ -233,39 +234,14 @@ void Timeloop<TF>::set_time_step()
 namespace
 {
     template<typename TF>
-    void rk3(TF* restrict const a, TF* restrict const at, const int substep, const TF dt,
-             const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
-             const int jj, const int kk)
+    inline TF rk3cA(const int substep)
     {
         constexpr TF cA [] = {0., -5./9., -153./128.};
-        constexpr TF cB [] = {1./3., 15./16., 8./15.};
-
-        for (int k=kstart; k<kend; ++k)
-            for (int j=jstart; j<jend; ++j)
-                #pragma ivdep
-                for (int i=istart; i<iend; ++i)
-                {
-                    const int ijk = i + j*jj + k*kk;
-                    a[ijk] += cB[substep]*dt*at[ijk];
-                }
-
-        const int substepn = (substep+1) % 3;
-
-        // substep 0 resets the tendencies, because cA[0] == 0
-        for (int k=kstart; k<kend; ++k)
-            for (int j=jstart; j<jend; ++j)
-                #pragma ivdep
-                for (int i=istart; i<iend; ++i)
-                {
-                    const int ijk = i + j*jj + k*kk;
-                    at[ijk] *= cA[substepn];
-                }
+        return cA[substep];
     }
 
     template<typename TF>
-    void rk4(TF* restrict const a, TF* restrict const at, const int substep, const TF dt,
-             const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
-             const int jj, const int kk)
+    inline TF rk4cA(const int substep)
     {
         constexpr TF cA [] = {
             0.,
@@ -273,34 +249,52 @@ namespace
             -2404267990393./2016746695238.,
             -3550918686646./2091501179385.,
             -1275806237668./ 842570457699.};
+        return cA[substep];
+    }
 
-        constexpr TF cB [] = {
-            1432997174477./ 9575080441755.,
-            5161836677717./13612068292357.,
-            1720146321549./ 2090206949498.,
-            3134564353537./ 4481467310338.,
-            2277821191437./14882151754819.};
+    // Integrate one level of a field and scale its tendency for the next substep in the same pass.
+    template<typename TF, bool clip>
+    inline void rk_update_level(
+            TF* restrict const a, TF* restrict const at, const TF subdt, const TF cAn,
+            const int istart, const int iend, const int jstart, const int jend, const int k,
+            const int jj, const int kk)
+    {
+        for (int j=jstart; j<jend; ++j)
+            #pragma ivdep
+            for (int i=istart; i<iend; ++i)
+            {
+                const int ijk = i + j*jj + k*kk;
+                const TF a_new = a[ijk] + subdt*at[ijk];
+                a[ijk] = clip ? std::max(a_new, TF(0.)) : a_new;
+                at[ijk] = cAn*at[ijk];
+            }
+    }
+
+    // Low storage Runge-Kutta update of all fields, where subdt is the product of cB of the current
+    // substep and dt, and cAn is cA of the next substep. The clipping of negative values is applied
+    // in the same pass. The levels of all fields are distributed over the threads together, such
+    // that also the fields with few levels per thread keep all threads busy.
+    template<typename TF>
+    void rk_update(
+            const std::vector<TF*>& a, const std::vector<TF*>& at, const std::vector<char>& clip,
+            const TF subdt, const TF cAn,
+            const int istart, const int iend, const int jstart, const int jend, const int kstart, const int kend,
+            const int jj, const int kk)
+    {
+        const int nfields = a.size();
+        const int nlevels = kend-kstart;
+
+        #pragma omp parallel for
+        for (int nk=0; nk<nfields*nlevels; ++nk)
+        {
+            const int n = nk / nlevels;
+            const int k = kstart + nk % nlevels;
 
-        for (int k=kstart; k<kend; ++k)
-            for (int j=jstart; j<jend; ++j)
-                #pragma ivdep
-                for (int i=istart; i<iend; ++i)
-                {
-                    const int ijk = i + j*jj + k*kk;
-                    a[ijk] = a[ijk] + cB[substep]*dt*at[ijk];
-                }
-
-        const int substepn = (substep+1) % 5;
-
-        // substep 0 resets the tendencies, because cA[0] == 0
-        for (int k=kstart; k<kend; ++k)
-            for (int j=jstart; j<jend; ++j)
-                #pragma ivdep
-                for (int i=istart; i<iend; ++i)
-                {
-                    const int ijk = i + j*jj + k*kk;
-                    at[ijk] = cA[substepn]*at[ijk];
-                }
+            if (clip[n])
+                rk_update_level<TF, true>(a[n], at[n], subdt, cAn, istart, iend, jstart, jend, k, jj, kk);
+            else
+                rk_update_level<TF, false>(a[n], at[n], subdt, cAn, istart, iend, jstart, jend, k, jj, kk);
+        }
     }
 
     template<typename TF>
@@ -329,30 +323,38 @@ void Timeloop<TF>::exec()
 {
     const Grid_data<TF>& gd = grid.get_grid_data();
 
-    if (rkorder == 3)
-    {
-        for (auto& f : fields.at)
-            rk3<TF>(fields.ap.at(f.first)->fld.data(), f.second->fld.data(), substep, dt,
-                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
-                    gd.icells, gd.ijcells);
+    // Value rkorder is 3 or 4, because it is checked in the constructor.
+    const int nsubsteps = (rkorder == 3) ? 3 : 5;
+    const int substepn = (substep+1) % nsubsteps;
 
-        substep = (substep+1) % 3;
-    }
+    const TF subdt = (rkorder == 3) ? rk3subdt<TF>(dt, substep) : rk4subdt<TF>(dt, substep);
 
-    if (rkorder == 4)
-    {
-        for (auto& f : fields.at)
-            rk4<TF>(fields.ap.at(f.first)->fld.data(), f.second->fld.data(), substep, dt,
-                    gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
-                    gd.icells, gd.ijcells);
+    // substep 0 resets the tendencies, because cA[0] == 0
+    const TF cAn = (rkorder == 3) ? rk3cA<TF>(substepn) : rk4cA<TF>(substepn);
 
-        substep = (substep+1) % 5;
+    std::vector<TF*> a;
+    std::vector<TF*> at;
+    std::vector<char> clip;
+    for (auto& f : fields.at)
+    {
+        a.push_back(fields.ap.at(f.first)->fld.data());
+        at.push_back(f.second->fld.data());
+        clip.push_back(std::find(clip_list.begin(), clip_list.end(), f.first) != clip_list.end());
     }
 
-    // Apply clipping (remove values below zero).
+    rk_update<TF>(a, at, clip, subdt, cAn,
+            gd.istart, gd.iend, gd.jstart, gd.jend, gd.kstart, gd.kend,
+            gd.icells, gd.ijcells);
+
+    substep = substepn;
+
+    // Apply clipping (remove values below zero) to the fields that are not integrated in time.
     for (const std::string& clip_name : clip_list)
-        for (int n=0; n<gd.ncells; ++n)
-            fields.a.at(clip_name)->fld[n] = std::max(fields.a.at(clip_name)->fld[n], TF(0.));
+        if (fields.at.find(clip_name) == fields.at.end())
+            for (int n=0; n<gd.ncells; ++n)
+                fields.a.at(clip_name)->fld[n] = std::max(fields.a.at(clip_name)->fld[n], TF(0.));
+
+    fields.update_prognostic_version();
 }
 #endif
 
@@ -469,6 +471,18 @@ void Timeloop<TF>::load(int starttime)
     dt   = static_cast<double>(idt)   / ifactor;
 }
 
+template<typename TF>
+void Timeloop<TF>::set_restart_state(const unsigned long itime_in, const unsigned long idt_in, const int iteration_in)
+{
+    itime = itime_in;
+    idt = idt_in;
+    iteration = iteration_in;
+
+    // calculate the double precision time from the integer time
+    time = static_cast<double>(itime) / ifactor;
+    dt   = static_cast<double>(idt)   / ifactor;
+}
+
 template<typename TF>
 void Timeloop<TF>::step_post_proc_time()
 {
@@ -20,6 +20,8 @@
  * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <stdexcept>
 #include "master.h"
 #include "grid.h"
 #include "transpose.h"
@@ -28,7 +30,8 @@ template<typename TF>
 Transpose<TF>::Transpose(Master& masterin, Grid<TF>& gridin) :
     master(masterin),
     grid(gridin),
-    mpi_types_allocated(false)
+    mpi_types_allocated(false),
+    mode(Transpose_mode::Blocking)
 {
 }
 
@@ -50,6 +53,42 @@ namespace
     template<typename TF> MPI_Datatype mpi_fp_type();
     template<> MPI_Datatype mpi_fp_type<double>() { return MPI_DOUBLE; }
     template<> MPI_Datatype mpi_fp_type<float>() { return MPI_FLOAT; }
+
+    template<typename TF>
+    void pack(TF* const restrict buf, const TF* const restrict data,
+              const int ni, const int nj, const int nk, const int jj, const int kk)
+    {
+        int n = 0;
+        for (int k=0; k<nk; ++k)
+            for (int j=0; j<nj; ++j)
+            {
+                #pragma ivdep
+                for (int i=0; i<ni; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    buf[n+i] = data[ijk];
+                }
+                n += ni;
+            }
+    }
+
+    template<typename TF>
+    void unpack(TF* const restrict data, const TF* const restrict buf,
+                const int ni, const int nj, const int nk, const int jj, const int kk)
+    {
+        int n = 0;
+        for (int k=0; k<nk; ++k)
+            for (int j=0; j<nj; ++j)
+            {
+                #pragma ivdep
+                for (int i=0; i<ni; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    data[ijk] = buf[n+i];
+                }
+                n += ni;
+            }
+    }
 }
 
 template<typename TF>
@@ -117,6 +156,14 @@ void Transpose<TF>::exit_mpi()
 template<typename TF>
 void Transpose<TF>::exec_zx(TF* const restrict ar, TF* const restrict as)
 {
+    Scoped_timer timer(master.get_profiler(), "transpose");
+
+    if (mode == Transpose_mode::Alltoall)
+    {
+        exec_alltoall(ar, as, Transpose_type::zx);
+        return;
+    }
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -138,11 +185,20 @@ void Transpose<TF>::exec_zx(TF* const restrict ar, TF* const restrict as)
     }
 
     master.wait_all();
+    add_bytes(transposez, md.npx);
 }
 
 template<typename TF>
 void Transpose<TF>::exec_xz(TF* const restrict ar, TF* const restrict as)
 {
+    Scoped_timer timer(master.get_profiler(), "transpose");
+
+    if (mode == Transpose_mode::Alltoall)
+    {
+        exec_alltoall(ar, as, Transpose_type::xz);
+        return;
+    }
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -164,11 +220,20 @@ void Transpose<TF>::exec_xz(TF* const restrict ar, TF* const restrict as)
     }
 
     master.wait_all();
+    add_bytes(transposex, md.npx);
 }
 
 template<typename TF>
 void Transpose<TF>::exec_xy(TF* const restrict ar, TF* const restrict as)
 {
+    Scoped_timer timer(master.get_profiler(), "transpose");
+
+    if (mode == Transpose_mode::Alltoall)
+    {
+        exec_alltoall(ar, as, Transpose_type::xy);
+        return;
+    }
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -190,11 +255,20 @@ void Transpose<TF>::exec_xy(TF* const restrict ar, TF* const restrict as)
     }
 
     master.wait_all();
+    add_bytes(transposex2, md.npy);
 }
 
 template<typename TF>
 void Transpose<TF>::exec_yx(TF* const restrict ar, TF* const restrict as)
 {
+    Scoped_timer timer(master.get_profiler(), "transpose");
+
+    if (mode == Transpose_mode::Alltoall)
+    {
+        exec_alltoall(ar, as, Transpose_type::yx);
+        return;
+    }
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -216,11 +290,20 @@ void Transpose<TF>::exec_yx(TF* const restrict ar, TF* const restrict as)
     }
 
     master.wait_all();
+    add_bytes(transposey, md.npy);
 }
 
 template<typename TF>
 void Transpose<TF>::exec_yz(TF* const restrict ar, TF* const restrict as)
 {
+    Scoped_timer timer(master.get_profiler(), "transpose");
+
+    if (mode == Transpose_mode::Alltoall)
+    {
+        exec_alltoall(ar, as, Transpose_type::yz);
+        return;
+    }
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -242,11 +325,20 @@ void Transpose<TF>::exec_yz(TF* const restrict ar, TF* const restrict as)
     }
 
     master.wait_all();
+    add_bytes(transposey2, md.npx);
 }
 
 template<typename TF>
 void Transpose<TF>::exec_zy(TF* const restrict ar, TF* const restrict as)
 {
+    Scoped_timer timer(master.get_profiler(), "transpose");
+
+    if (mode == Transpose_mode::Alltoall)
+    {
+        exec_alltoall(ar, as, Transpose_type::zy);
+        return;
+    }
+
     auto& gd = grid.get_grid_data();
     auto& md = master.get_MPI_data();
 
@@ -268,6 +360,199 @@ void Transpose<TF>::exec_zy(TF* const restrict ar, TF* const restrict as)
     }
 
     master.wait_all();
+    add_bytes(transposez2, md.npx);
+}
+template<typename TF>
+typename Transpose<TF>::Box Transpose<TF>::get_box(const Layout layout, const int n, const int k0)
+{
+    auto& gd = grid.get_grid_data();
+
+    switch (layout)
+    {
+        case Layout::z:
+            return {(n*gd.kblock + k0)*gd.imax*gd.jmax, gd.imax, gd.jmax, gd.imax, gd.imax*gd.jmax};
+        case Layout::z2:
+            return {(n*gd.kblock + k0)*gd.iblock*gd.jblock, gd.iblock, gd.jblock, gd.iblock, gd.iblock*gd.jblock};
+        case Layout::x:
+            return {n*gd.imax + k0*gd.itot*gd.jmax, gd.imax, gd.jmax, gd.itot, gd.itot*gd.jmax};
+        case Layout::x2:
+            return {n*gd.iblock + k0*gd.itot*gd.jmax, gd.iblock, gd.jmax, gd.itot, gd.itot*gd.jmax};
+        case Layout::y:
+            return {n*gd.iblock*gd.jmax + k0*gd.iblock*gd.jtot, gd.iblock, gd.jmax, gd.iblock, gd.iblock*gd.jtot};
+        case Layout::y2:
+            return {n*gd.iblock*gd.jblock + k0*gd.iblock*gd.jtot, gd.iblock, gd.jblock, gd.iblock, gd.iblock*gd.jtot};
+    }
+
+    throw std::runtime_error("Illegal transpose layout");
+}
+
+template<typename TF>
+void Transpose<TF>::get_setup(
+        const Transpose_type type, Layout& layout_send, Layout& layout_recv,
+        MPI_Comm& comm, int& npeers, bool& use_buf_b)
+{
+    auto& md = master.get_MPI_data();
+
+    switch (type)
+    {
+        case Transpose_type::zx:
+            layout_send = Layout::z;  layout_recv = Layout::x;  comm = md.commx; npeers = md.npx; use_buf_b = false; break;
+        case Transpose_type::xz:
+            layout_send = Layout::x;  layout_recv = Layout::z;  comm = md.commx; npeers = md.npx; use_buf_b = false; break;
+        case Transpose_type::xy:
+            layout_send = Layout::x2; layout_recv = Layout::y;  comm = md.commy; npeers = md.npy; use_buf_b = true;  break;
+        case Transpose_type::yx:
+            layout_send = Layout::y;  layout_recv = Layout::x2; comm = md.commy; npeers = md.npy; use_buf_b = true;  break;
+        case Transpose_type::yz:
+            layout_send = Layout::y2; layout_recv = Layout::z2; comm = md.commx; npeers = md.npx; use_buf_b = false; break;
+        case Transpose_type::zy:
+            layout_send = Layout::z2; layout_recv = Layout::y2; comm = md.commx; npeers = md.npx; use_buf_b = false; break;
+    }
+}
+
+template<typename TF>
+void Transpose<TF>::init_buffers()
+{
+    auto& gd = grid.get_grid_data();
+    auto& md = master.get_MPI_data();
+
+    // Set a holds the zx, xz, yz and zy transposes, set b the xy and yx transposes,
+    // such that two consecutive stages of a pipeline never share a buffer.
+    const int nbuf_a = md.npx*gd.kblock*std::max(gd.imax*gd.jmax, gd.iblock*gd.jblock);
+    const int nbuf_b = md.npy*gd.kblock*gd.iblock*gd.jmax;
+
+    send_buf_a.resize(nbuf_a);
+    recv_buf_a.resize(nbuf_a);
+    send_buf_b.resize(nbuf_b);
+    recv_buf_b.resize(nbuf_b);
+}
+
+template<typename TF>
+void Transpose<TF>::exec_alltoall(TF* const restrict ar, TF* const restrict as, const Transpose_type type)
+{
+    auto& gd = grid.get_grid_data();
+
+    if (send_buf_a.empty())
+        init_buffers();
+
+    Layout layout_send, layout_recv;
+    MPI_Comm comm;
+    int npeers;
+    bool use_buf_b;
+    get_setup(type, layout_send, layout_recv, comm, npeers, use_buf_b);
+
+    TF* send_buf = use_buf_b ? send_buf_b.data() : send_buf_a.data();
+    TF* recv_buf = use_buf_b ? recv_buf_b.data() : recv_buf_a.data();
+
+    // The block of each peer has the same size for the sending and receiving orientation.
+    const Box b0 = get_box(layout_send, 0, 0);
+    const int nblock = b0.ni*b0.nj*gd.kblock;
+
+    for (int n=0; n<npeers; ++n)
+    {
+        const Box b = get_box(layout_send, n, 0);
+        pack(&send_buf[n*nblock], &as[b.offset], b.ni, b.nj, gd.kblock, b.jj, b.kk);
+    }
+
+    MPI_Alltoall(send_buf, nblock, mpi_fp_type<TF>(), recv_buf, nblock, mpi_fp_type<TF>(), comm);
+    master.get_profiler().add_bytes("transpose", sizeof(TF)*nblock*npeers);
+
+    for (int n=0; n<npeers; ++n)
+    {
+        const Box b = get_box(layout_recv, n, 0);
+        unpack(&ar[b.offset], &recv_buf[n*nblock], b.ni, b.nj, gd.kblock, b.jj, b.kk);
+    }
+}
+
+template<typename TF>
+void Transpose<TF>::exec_begin(
+        TF* const restrict ar, TF* const restrict as, const Transpose_type type,
+        const int k0, const int nk, const int ichunk)
+{
+    Scoped_timer timer(master.get_profiler(), "transpose");
+
+    if (send_buf_a.empty())
+        init_buffers();
+
+    if (ichunk >= static_cast<int>(chunks.size()))
+        chunks.resize(ichunk+1);
+
+    Layout layout_send, layout_recv;
+    MPI_Comm comm;
+    int npeers;
+    bool use_buf_b;
+    get_setup(type, layout_send, layout_recv, comm, npeers, use_buf_b);
+
+    TF* send_buf = use_buf_b ? send_buf_b.data() : send_buf_a.data();
+    TF* recv_buf = use_buf_b ? recv_buf_b.data() : recv_buf_a.data();
+
+    // The buffers hold the chunks contiguously, each consisting of npeers blocks.
+    const Box b0 = get_box(layout_send, 0, 0);
+    const int nblock = b0.ni*b0.nj*nk;
+    const int offset = k0*npeers*b0.ni*b0.nj;
+
+    // Give each transpose and chunk its own tag, to keep concurrent messages apart.
+    const int tag = 100*(static_cast<int>(type)+1) + ichunk;
+
+    Chunk& c = chunks[ichunk];
+    c.ar = ar;
+    c.type = type;
+    c.k0 = k0;
+    c.nk = nk;
+    c.reqs.resize(2*npeers);
+
+    for (int n=0; n<npeers; ++n)
+    {
+        const int ibuf = offset + n*nblock;
+        const Box b = get_box(layout_send, n, k0);
+        pack(&send_buf[ibuf], &as[b.offset], b.ni, b.nj, nk, b.jj, b.kk);
+
+        MPI_Irecv(&recv_buf[ibuf], nblock, mpi_fp_type<TF>(), n, tag, comm, &c.reqs[2*n  ]);
+        MPI_Isend(&send_buf[ibuf], nblock, mpi_fp_type<TF>(), n, tag, comm, &c.reqs[2*n+1]);
+    }
+
+    master.get_profiler().add_bytes("transpose", sizeof(TF)*nblock*npeers);
+}
+
+template<typename TF>
+void Transpose<TF>::exec_finish(const int ichunk)
+{
+    Scoped_timer timer(master.get_profiler(), "transpose");
+
+    Chunk& c = chunks[ichunk];
+
+    Layout layout_send, layout_recv;
+    MPI_Comm comm;
+    int npeers;
+    bool use_buf_b;
+    get_setup(c.type, layout_send, layout_recv, comm, npeers, use_buf_b);
+
+    MPI_Waitall(static_cast<int>(c.reqs.size()), c.reqs.data(), MPI_STATUSES_IGNORE);
+
+    const TF* recv_buf = use_buf_b ? recv_buf_b.data() : recv_buf_a.data();
+
+    const Box b0 = get_box(layout_recv, 0, 0);
+    const int nblock = b0.ni*b0.nj*c.nk;
+    const int offset = c.k0*npeers*b0.ni*b0.nj;
+
+    for (int n=0; n<npeers; ++n)
+    {
+        const Box b = get_box(layout_recv, n, c.k0);
+        unpack(&c.ar[b.offset], &recv_buf[offset + n*nblock], b.ni, b.nj, c.nk, b.jj, b.kk);
+    }
+}
+
+template<typename TF>
+void Transpose<TF>::add_bytes(MPI_Datatype type, const int npeers)
+{
+    Profiler& profiler = master.get_profiler();
+    if (!profiler.get_switch())
+        return;
+
+    // Each process sends one block of the datatype to every peer, including itself.
+    int nbytes;
+    MPI_Type_size(type, &nbytes);
+    profiler.add_bytes("transpose", static_cast<unsigned long>(nbytes)*npeers);
 }
 #else
 
@@ -1263,6 +1263,22 @@ void Gas_optics<TF>::source(
     // reorder123x321_test(sources.get_lev_source_dec().ptr(), lev_source_dec_t.ptr(), ngpt, nlay, ncol);
 }
 
+template<typename TF>
+void Gas_optics<TF>::move_tables(const std::function<TF*(const int)>& allocate, const bool copy_data)
+{
+    auto move_table = [&](auto& table)
+    {
+        if (table.size() > 0)
+            table.set_external(allocate(table.size()), copy_data);
+    };
+
+    move_table(this->kmajor);
+    move_table(this->kminor_lower);
+    move_table(this->kminor_upper);
+    move_table(this->planck_frac);
+    move_table(this->krayl);
+}
+
 #ifdef FLOAT_SINGLE_RRTMGP
 template class Gas_optics<float>;
 #else